@@ -0,0 +1,1320 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+/*
+    jost-bridge: runs a plugin Jost can't load itself, because it is built for
+    another architecture (usually a 32bit plugin in a 64bit Jost).
+
+        jost-bridge --probe <library>
+            prints the plugins found in the library, in the same lines the
+            Jost plugin scanner workers use
+
+        jost-bridge <shared memory name>
+            runs the plugin described in the shared block, until Jost asks
+            us to quit or goes away
+
+    There is no juce in here, this is built on its own for the other
+    architecture. The protocol is in BridgeShared.h.
+*/
+
+#include "model/plugins/BridgeShared.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+
+#include "ladspa.h"
+#include "audioeffectx.h"
+
+#ifndef VstInt32
+  #define VstInt32 long
+#endif
+#ifndef VstIntPtr
+  #define VstIntPtr long
+#endif
+
+#define JOST_BRIDGE_IDLE_INTERVAL           40
+#define JOST_BRIDGE_AUDIO_PRIORITY          70
+
+
+//==============================================================================
+static BridgeShared* shared = 0;
+static volatile bool running = true;
+static pthread_t audioThread;
+
+static void copyString (char* dest, const char* source, const int maxSize)
+{
+    strncpy (dest, source != 0 ? source : "", maxSize - 1);
+    dest [maxSize - 1] = 0;
+}
+
+//==============================================================================
+/**
+    What the bridge needs from a plugin, whatever technology it uses.
+
+    Parameters are always normalized between 0 and 1, as Jost sees them.
+*/
+class BridgedPlugin
+{
+public:
+
+    virtual ~BridgedPlugin () {}
+
+    //==============================================================================
+    virtual bool load (const char* filePath, const int descriptorIndex) = 0;
+
+    /** Fill in the plugin description in the shared block */
+    virtual void fillInfo () = 0;
+
+    virtual void activate (const double sampleRate, const int blockSize) = 0;
+    virtual void deactivate () = 0;
+    virtual void process (const int numSamples) = 0;
+
+    //==============================================================================
+    virtual void setParameter (const int index, const float value) = 0;
+    virtual float getParameter (const int index) = 0;
+    virtual void getParameterName (const int index, char* text) = 0;
+    virtual void getParameterText (const int index, const float value, char* text) = 0;
+
+    virtual int getProgram ()                                       { return 0; }
+    virtual void setProgram (const int program)                     {}
+    virtual void getProgramName (const int program, char* text)     { text [0] = 0; }
+
+    virtual int getChunk (void** data)                              { return 0; }
+    virtual void setChunk (void* data, const int size)              {}
+
+    //==============================================================================
+    virtual bool getEditorSize (int& width, int& height)            { return false; }
+    virtual bool openEditor (Display* display, Window parent)       { return false; }
+    virtual void closeEditor ()                                     {}
+    virtual void idle ()                                            {}
+
+    //==============================================================================
+    /** Run a period, from the audio thread */
+    void processPeriod ()
+    {
+        applyParameterChanges ();
+
+        int numSamples = shared->numSamples;
+        if (numSamples < 0) numSamples = 0;
+        if (numSamples > JOST_BRIDGE_MAX_BLOCK) numSamples = JOST_BRIDGE_MAX_BLOCK;
+
+        process (numSamples);
+    }
+
+    /** Apply the changes Jost has put in the shared block */
+    void applyParameterChanges ()
+    {
+        const int numChanges = shared->numParameterChanges;
+
+        for (int i = 0; i < numChanges && i < JOST_BRIDGE_MAX_PARAMETER_CHANGES; i++)
+        {
+            const BridgeParameterChange& change = shared->parameterChanges [i];
+
+            if (change.index >= 0 && change.index < shared->numParameters)
+            {
+                setParameter (change.index, change.value);
+                shared->parameterValues [change.index] = change.value;
+            }
+        }
+    }
+
+    /** Read back every parameter, after a program or a chunk changed them */
+    void refreshParameterValues ()
+    {
+        for (int i = 0; i < shared->numParameters; i++)
+            shared->parameterValues [i] = getParameter (i);
+    }
+};
+
+
+//==============================================================================
+/**
+    A VST plugin, the host callback answers the way Jost does.
+*/
+class VstBridgedPlugin : public BridgedPlugin
+{
+public:
+
+    VstBridgedPlugin ()
+      : library (0),
+        effect (0),
+        display (0),
+        editorWindow (0),
+        eventProc (0),
+        editorOpen (false),
+        needIdle (false),
+        sampleRate (44100.0),
+        blockSize (512),
+        chunkData (0),
+        chunkSize (0),
+        pendingChunk (0),
+        pendingChunkSize (0)
+    {
+        currentPlugin = this;
+
+        memset (&timeInfo, 0, sizeof (timeInfo));
+
+        midiEvents = (VstEvents*) calloc (1, sizeof (VstEvents) + JOST_BRIDGE_MAX_MIDI_EVENTS * sizeof (VstEvent*));
+        for (int i = 0; i < JOST_BRIDGE_MAX_MIDI_EVENTS; i++)
+            midiEvents->events [i] = (VstEvent*) &midiEventStorage [i];
+    }
+
+    ~VstBridgedPlugin ()
+    {
+        if (effect != 0)
+        {
+            if (editorOpen)
+                closeEditor ();
+
+            effect->dispatcher (effect, effClose, 0, 0, 0, 0.0f);
+        }
+
+        if (library != 0)
+            dlclose (library);
+
+        free (midiEvents);
+        free (pendingChunk);
+
+        currentPlugin = 0;
+    }
+
+    //==============================================================================
+    bool load (const char* filePath, const int descriptorIndex)
+    {
+        copyString (directory, filePath, JOST_BRIDGE_PATH_SIZE);
+        char* lastSlash = strrchr (directory, '/');
+        if (lastSlash != 0)
+            *lastSlash = 0;
+
+        library = dlopen (filePath, RTLD_NOW | RTLD_LOCAL);
+        if (library == 0)
+        {
+            fprintf (stderr, "jost-bridge: %s \n", dlerror ());
+            return false;
+        }
+
+        typedef AEffect* (*MainFunction) (audioMasterCallback);
+
+        MainFunction getPluginInstance = (MainFunction) dlsym (library, "VSTPluginMain");
+        if (getPluginInstance == 0)
+            getPluginInstance = (MainFunction) dlsym (library, "main");
+
+        if (getPluginInstance == 0)
+            return false;
+
+        effect = getPluginInstance (hostCallback);
+        if (effect == 0 || effect->magic != kEffectMagic)
+        {
+            effect = 0;
+            return false;
+        }
+
+        dispatch (effIdentify, 0, 0, 0, 0);
+        dispatch (effSetSampleRate, 0, 0, 0, 44100.0f);
+        dispatch (effSetBlockSize, 0, 512, 0, 0);
+        dispatch (effOpen, 0, 0, 0, 0);
+
+        if (effect->numPrograms > 1)
+            dispatch (effSetProgram, 0, 0, 0, 0);
+
+        int i;
+        for (i = effect->numInputs; --i >= 0;)
+            dispatch (effConnectInput, i, 1, 0, 0);
+
+        for (i = effect->numOutputs; --i >= 0;)
+            dispatch (effConnectOutput, i, 1, 0, 0);
+
+        return true;
+    }
+
+    void fillInfo ()
+    {
+        char name [JOST_BRIDGE_NAME_SIZE] = { 0 };
+        dispatch (effGetEffectName, 0, 0, name, 0.0f);
+
+        shared->uniqueID = effect->uniqueID;
+        shared->numInputs = effect->numInputs < JOST_BRIDGE_MAX_CHANNELS ? effect->numInputs : JOST_BRIDGE_MAX_CHANNELS;
+        shared->numOutputs = effect->numOutputs < JOST_BRIDGE_MAX_CHANNELS ? effect->numOutputs : JOST_BRIDGE_MAX_CHANNELS;
+        shared->numParameters = effect->numParams < JOST_BRIDGE_MAX_PARAMETERS ? effect->numParams : JOST_BRIDGE_MAX_PARAMETERS;
+        shared->numPrograms = effect->numPrograms;
+        copyString (shared->name, name, JOST_BRIDGE_NAME_SIZE);
+
+        shared->flags = 0;
+        if (effect->flags & effFlagsHasEditor)      shared->flags |= BridgeFlagHasEditor;
+        if (effect->flags & effFlagsIsSynth)        shared->flags |= BridgeFlagIsSynth;
+        if (effect->flags & effFlagsProgramChunks)  shared->flags |= BridgeFlagProgramChunks;
+        if (canDo ("receiveVstMidiEvent"))          shared->flags |= BridgeFlagAcceptsMidi;
+        if (canDo ("sendVstMidiEvent"))             shared->flags |= BridgeFlagProducesMidi;
+
+        refreshParameterValues ();
+    }
+
+    //==============================================================================
+    void activate (const double sampleRate_, const int blockSize_)
+    {
+        sampleRate = sampleRate_;
+        blockSize = blockSize_;
+
+        dispatch (effSetSampleRate, 0, 0, 0, (float) sampleRate);
+        dispatch (effSetBlockSize, 0, blockSize, 0, 0.0f);
+        dispatch (effMainsChanged, 0, 1, 0, 0.0f);
+        dispatch (effStartProcess, 0, 0, 0, 0.0f);
+    }
+
+    void deactivate ()
+    {
+        dispatch (effStopProcess, 0, 0, 0, 0.0f);
+        dispatch (effMainsChanged, 0, 0, 0, 0.0f);
+    }
+
+    void process (const int numSamples)
+    {
+        if (shared->flags & (BridgeFlagAcceptsMidi | BridgeFlagIsSynth))
+        {
+            const int numEvents = shared->numMidiIn < JOST_BRIDGE_MAX_MIDI_EVENTS
+                                    ? shared->numMidiIn : JOST_BRIDGE_MAX_MIDI_EVENTS;
+
+            for (int i = 0; i < numEvents; i++)
+            {
+                const BridgeMidiEvent& source = shared->midiIn [i];
+                VstMidiEvent& event = midiEventStorage [i];
+
+                memset (&event, 0, sizeof (VstMidiEvent));
+                event.type = kVstMidiType;
+                event.byteSize = sizeof (VstMidiEvent);
+                event.deltaFrames = source.sampleOffset;
+                memcpy (event.midiData, source.data, source.size < 4 ? source.size : 4);
+            }
+
+            midiEvents->numEvents = numEvents;
+            dispatch (effProcessEvents, 0, 0, midiEvents, 0.0f);
+        }
+
+        float* inputs [JOST_BRIDGE_MAX_CHANNELS];
+        float* outputs [JOST_BRIDGE_MAX_CHANNELS];
+
+        int i;
+        for (i = 0; i < shared->numInputs; i++)
+            inputs [i] = shared->audioIn [i];
+
+        for (i = 0; i < shared->numOutputs; i++)
+            outputs [i] = shared->audioOut [i];
+
+        if (effect->flags & effFlagsCanReplacing)
+        {
+            effect->processReplacing (effect, inputs, outputs, numSamples);
+        }
+        else
+        {
+            for (i = 0; i < shared->numOutputs; i++)
+                memset (outputs [i], 0, numSamples * sizeof (float));
+
+            effect->process (effect, inputs, outputs, numSamples);
+        }
+    }
+
+    //==============================================================================
+    void setParameter (const int index, const float value)
+    {
+        effect->setParameter (effect, index, value);
+    }
+
+    float getParameter (const int index)
+    {
+        return effect->getParameter (effect, index);
+    }
+
+    void getParameterName (const int index, char* text)
+    {
+        dispatch (effGetParamName, index, 0, text, 0.0f);
+    }
+
+    void getParameterText (const int index, const float value, char* text)
+    {
+        dispatch (effGetParamDisplay, index, 0, text, 0.0f);
+    }
+
+    int getProgram ()
+    {
+        return dispatch (effGetProgram, 0, 0, 0, 0.0f);
+    }
+
+    void setProgram (const int program)
+    {
+        dispatch (effSetProgram, 0, program, 0, 0.0f);
+    }
+
+    void getProgramName (const int program, char* text)
+    {
+        if (! dispatch (effGetProgramNameIndexed, program, -1, text, 0.0f))
+        {
+            // the hard way - have to set each program to find its name
+            const int current = getProgram ();
+            setProgram (program);
+            dispatch (effGetProgramName, 0, 0, text, 0.0f);
+            setProgram (current);
+        }
+    }
+
+    int getChunk (void** data)
+    {
+        return dispatch (effGetChunk, 0 /* bank */, 0, data, 0.0f);
+    }
+
+    void setChunk (void* data, const int size)
+    {
+        dispatch (effSetChunk, 0 /* bank */, size, data, 0.0f);
+    }
+
+    //==============================================================================
+    bool getEditorSize (int& width, int& height)
+    {
+        ERect* rect = 0;
+        dispatch (effEditGetRect, 0, 0, &rect, 0.0f);
+
+        if (rect == 0)
+            return false;
+
+        width = rect->right - rect->left;
+        height = rect->bottom - rect->top;
+        return true;
+    }
+
+    bool openEditor (Display* display_, Window parent)
+    {
+        display = display_;
+
+        // the window the plugin creates in our parent is the editor
+        Window* before = 0;
+        unsigned int numBefore = 0;
+        queryChildren (parent, &before, &numBefore);
+
+        dispatch (effEditOpen, 0, (VstIntPtr) display, (void*) parent, 0.0f);
+        editorOpen = true;
+
+        Window* after = 0;
+        unsigned int numAfter = 0;
+        queryChildren (parent, &after, &numAfter);
+
+        editorWindow = 0;
+        for (unsigned int i = 0; i < numAfter && editorWindow == 0; i++)
+        {
+            bool found = false;
+            for (unsigned int j = 0; j < numBefore && ! found; j++)
+                found = (after [i] == before [j]);
+
+            if (! found)
+                editorWindow = after [i];
+        }
+
+        if (before != 0) XFree (before);
+        if (after != 0) XFree (after);
+
+        // if the plugin wants us to pass it the events, we'll do it from
+        // here: take the property away, or Jost would call it in its process
+        eventProc = 0;
+        if (editorWindow != 0)
+        {
+            const Atom atom = XInternAtom (display, "_XEventProc", False);
+
+            Atom type;
+            int format;
+            unsigned long numItems, bytesLeft;
+            unsigned char* data = 0;
+
+            if (XGetWindowProperty (display, editorWindow, atom, 0, 1, False, AnyPropertyType,
+                                    &type, &format, &numItems, &bytesLeft, &data) == Success
+                && data != 0)
+            {
+                if (numItems > 0)
+                    eventProc = (void (*) (XEvent*)) (*(long*) data);
+
+                XFree (data);
+                XDeleteProperty (display, editorWindow, atom);
+            }
+        }
+
+        XSync (display, False);
+        return true;
+    }
+
+    void closeEditor ()
+    {
+        dispatch (effEditClose, 0, 0, 0, 0.0f);
+
+        editorOpen = false;
+        editorWindow = 0;
+        eventProc = 0;
+
+        if (display != 0)
+            XSync (display, False);
+    }
+
+    void idle ()
+    {
+        if (editorOpen)
+        {
+            // events for the editor, sent by Jost or coming from the server
+            while (display != 0 && XPending (display) > 0)
+            {
+                XEvent event;
+                XNextEvent (display, &event);
+
+                if (eventProc != 0 && event.xany.window == editorWindow)
+                    eventProc (&event);
+            }
+
+            dispatch (effEditIdle, 0, 0, 0, 0.0f);
+        }
+
+        if (needIdle)
+            needIdle = dispatch (effIdle, 0, 0, 0, 0.0f) != 0;
+    }
+
+    //==============================================================================
+    static VstIntPtr VSTCALLBACK hostCallback (AEffect* effect, VstInt32 opcode, VstInt32 index,
+                                               VstIntPtr value, void* ptr, float opt)
+    {
+        switch (opcode)
+        {
+        case audioMasterVersion:
+            return 2300;
+
+        case audioMasterAutomate:
+            if (shared != 0 && index >= 0 && index < shared->numParameters)
+            {
+                shared->parameterValues [index] = opt;
+
+                // if Jost is too slow reading them, we forget the oldest
+                const int write = shared->automationWrite;
+                const int next = (write + 1) % JOST_BRIDGE_AUTOMATION_SIZE;
+                if (next != shared->automationRead)
+                {
+                    shared->automation [write].index = index;
+                    shared->automation [write].value = opt;
+                    __sync_synchronize ();
+                    shared->automationWrite = next;
+                }
+            }
+            break;
+
+        case audioMasterGetTime:
+            if (shared != 0 && currentPlugin != 0)
+            {
+                VstTimeInfo& info = currentPlugin->timeInfo;
+                const BridgeTimeInfo& source = shared->timeInfo;
+
+                info.samplePos = source.samplePos;
+                info.sampleRate = source.sampleRate;
+                info.nanoSeconds = source.nanoSeconds;
+                info.ppqPos = source.ppqPos;
+                info.tempo = source.tempo;
+                info.barStartPos = source.barStartPos;
+                info.cycleStartPos = source.cycleStartPos;
+                info.cycleEndPos = source.cycleEndPos;
+                info.timeSigNumerator = source.timeSigNumerator;
+                info.timeSigDenominator = source.timeSigDenominator;
+                info.smpteOffset = source.smpteOffset;
+                info.smpteFrameRate = source.smpteFrameRate;
+                info.samplesToNextClock = source.samplesToNextClock;
+                info.flags = source.flags;
+
+                return (VstIntPtr) &info;
+            }
+            break;
+
+        case audioMasterProcessEvents:
+            if (shared != 0 && ptr != 0)
+            {
+                const VstEvents* events = (const VstEvents*) ptr;
+
+                for (int i = 0; i < events->numEvents; i++)
+                {
+                    const VstEvent* event = events->events [i];
+                    if (event == 0 || event->type != kVstMidiType
+                        || shared->numMidiOut >= JOST_BRIDGE_MAX_MIDI_EVENTS)
+                        continue;
+
+                    BridgeMidiEvent& dest = shared->midiOut [shared->numMidiOut++];
+                    dest.sampleOffset = event->deltaFrames;
+                    dest.size = 3;
+                    memcpy (dest.data, ((const VstMidiEvent*) event)->midiData, 4);
+                }
+                return 1;
+            }
+            break;
+
+        case audioMasterGetSampleRate:
+            return currentPlugin != 0 ? (VstIntPtr) currentPlugin->sampleRate : 44100;
+
+        case audioMasterGetBlockSize:
+            return currentPlugin != 0 ? (VstIntPtr) currentPlugin->blockSize : 512;
+
+        case audioMasterGetCurrentProcessLevel:
+            return pthread_equal (pthread_self (), audioThread) ? 2 : 1;
+
+        case audioMasterNeedIdle:
+            if (currentPlugin != 0)
+                currentPlugin->needIdle = true;
+            return 1;
+
+        case audioMasterSizeWindow:
+            return 1;
+
+        case audioMasterGetParameterQuantization:
+            return 1;
+
+        case audioMasterGetVendorString:
+        case audioMasterGetProductString:
+            copyString ((char*) ptr, "Jost", 64);
+            return 1;
+
+        case audioMasterGetDirectory:
+            return currentPlugin != 0 ? (VstIntPtr) currentPlugin->directory : 0;
+
+        case audioMasterCanDo:
+            if (ptr != 0)
+            {
+                const char* what = (const char*) ptr;
+
+                if (strcmp (what, "sendVstEvents") == 0
+                    || strcmp (what, "sendVstMidiEvent") == 0
+                    || strcmp (what, "receiveVstEvents") == 0
+                    || strcmp (what, "receiveVstMidiEvent") == 0
+                    || strcmp (what, "sendVstTimeInfo") == 0
+                    || strcmp (what, "sizeWindow") == 0)
+                    return 1;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        return 0;
+    }
+
+private:
+
+    //==============================================================================
+    int dispatch (const int opcode, const int index, const VstIntPtr value, void* const ptr, float opt)
+    {
+        return effect != 0 ? effect->dispatcher (effect, opcode, index, value, ptr, opt) : 0;
+    }
+
+    bool canDo (const char* what)
+    {
+        return dispatch (effCanDo, 0, 0, (void*) what, 0.0f) > 0;
+    }
+
+    void queryChildren (Window window, Window** children, unsigned int* numChildren)
+    {
+        Window root, parent;
+        if (! XQueryTree (display, window, &root, &parent, children, numChildren))
+        {
+            *children = 0;
+            *numChildren = 0;
+        }
+    }
+
+    //==============================================================================
+    static VstBridgedPlugin* currentPlugin;
+
+    void* library;
+    AEffect* effect;
+    char directory [JOST_BRIDGE_PATH_SIZE];
+
+    Display* display;
+    Window editorWindow;
+    void (*eventProc) (XEvent*);
+    bool editorOpen;
+    volatile bool needIdle;
+
+    VstTimeInfo timeInfo;
+    VstEvents* midiEvents;
+    VstMidiEvent midiEventStorage [JOST_BRIDGE_MAX_MIDI_EVENTS];
+
+    double sampleRate;
+    int blockSize;
+
+public:
+
+    // the chunk Jost is reading or writing, one piece at a time
+    void* chunkData;
+    int chunkSize;
+    char* pendingChunk;
+    int pendingChunkSize;
+};
+
+VstBridgedPlugin* VstBridgedPlugin::currentPlugin = 0;
+
+
+//==============================================================================
+/**
+    A LADSPA plugin, its control ports are our parameters.
+*/
+class LadspaBridgedPlugin : public BridgedPlugin
+{
+public:
+
+    LadspaBridgedPlugin ()
+      : library (0),
+        descriptor (0),
+        handle (0),
+        sampleRate (44100.0),
+        numControls (0)
+    {
+    }
+
+    ~LadspaBridgedPlugin ()
+    {
+        cleanup ();
+
+        if (library != 0)
+            dlclose (library);
+    }
+
+    //==============================================================================
+    bool load (const char* filePath, const int descriptorIndex)
+    {
+        library = dlopen (filePath, RTLD_NOW | RTLD_LOCAL);
+        if (library == 0)
+        {
+            fprintf (stderr, "jost-bridge: %s \n", dlerror ());
+            return false;
+        }
+
+        LADSPA_Descriptor_Function descriptorFunction
+                = (LADSPA_Descriptor_Function) dlsym (library, "ladspa_descriptor");
+
+        if (descriptorFunction == 0)
+            return false;
+
+        descriptor = descriptorFunction (descriptorIndex);
+        if (descriptor == 0)
+            return false;
+
+        for (unsigned long i = 0; i < descriptor->PortCount; i++)
+        {
+            const LADSPA_PortDescriptor pod = descriptor->PortDescriptors [i];
+
+            if (LADSPA_IS_PORT_CONTROL (pod) && LADSPA_IS_PORT_INPUT (pod)
+                && numControls < JOST_BRIDGE_MAX_PARAMETERS)
+            {
+                controlPorts [numControls] = i;
+                normalizedValues [numControls] = getDefaultValue (i);
+                numControls++;
+            }
+        }
+
+        return true;
+    }
+
+    void fillInfo ()
+    {
+        shared->uniqueID = descriptor->UniqueID;
+        shared->numInputs = 0;
+        shared->numOutputs = 0;
+        shared->numParameters = numControls;
+        shared->numPrograms = 0;
+        shared->flags = 0;
+        copyString (shared->name, descriptor->Label, JOST_BRIDGE_NAME_SIZE);
+
+        for (unsigned long i = 0; i < descriptor->PortCount; i++)
+        {
+            const LADSPA_PortDescriptor pod = descriptor->PortDescriptors [i];
+
+            if (LADSPA_IS_PORT_AUDIO (pod))
+            {
+                if (LADSPA_IS_PORT_INPUT (pod) && shared->numInputs < JOST_BRIDGE_MAX_CHANNELS)
+                    shared->numInputs++;
+                else if (LADSPA_IS_PORT_OUTPUT (pod) && shared->numOutputs < JOST_BRIDGE_MAX_CHANNELS)
+                    shared->numOutputs++;
+            }
+        }
+
+        refreshParameterValues ();
+    }
+
+    //==============================================================================
+    void activate (const double sampleRate_, const int blockSize)
+    {
+        // ladspa knows the sample rate only when instantiated
+        if (handle == 0 || sampleRate_ != sampleRate)
+        {
+            cleanup ();
+
+            sampleRate = sampleRate_;
+            handle = descriptor->instantiate (descriptor, (unsigned long) sampleRate);
+            if (handle == 0)
+                return;
+
+            int input = 0, output = 0;
+            for (unsigned long i = 0; i < descriptor->PortCount; i++)
+            {
+                const LADSPA_PortDescriptor pod = descriptor->PortDescriptors [i];
+
+                if (LADSPA_IS_PORT_AUDIO (pod))
+                {
+                    if (LADSPA_IS_PORT_INPUT (pod) && input < JOST_BRIDGE_MAX_CHANNELS)
+                        descriptor->connect_port (handle, i, shared->audioIn [input++]);
+                    else if (LADSPA_IS_PORT_OUTPUT (pod) && output < JOST_BRIDGE_MAX_CHANNELS)
+                        descriptor->connect_port (handle, i, shared->audioOut [output++]);
+                }
+                else
+                {
+                    descriptor->connect_port (handle, i, &portValues [i < JOST_BRIDGE_MAX_PORTS ? i : 0]);
+                }
+            }
+
+            for (int i = 0; i < numControls; i++)
+                setParameter (i, normalizedValues [i]);
+        }
+
+        if (descriptor->activate != 0)
+            descriptor->activate (handle);
+    }
+
+    void deactivate ()
+    {
+        if (handle != 0 && descriptor->deactivate != 0)
+            descriptor->deactivate (handle);
+    }
+
+    void process (const int numSamples)
+    {
+        if (handle != 0)
+        {
+            descriptor->run (handle, numSamples);
+        }
+        else
+        {
+            for (int i = 0; i < shared->numOutputs; i++)
+                memset (shared->audioOut [i], 0, numSamples * sizeof (float));
+        }
+    }
+
+    //==============================================================================
+    void setParameter (const int index, const float value)
+    {
+        normalizedValues [index] = value;
+
+        const unsigned long port = controlPorts [index];
+        if (port < JOST_BRIDGE_MAX_PORTS)
+            portValues [port] = toPortValue (port, value);
+    }
+
+    float getParameter (const int index)
+    {
+        return normalizedValues [index];
+    }
+
+    void getParameterName (const int index, char* text)
+    {
+        copyString (text, descriptor->PortNames [controlPorts [index]], JOST_BRIDGE_NAME_SIZE);
+    }
+
+    void getParameterText (const int index, const float value, char* text)
+    {
+        const unsigned long port = controlPorts [index];
+        const LADSPA_PortRangeHintDescriptor hints = descriptor->PortRangeHints [port].HintDescriptor;
+        const float portValue = toPortValue (port, value);
+
+        if (LADSPA_IS_HINT_TOGGLED (hints))
+            copyString (text, portValue > 0.0f ? "on" : "off", JOST_BRIDGE_NAME_SIZE);
+        else if (LADSPA_IS_HINT_INTEGER (hints))
+            snprintf (text, JOST_BRIDGE_NAME_SIZE, "%d", (int) portValue);
+        else
+            snprintf (text, JOST_BRIDGE_NAME_SIZE, "%.3f", portValue);
+    }
+
+private:
+
+    enum { JOST_BRIDGE_MAX_PORTS = 1024 };
+
+    //==============================================================================
+    void cleanup ()
+    {
+        if (handle != 0 && descriptor->cleanup != 0)
+            descriptor->cleanup (handle);
+
+        handle = 0;
+    }
+
+    void getPortRange (const unsigned long port, float& lower, float& upper) const
+    {
+        const LADSPA_PortRangeHint& hint = descriptor->PortRangeHints [port];
+
+        lower = LADSPA_IS_HINT_BOUNDED_BELOW (hint.HintDescriptor) ? hint.LowerBound : 0.0f;
+        upper = LADSPA_IS_HINT_BOUNDED_ABOVE (hint.HintDescriptor) ? hint.UpperBound : 1.0f;
+
+        if (LADSPA_IS_HINT_SAMPLE_RATE (hint.HintDescriptor))
+        {
+            lower *= (float) sampleRate;
+            upper *= (float) sampleRate;
+        }
+    }
+
+    bool isLogarithmic (const unsigned long port, const float lower, const float upper) const
+    {
+        return LADSPA_IS_HINT_LOGARITHMIC (descriptor->PortRangeHints [port].HintDescriptor)
+               && lower > 0.0f && upper > lower;
+    }
+
+    float toPortValue (const unsigned long port, const float normalized) const
+    {
+        const LADSPA_PortRangeHintDescriptor hints = descriptor->PortRangeHints [port].HintDescriptor;
+
+        float lower, upper;
+        getPortRange (port, lower, upper);
+
+        if (LADSPA_IS_HINT_TOGGLED (hints))
+            return normalized >= 0.5f ? 1.0f : 0.0f;
+
+        float value = isLogarithmic (port, lower, upper)
+                        ? lower * powf (upper / lower, normalized)
+                        : lower + normalized * (upper - lower);
+
+        if (LADSPA_IS_HINT_INTEGER (hints))
+            value = floorf (value + 0.5f);
+
+        return value;
+    }
+
+    float getDefaultValue (const unsigned long port) const
+    {
+        const LADSPA_PortRangeHintDescriptor hints = descriptor->PortRangeHints [port].HintDescriptor;
+
+        // normalized already, we don't care about the actual range here
+        switch (hints & LADSPA_HINT_DEFAULT_MASK)
+        {
+        case LADSPA_HINT_DEFAULT_MINIMUM:   return 0.0f;
+        case LADSPA_HINT_DEFAULT_LOW:       return 0.25f;
+        case LADSPA_HINT_DEFAULT_MIDDLE:    return 0.5f;
+        case LADSPA_HINT_DEFAULT_HIGH:      return 0.75f;
+        case LADSPA_HINT_DEFAULT_MAXIMUM:   return 1.0f;
+        case LADSPA_HINT_DEFAULT_1:
+        case LADSPA_HINT_DEFAULT_100:
+        case LADSPA_HINT_DEFAULT_440:
+            {
+                float lower, upper;
+                getPortRange (port, lower, upper);
+
+                const float value = ((hints & LADSPA_HINT_DEFAULT_MASK) == LADSPA_HINT_DEFAULT_1) ? 1.0f
+                                  : ((hints & LADSPA_HINT_DEFAULT_MASK) == LADSPA_HINT_DEFAULT_100) ? 100.0f
+                                  : 440.0f;
+
+                if (upper <= lower)
+                    return 0.0f;
+
+                const float normalized = isLogarithmic (port, lower, upper)
+                                           ? logf (value / lower) / logf (upper / lower)
+                                           : (value - lower) / (upper - lower);
+
+                return normalized < 0.0f ? 0.0f : (normalized > 1.0f ? 1.0f : normalized);
+            }
+        case LADSPA_HINT_DEFAULT_0:
+        default:
+            return 0.0f;
+        }
+    }
+
+    //==============================================================================
+    void* library;
+    const LADSPA_Descriptor* descriptor;
+    LADSPA_Handle handle;
+    double sampleRate;
+
+    int numControls;
+    unsigned long controlPorts [JOST_BRIDGE_MAX_PARAMETERS];
+    float normalizedValues [JOST_BRIDGE_MAX_PARAMETERS];
+    LADSPA_Data portValues [JOST_BRIDGE_MAX_PORTS];
+};
+
+
+//==============================================================================
+static void printEntry (const int type, const int descriptorIndex, const int uniqueID,
+                        const int numInputs, const int numOutputs,
+                        const int numMidiOutputs, const int numParameters, const char* name)
+{
+    char cleanName [JOST_BRIDGE_NAME_SIZE];
+    copyString (cleanName, name, JOST_BRIDGE_NAME_SIZE);
+
+    for (char* c = cleanName; *c != 0; c++)
+        if (*c == '\t' || *c == '\n')
+            *c = ' ';
+
+    printf ("E\t%d\t%d\t%d\t%d\t%d\t1\t%d\t%d\t%s\n",
+            type, descriptorIndex, uniqueID, numInputs, numOutputs,
+            numMidiOutputs, numParameters, cleanName);
+}
+
+static int probeLibrary (const char* filePath)
+{
+    // we'll fill in a private block, as if Jost asked us to load it
+    BridgeShared* block = (BridgeShared*) calloc (1, sizeof (BridgeShared));
+    if (block == 0)
+        return 1;
+
+    shared = block;
+
+    void* library = dlopen (filePath, RTLD_NOW | RTLD_LOCAL);
+    if (library == 0)
+        return 1;
+
+    const bool isVst = dlsym (library, "VSTPluginMain") != 0 || dlsym (library, "main") != 0;
+    LADSPA_Descriptor_Function ladspaFunction
+            = (LADSPA_Descriptor_Function) dlsym (library, "ladspa_descriptor");
+
+    if (isVst)
+    {
+        VstBridgedPlugin* plugin = new VstBridgedPlugin ();
+        if (plugin->load (filePath, 0))
+        {
+            plugin->fillInfo ();
+            printEntry (BridgePluginVst, 0, shared->uniqueID,
+                        shared->numInputs, shared->numOutputs,
+                        (shared->flags & BridgeFlagProducesMidi) ? 1 : 0,
+                        shared->numParameters, shared->name);
+        }
+        delete plugin;
+    }
+    else if (ladspaFunction != 0)
+    {
+        for (int index = 0; ladspaFunction (index) != 0; index++)
+        {
+            LadspaBridgedPlugin* plugin = new LadspaBridgedPlugin ();
+            if (plugin->load (filePath, index))
+            {
+                plugin->fillInfo ();
+                printEntry (BridgePluginLadspa, index, shared->uniqueID,
+                            shared->numInputs, shared->numOutputs, 0,
+                            shared->numParameters, shared->name);
+            }
+            delete plugin;
+        }
+    }
+
+    fflush (stdout);
+
+    dlclose (library);
+    free (block);
+    return 0;
+}
+
+
+//==============================================================================
+static BridgedPlugin* plugin = 0;
+static Display* display = 0;
+
+static int ignoreXErrors (Display*, XErrorEvent*)
+{
+    return 0;
+}
+
+static void* audioThreadEntry (void*)
+{
+    // run as close as we can to the Jost audio thread
+    struct sched_param param;
+    param.sched_priority = JOST_BRIDGE_AUDIO_PRIORITY;
+    pthread_setschedparam (pthread_self (), SCHED_FIFO, &param);
+
+    int32_t lastRequest = shared->processRequest;
+
+    while (running)
+    {
+        if (! bridgeFutexWait (&shared->processRequest, lastRequest, 100))
+            continue;
+
+        lastRequest = shared->processRequest;
+
+        __sync_synchronize ();
+        plugin->processPeriod ();
+        __sync_synchronize ();
+
+        bridgeFutexSet (&shared->processDone, lastRequest);
+    }
+
+    return 0;
+}
+
+static void handleCommand ()
+{
+    shared->commandResult = 0;
+
+    switch (shared->command)
+    {
+    case BridgeCommandActivate:
+        plugin->activate (shared->commandDouble, shared->commandValue);
+        break;
+
+    case BridgeCommandDeactivate:
+        plugin->deactivate ();
+        break;
+
+    case BridgeCommandApplyParameters:
+        plugin->applyParameterChanges ();
+        break;
+
+    case BridgeCommandGetParameterName:
+        shared->data [0] = 0;
+        if (shared->commandIndex >= 0 && shared->commandIndex < shared->numParameters)
+            plugin->getParameterName (shared->commandIndex, shared->data);
+        break;
+
+    case BridgeCommandGetParameterText:
+        shared->data [0] = 0;
+        if (shared->commandIndex >= 0 && shared->commandIndex < shared->numParameters)
+            plugin->getParameterText (shared->commandIndex, shared->commandFloat, shared->data);
+        break;
+
+    case BridgeCommandGetProgram:
+        shared->commandResult = plugin->getProgram ();
+        break;
+
+    case BridgeCommandSetProgram:
+        plugin->setProgram (shared->commandIndex);
+        plugin->refreshParameterValues ();
+        break;
+
+    case BridgeCommandGetProgramName:
+        shared->data [0] = 0;
+        plugin->getProgramName (shared->commandIndex, shared->data);
+        break;
+
+    case BridgeCommandGetChunk:
+        if (shared->pluginType == BridgePluginVst)
+        {
+            VstBridgedPlugin* vst = (VstBridgedPlugin*) plugin;
+            vst->chunkData = 0;
+            vst->chunkSize = plugin->getChunk (&vst->chunkData);
+            shared->commandResult = vst->chunkData != 0 ? vst->chunkSize : 0;
+        }
+        break;
+
+    case BridgeCommandGetChunkData:
+        shared->dataSize = 0;
+        if (shared->pluginType == BridgePluginVst)
+        {
+            VstBridgedPlugin* vst = (VstBridgedPlugin*) plugin;
+            const int offset = shared->commandIndex;
+
+            if (vst->chunkData != 0 && offset >= 0 && offset < vst->chunkSize)
+            {
+                const int left = vst->chunkSize - offset;
+                shared->dataSize = left < JOST_BRIDGE_DATA_SIZE ? left : JOST_BRIDGE_DATA_SIZE;
+                memcpy (shared->data, (char*) vst->chunkData + offset, shared->dataSize);
+            }
+        }
+        break;
+
+    case BridgeCommandSetChunkData:
+        if (shared->pluginType == BridgePluginVst)
+        {
+            VstBridgedPlugin* vst = (VstBridgedPlugin*) plugin;
+            const int offset = shared->commandIndex;
+            const int totalSize = shared->commandValue;
+
+            if (offset == 0)
+            {
+                free (vst->pendingChunk);
+                vst->pendingChunk = (char*) malloc (totalSize > 0 ? totalSize : 1);
+                vst->pendingChunkSize = totalSize;
+            }
+
+            if (vst->pendingChunk != 0
+                && totalSize == vst->pendingChunkSize
+                && offset >= 0 && shared->dataSize >= 0
+                && offset + shared->dataSize <= totalSize)
+            {
+                memcpy (vst->pendingChunk + offset, shared->data, shared->dataSize);
+
+                // the last piece is here
+                if (offset + shared->dataSize == totalSize)
+                {
+                    plugin->setChunk (vst->pendingChunk, totalSize);
+                    plugin->refreshParameterValues ();
+
+                    free (vst->pendingChunk);
+                    vst->pendingChunk = 0;
+                    vst->pendingChunkSize = 0;
+                }
+            }
+        }
+        break;
+
+    case BridgeCommandGetEditorSize:
+        {
+            int width = 0, height = 0;
+            plugin->getEditorSize (width, height);
+            shared->commandIndex = width;
+            shared->commandValue = height;
+        }
+        break;
+
+    case BridgeCommandOpenEditor:
+        if (display == 0)
+        {
+            display = XOpenDisplay (0);
+            XSetErrorHandler (ignoreXErrors);
+        }
+
+        if (display != 0)
+            shared->commandResult = plugin->openEditor (display, (Window) (uint32_t) shared->commandValue) ? 1 : 0;
+        break;
+
+    case BridgeCommandCloseEditor:
+        plugin->closeEditor ();
+        break;
+
+    case BridgeCommandQuit:
+        running = false;
+        break;
+
+    default:
+        break;
+    }
+}
+
+static int runBridge (const char* sharedName)
+{
+    const int fd = shm_open (sharedName, O_RDWR, 0600);
+    if (fd < 0)
+    {
+        fprintf (stderr, "jost-bridge: cannot open shared memory %s \n", sharedName);
+        return 1;
+    }
+
+    void* memory = mmap (0, sizeof (BridgeShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close (fd);
+
+    if (memory == MAP_FAILED)
+        return 1;
+
+    shared = (BridgeShared*) memory;
+    mlock (shared, sizeof (BridgeShared));
+
+    if (shared->magic != JOST_BRIDGE_MAGIC
+        || shared->version != JOST_BRIDGE_VERSION
+        || shared->structSize != (int32_t) sizeof (BridgeShared))
+    {
+        fprintf (stderr, "jost-bridge: this bridge doesn't match this Jost \n");
+        bridgeFutexSet (&shared->ready, -1);
+        return 1;
+    }
+
+    shared->filePath [JOST_BRIDGE_PATH_SIZE - 1] = 0;
+
+    if (shared->pluginType == BridgePluginVst)
+        plugin = new VstBridgedPlugin ();
+    else
+        plugin = new LadspaBridgedPlugin ();
+
+    if (! plugin->load (shared->filePath, shared->descriptorIndex))
+    {
+        fprintf (stderr, "jost-bridge: cannot load %s \n", shared->filePath);
+        bridgeFutexSet (&shared->ready, -1);
+        return 1;
+    }
+
+    plugin->fillInfo ();
+
+    audioThread = pthread_self ();
+    if (pthread_create (&audioThread, 0, audioThreadEntry, 0) != 0)
+    {
+        bridgeFutexSet (&shared->ready, -1);
+        return 1;
+    }
+
+    bridgeFutexSet (&shared->ready, 1);
+
+    // commands, editor events and idle all come from here
+    const pid_t parentPid = getppid ();
+    int32_t lastCommand = shared->commandRequest;
+
+    while (running)
+    {
+        // Jost went away without telling us
+        if (getppid () != parentPid)
+            break;
+
+        if (bridgeFutexWait (&shared->commandRequest, lastCommand, JOST_BRIDGE_IDLE_INTERVAL))
+        {
+            lastCommand = shared->commandRequest;
+
+            __sync_synchronize ();
+            handleCommand ();
+            __sync_synchronize ();
+
+            bridgeFutexSet (&shared->commandDone, lastCommand);
+        }
+
+        plugin->idle ();
+    }
+
+    running = false;
+    pthread_join (audioThread, 0);
+
+    delete plugin;
+
+    if (display != 0)
+        XCloseDisplay (display);
+
+    munmap (shared, sizeof (BridgeShared));
+    return 0;
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    signal (SIGPIPE, SIG_IGN);
+
+    if (argc == 3 && strcmp (argv [1], "--probe") == 0)
+        return probeLibrary (argv [2]);
+
+    if (argc == 2)
+    {
+        // plugins may open their editors from their own threads
+        XInitThreads ();
+
+        return runBridge (argv [1]);
+    }
+
+    fprintf (stderr, "usage: jost-bridge --probe <library> \n"
+                     "       jost-bridge <shared memory name> \n");
+    return 1;
+}
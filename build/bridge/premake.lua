@@ -0,0 +1,44 @@
+
+-- the bridge runs plugins of another architecture for jost, so it's
+-- built for that one: 32bit, to be shipped next to a 64bit jost
+
+project.name = "jost-bridge"
+project.bindir = "../../bin"
+project.libdir = "../../bin"
+project.configs = { "Debug", "Release" }
+
+package = newpackage()
+package.name = project.name
+package.target = project.name
+package.kind = "exe"
+package.language = "c++"
+package.objdir = project.bindir .. "/intermediate"
+
+package.config["Debug"].objdir            = package.objdir .. "/" .. package.name .. "Debug"
+package.config["Debug"].defines           = { "DEBUG=1", "_DEBUG=1" }
+package.config["Debug"].buildoptions      = { "-m32 -O0 -g -Wall" }
+
+package.config["Release"].objdir          = package.objdir .. "/" .. package.name .. "Release"
+package.config["Release"].defines         = { "NDEBUG=1" }
+package.config["Release"].buildoptions    = { "-m32 -O2 -pipe -Wall" }
+package.config["Release"].buildflags      = { "no-symbols", "no-frame-pointer" }
+
+package.defines = { "LINUX=1" }
+package.linkoptions = { "-m32" }
+package.libpaths = { "/usr/X11R6/lib32/", "/usr/lib32/" }
+package.links = { "dl", "pthread", "rt", "X11" }
+
+package.includepaths = {
+    "/usr/include",
+    "../../vst/vstsdk2.3",
+    "../../vst/vstsdk2.3/source/common",
+    "../../vstsdk2.3",
+    "../../vstsdk2.3/source/common",
+    "/usr/include/vstsdk2.3",
+    "/usr/include/vst",
+    "../../src"
+}
+
+package.files = {
+    "../../bridge/JostBridge.cpp"
+}
@@ -237,6 +237,7 @@ function configure_jost_libraries (package, standalone)
     addoption ("disable-vst",     "Force disable VST (2.3) support")
     addoption ("disable-ladspa",  "Force disable LADSPA support")
     addoption ("disable-dssi",    "Force disable DSSI support")
+    addoption ("disable-bridge",  "Force disable the bridge for plugins of another architecture")
 
     if (os.fileexists ("/usr/include/vst/audioeffectx.h") and not options["disable-vst"]) then
         table.insert (package.defines, "JOST_USE_VST=1")
@@ -259,6 +260,12 @@ function configure_jost_libraries (package, standalone)
         table.insert (package.defines, "JOST_USE_DSSI=0")
     end
 
+    if (not options["disable-bridge"]) then
+        table.insert (package.defines, "JOST_USE_BRIDGE=1")
+    else
+        table.insert (package.defines, "JOST_USE_BRIDGE=0")
+    end
+
     if (not standalone) then
         table.insert (package.defines, "JOST_VST_PLUGIN=1")
     end
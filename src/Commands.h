@@ -45,7 +45,8 @@ namespace CommandIDs
 
     static const int sessionLoad        = 0x2100;
     static const int sessionSave        = 0x2101;
-    static const int sessionNew         = 0x2102;
+    static const int sessionNew         = 0x2102;
+    static const int sessionExportXml   = 0x2103;
 
     static const int audioOptions       = 0x2200;
     static const int audioPlay          = 0x2201;
@@ -53,6 +54,10 @@ namespace CommandIDs
     static const int audioRecord        = 0x2203;
     static const int audioRewind        = 0x2204;
     static const int audioLoop          = 0x2205;
+    static const int audioMidiClock     = 0x2206;
+    static const int audioMidiTimecode  = 0x2207;
+    static const int audioMetronome     = 0x2208;
+    static const int audioPreRoll       = 0x2209;
 
     static const int appToolbar         = 0x2400;
     static const int appBrowser         = 0x2401;
@@ -65,6 +70,8 @@ namespace CommandIDs
 
     static const int recentPlugins      = 0x9000;
     static const int recentSessions     = 0x9900;
+    static const int storeScenes        = 0x9a00;
+    static const int recallScenes       = 0x9b00;
 };
 
 
@@ -131,6 +131,12 @@ void Config::read ()
     externalTempoMaster = config->getBoolValue (T("external_tempo_master"), false);
     autoConnectInputs = config->getBoolValue (T("auto_connect_inputs"), false);
     autoConnectOutputs = config->getBoolValue (T("auto_connect_outputs"), false);
+    doublePrecision = config->getBoolValue (T("double_precision"), false);
+    pluginPoolSize = config->getIntValue (T("plugin_pool_size"), 0);
+    lazyPluginLoading = config->getBoolValue (T("lazy_plugin_loading"), true);
+    binarySessions = config->getBoolValue (T("binary_sessions"), false);
+    compressSessionChunks = config->getBoolValue (T("compress_session_chunks"), false);
+    autosaveInterval = config->getIntValue (T("autosave_interval"), 120);
 
     // visual graph options
     mainWindowBounds = Rectangle::fromString (config->getValue (T("last_window_bounds"), T("0 0 1 1")));
@@ -170,6 +176,12 @@ void Config::write ()
     config->setValue (T("external_tempo_master"), externalTempoMaster);
     config->setValue (T("auto_connect_inputs"), autoConnectInputs);
     config->setValue (T("auto_connect_outputs"), autoConnectOutputs);
+    config->setValue (T("double_precision"), doublePrecision);
+    config->setValue (T("plugin_pool_size"), pluginPoolSize);
+    config->setValue (T("lazy_plugin_loading"), lazyPluginLoading);
+    config->setValue (T("binary_sessions"), binarySessions);
+    config->setValue (T("compress_session_chunks"), compressSessionChunks);
+    config->setValue (T("autosave_interval"), autosaveInterval);
     config->setValue (T("last_window_bounds"), mainWindowBounds.toString());
     config->setValue (T("node_left_to_right"), graphLeftToRight);
     config->setValue (T("show_tooltips"), showTooltips);
@@ -45,6 +45,12 @@
 #define JOST_CONFIG_EXTENSION               T("conf")
 #define JOST_COLOR_SCHEME_PATH              T("~/.jost/colourscheme.conf")
 #define JOST_BOOKMARK_PATH                  T("~/.jost/bookmarks.conf")
+#define JOST_METRONOME_CLICK_PATH           T("~/.jost/click.wav")
+#define JOST_PLUGIN_CACHE_PATH              T("~/.jost/plugins.cache")
+#define JOST_AUTOSAVE_DIRECTORY             T("~/.jost")
+#define JOST_AUTOSAVE_PREFIX                T("autosave-")
+#define JOST_AUTOSAVE_EXTENSION             T(".jxs")
+#define JOST_AUTOSAVE_LOCK_EXTENSION        T(".lock")
 
 // preset configuration
 #define JOST_PRESET_TRACKTAG                T("track")
@@ -59,6 +65,27 @@
 #define JOST_BOOKMARK_PLUGINTAG             T("plugin")
 #define JOST_BOOKMARK_PRESETTAG             T("preset")
 
+#define JOST_PLUGIN_CACHE_TAG               T("plugins")
+#define JOST_PLUGIN_SCAN_TIMEOUT            60000
+#define JOST_PLUGIN_SCAN_BATCH              16
+#define JOST_PLUGIN_SCAN_POLL_INTERVAL      20
+#define JOST_PLUGIN_SCAN_ARGUMENT           "--scan"
+#define JOST_PLUGIN_SCAN_EXECUTABLE         T("jost")
+
+// plugin libraries nothing references anymore are unloaded this often
+#define JOST_PLUGIN_MODULE_UNLOAD_INTERVAL  1000
+
+// plugin libraries loaded at once when opening a session
+#define JOST_SESSION_LOAD_THREADS           8
+#define JOST_SESSION_LOAD_REPORT_INTERVAL   100
+#define JOST_SESSION_LOAD_SWAP_INTERVAL     500
+
+// binary sessions, plugin states aligned in the file
+#define JOST_SESSION_CHUNK_ALIGNMENT        64
+
+// changes coming from the external play head are notified this often
+#define JOST_TRANSPORT_NOTIFY_INTERVAL      50
+
 // common extensions
 #define JOST_PLUGIN_EXTENSION               T(".so")
 #define JOST_PLUGIN_WILDCARD                T("*.so")
@@ -67,6 +94,42 @@
 #define JOST_PRESET_EXTENSION               T(".jxp")
 #define JOST_PRESET_WILDCARD                T("*.jxp")
 
+// scenes, addressable by midi program change
+#define JOST_MAX_SCENES                     128
+#define JOST_MENU_SCENES                    16
+
+// plugin parameters, changed from the gui or automation
+#define JOST_PARAMETER_QUEUE_SIZE           1024
+#define JOST_PARAMETER_RAMP_SAMPLES         32
+
+// vst midi events sent by plugins, and room for their sysex
+#define JOST_VST_MIDI_OUT_EVENTS            1024
+#define JOST_VST_SYSEX_POOL_SIZE            65536
+#define JOST_VST_MAX_SYSEX_EVENTS           64
+
+// vst midi events going to plugins, sized from the period and what we've seen
+#define JOST_VST_MIN_MIDI_EVENTS            128
+#define JOST_VST_SAMPLES_PER_MIDI_EVENT     4
+#define JOST_VST_MIDI_RESIZE_INTERVAL       500
+
+// dssi midi events per block and instances run in a single call
+#define JOST_DSSI_MIN_MIDI_EVENTS           512
+#define JOST_DSSI_MIDI_EVENTS_PER_SAMPLE    2
+#define JOST_DSSI_MAX_SYNTHS                32
+#define JOST_DSSI_MIDI_RESIZE_INTERVAL      500
+
+// plugins built for another architecture, run in a bridge process
+#define JOST_BRIDGE_EXECUTABLE              T("jost-bridge")
+#define JOST_BRIDGE_START_TIMEOUT           10000
+#define JOST_BRIDGE_COMMAND_TIMEOUT         5000
+#define JOST_BRIDGE_PROCESS_PERIOD_RATIO    0.5
+#define JOST_BRIDGE_MAX_MISSED_PERIODS      64
+#define JOST_BRIDGE_AUTOMATION_INTERVAL     40
+
+// dssi guis, talking to us on a shared osc port
+#define JOST_DSSI_OSC_PORT                  18910
+#define JOST_DSSI_GUI_INTERVAL              40
+
 // available connection types
 #define JOST_LINKTYPE_AUDIO                 0
 #define JOST_LINKTYPE_MIDI                  1
@@ -85,6 +148,8 @@
 #define JOST_PLUGINTYPE_MIDIFILTER          8
 #define JOST_PLUGINTYPE_MIDIPADS            9
 #define JOST_PLUGINTYPE_AUDIOSPECMETER      51
+#define JOST_PLUGINTYPE_METRONOME           52
+#define JOST_PLUGINTYPE_PLACEHOLDER         53
 #define JOST_PLUGINTYPE_VST                 101
 #define JOST_PLUGINTYPE_LADSPA              102
 #define JOST_PLUGINTYPE_DSSI                103
@@ -113,6 +178,10 @@
 
 #ifndef JOST_USE_DSSI
  #define JOST_USE_DSSI                      0
+#endif
+
+#ifndef JOST_USE_BRIDGE
+ #define JOST_USE_BRIDGE                    0
 #endif
 
 #ifndef JOST_USE_LASH
@@ -171,6 +240,22 @@ public:
     bool externalTempoMaster;
     bool autoConnectInputs;
     bool autoConnectOutputs;
+    bool doublePrecision;
+
+    /** Plugin instances kept warm when a session is closed, 0 to disable */
+    int pluginPoolSize;
+
+    /** Let sessions play with placeholders while their plugins are loading */
+    bool lazyPluginLoading;
+
+    /** Save sessions in the binary format instead of xml documents, off by default */
+    bool binarySessions;
+
+    /** Compress plugin states in binary sessions */
+    bool compressSessionChunks;
+
+    /** Seconds between session autosaves, 0 to disable */
+    int autosaveInterval;
 
     /** Visual properties / Colour scheme */
     Rectangle mainWindowBounds;
@@ -37,7 +37,9 @@ int HostFilterBase::numInstances = 0;
 
 //==============================================================================
 HostFilterBase::HostFilterBase (const String& commandLine)
-  : host (0)
+  : host (0),
+    autosaver (0),
+    resumeWhenLoaded (false)
 {
     DBG ("HostFilterBase::HostFilterBase");
 
@@ -47,6 +49,9 @@ HostFilterBase::HostFilterBase (const String& commandLine)
     // create the command manager
     CommandManager::getInstance();
 
+    // read the plugin cache, probing again changed libraries in background
+    PluginScanner::getInstance ()->rescanChangedFiles ();
+
     // TODO - this is a hack for a single dummy parameter
     //        make this to follow plugin parameters
     setNumParameters (1);
@@ -60,19 +65,39 @@ HostFilterBase::HostFilterBase (const String& commandLine)
                      JucePlugin_MaxNumInputChannels,
                      JucePlugin_MaxNumOutputChannels);
 
-    // load a session file !
+    // let scenes be selected by a learned midi controller
+    midiAutomatorManager.registerMidiAutomatable (host->getSceneManager ());
+
+    // a previous run didn't close properly, offer to recover its session
     File sessionFile (commandLine);
-    if (sessionFile.existsAsFile ())
+    const File recoverableFile (SessionAutosaver::findRecoverableSession ());
+    if (recoverableFile.existsAsFile ()
+        && AlertWindow::showOkCancelBox (AlertWindow::QuestionIcon,
+                                         T("Session recovery"),
+                                         T("Jost was not closed properly last time.\nDo you want to recover the autosaved session ?")))
     {
-        MemoryBlock fileData;
-        if (sessionFile.loadFileAsData (fileData))
-        {
-            setStateInformation (fileData.getData (), fileData.getSize());
+        loadSessionFromFile (recoverableFile);
+
+        // our own autosave takes over from now on
+        SessionAutosaver::discardAutosave (recoverableFile);
+    }
+    else
+    {
+        if (recoverableFile.existsAsFile ())
+            SessionAutosaver::discardAutosave (recoverableFile);
 
+        // load a session file !
+        if (sessionFile.existsAsFile ()
+            && loadSessionFromFile (sessionFile))
+        {
             config->addRecentSession (sessionFile);
         }
     }
 
+    // save the session in background from now on
+    autosaver = new SessionAutosaver (host);
+    autosaver->setInterval (config->autosaveInterval);
+
 #if JUCE_LASH
     // initialize lash
     lashManager = new LashManager (this);
@@ -88,13 +113,22 @@ HostFilterBase::~HostFilterBase()
     deleteAndZero (lashManager);
 #endif
 
+    // we are closing properly, the autosaver removes its autosave
+    deleteAndZero (autosaver);
+
     // free host and transport
+    midiAutomatorManager.removeMidiAutomatable (host->getSceneManager ());
     deleteAndZero (host);
     deleteAndZero (transport);
 
     // static deallocation
     if (--HostFilterBase::numInstances == 0)
     {
+        PluginScanner::deleteInstance ();
+#if JUCE_ALSA && JOST_USE_DSSI
+        DssiPluginOscManager::deleteInstance ();
+#endif
+        PluginModuleManager::deleteInstance ();
         Config::deleteInstance ();
     }
 
@@ -154,15 +188,13 @@ void HostFilterBase::getStateInformation (MemoryBlock& destData)
 {
     DBG ("HostFilterBase::getStateInformation");
 
-    // we started saving data
-    bool wasSuspended = isSuspended ();
-    if (! wasSuspended) suspendProcessing (true);
-
+    // plugins are captured one by one, we don't need to stop processing
 #ifndef JUCE_DEBUG
     try
     {
 #endif
-        XmlElement xmlState (JOST_PRESET_SESSIONTAG);
+        XmlElement xmlState (JOST_PRESET_SESSIONTAG);
+
         XmlElement* e = new XmlElement (JOST_PRESET_TRACKTAG);
         host->saveToXml (e);
         xmlState.addChildElement (e);
@@ -178,51 +210,172 @@ void HostFilterBase::getStateInformation (MemoryBlock& destData)
                                      T("Something bad occurred while saving session XML !"));
     }
 #endif
+}
+
+bool HostFilterBase::saveSessionToFile (const File& sessionFile, const bool asXml)
+{
+    DBG ("HostFilterBase::saveSessionToFile");
+
+    const File tempFile (sessionFile.getSiblingFile (sessionFile.getFileName () + T(".tmp")));
+    tempFile.deleteFile ();
+
+    FileOutputStream* out = tempFile.createOutputStream ();
+    if (out == 0)
+    {
+        printf ("Error opening %s for writing\n", (const char*) tempFile.getFullPathName ());
+        return false;
+    }
+
+    bool written = true;
+
+#ifndef JUCE_DEBUG
+    try
+    {
+#endif
+        // the document leaves out plugin states, they go in its place later
+        XmlElement xmlState (JOST_PRESET_SESSIONTAG);
+        XmlElement* e = new XmlElement (JOST_PRESET_TRACKTAG);
+        host->saveToXml (e, true);
+        xmlState.addChildElement (e);
+
+        if (Config::getInstance ()->binarySessions && ! asXml)
+        {
+            written = SessionFile::writeToStream (*out, xmlState, host,
+                                                  Config::getInstance ()->compressSessionChunks);
+        }
+        else
+        {
+            const String document (xmlState.createDocument (String::empty, true));
+
+            int position = 0;
+            for (int i = 0; i < host->getPluginsCount () && written; i++)
+            {
+                BasePlugin* plugin = host->getPluginByIndex (i);
+
+                const String marker (plugin->getDeferredStateMarker ());
+                const int markerPosition = document.indexOf (position, marker);
+                if (markerPosition < 0)
+                    continue;
+
+                const String text (document.substring (position, markerPosition));
+
+                written = out->write ((const char*) text, text.length ())
+                          && plugin->writeStateToStream (*out);
+
+                position = markerPosition + marker.length ();
+            }
+
+            if (written)
+            {
+                const String text (document.substring (position));
+
+                written = out->write ((const char*) text, text.length ());
+            }
+        }
+
+        out->flush ();
+#ifndef JUCE_DEBUG
+    }
+    catch (...)
+    {
+        written = false;
+    }
+#endif
 
-    // end saving data
-    if (! wasSuspended) suspendProcessing (false);
+    delete out;
+
+    if (written)
+        written = tempFile.moveFileTo (sessionFile);
+
+    if (! written)
+    {
+        printf ("Error saving session to %s\n", (const char*) sessionFile.getFullPathName ());
+        tempFile.deleteFile ();
+    }
+
+    return written;
 }
 
 void HostFilterBase::setStateInformation (const void* data, int sizeInBytes)
 {
     DBG ("HostFilterBase::setStateInformation");
 
-    // we started saving data
-    bool wasSuspended = isSuspended ();
+    // session files are plain xml documents, hosts give us binary blobs
+    XmlElement* xmlState = 0;
+    if (sizeInBytes > 0 && ((const char*) data) [0] == '<')
+    {
+        XmlDocument document (String ((const char*) data, sizeInBytes));
+        xmlState = document.getDocumentElement ();
+    }
+    else
+    {
+        // use this helper function to get the XML from this binary blob..
+        xmlState = getXmlFromBinary (data, sizeInBytes);
+    }
+
+    loadSession (xmlState, 0);
+}
+
+bool HostFilterBase::loadSessionFromFile (const File& sessionFile)
+{
+    DBG ("HostFilterBase::loadSessionFromFile");
+
+    // binary sessions are mapped, their plugin states are not read now
+    if (SessionFile::isBinarySession (sessionFile))
+    {
+        SessionChunksPtr chunks;
+        XmlElement* xmlState = SessionFile::readFromFile (sessionFile, chunks);
+        if (xmlState == 0)
+            return false;
+
+        loadSession (xmlState, chunks);
+        return true;
+    }
+
+    MemoryBlock fileData;
+    if (! sessionFile.loadFileAsData (fileData))
+        return false;
+
+    setStateInformation (fileData.getData (), fileData.getSize());
+    return true;
+}
+
+void HostFilterBase::loadSession (XmlElement* xmlState, SessionChunks* chunks)
+{
+    if (xmlState == 0)
+        return;
+
+    // we started saving data, a session still waiting for its plugins
+    // was suspended by us and will not resume anymore
+    bool wasSuspended = isSuspended () && ! resumeWhenLoaded;
+    resumeWhenLoaded = false;
     if (! wasSuspended) suspendProcessing (true);
 
 #ifndef JUCE_DEBUG
     try
     {
 #endif
-        // use this helper function to get the XML from this binary blob..
-        XmlElement* const xmlState = getXmlFromBinary (data, sizeInBytes);
-        if (xmlState != 0)
+        // check that it's the right type of xml..
+        if (xmlState->hasTagName (JOST_PRESET_SESSIONTAG))
         {
-            // check that it's the right type of xml..
-            if (xmlState->hasTagName (JOST_PRESET_SESSIONTAG))
+            // load from XML and notify GUI
+            XmlElement* e = xmlState->getChildByName (JOST_PRESET_TRACKTAG);
+            if (e)
             {
-                // load from XML and notify GUI
-                XmlElement* e = xmlState->getChildByName (JOST_PRESET_TRACKTAG);
-                if (e)
-                {
-                    // notify GUI about the new session
-                    if (getEditor())
-                        getEditor()->closePluginEditorWindows ();
+                // notify GUI about the new session
+                if (getEditor())
+                    getEditor()->closePluginEditorWindows ();
 
-                    host->loadFromXml (e);
+                host->loadFromXml (e, chunks);
 
-                    // notify GUI about the new session
-                    sendChangeMessage (this);
-                }
-
-                delete xmlState;
-            }
-            else
-            {
-                printf ("Error parsing session XML\n");
+                // notify GUI about the new session
+                sendChangeMessage (this);
             }
         }
+        else
+        {
+            printf ("Error parsing session XML\n");
+        }
 
 #ifndef JUCE_DEBUG
     }
@@ -234,8 +387,27 @@ void HostFilterBase::setStateInformation (const void* data, int sizeInBytes)
     }
 #endif
 
-    // we finished saving data
-    if (! wasSuspended) suspendProcessing (false);
+    delete xmlState;
+
+    // we finished saving data, unless the plugins are still loading
+    if (! wasSuspended)
+    {
+        if (host->isWaitingForPlugins ())
+            resumeWhenLoaded = true;
+        else
+            suspendProcessing (false);
+    }
+}
+
+void HostFilterBase::sessionPluginsLoaded ()
+{
+    DBG ("HostFilterBase::sessionPluginsLoaded");
+
+    if (resumeWhenLoaded)
+    {
+        resumeWhenLoaded = false;
+        suspendProcessing (false);
+    }
 }
 
 
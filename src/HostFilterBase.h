@@ -33,6 +33,8 @@
 #include "Commands.h"
 #include "model/BasePlugin.h"
 #include "model/Host.h"
+#include "model/SessionAutosaver.h"
+#include "model/SessionFile.h"
 #include "model/Transport.h"
 
 
@@ -91,6 +93,27 @@ public:
 
     /** Called to restore host session state */
     void setStateInformation (const void* data, int sizeInBytes);
+
+    /** Save the session to disk, streaming plugin states to it
+
+        Plugins are captured one at a time, so the host keeps processing.
+        The session is written as a binary session, or as an xml document
+        when binary sessions are disabled in the configuration or asXml is
+        true, which lets sessions be exported for other tools.
+
+        @see SessionFile
+    */
+    bool saveSessionToFile (const File& sessionFile, const bool asXml = false);
+
+    /** Load a binary or xml session from disk */
+    bool loadSessionFromFile (const File& sessionFile);
+
+    /** Called by the host when the session plugins it waited for are ready
+
+        Processing stays suspended until then if the session is not loaded
+        lazily, so this resumes it.
+    */
+    void sessionPluginsLoaded ();
 
     //==============================================================================
     /** This is used to set an external transport, if any */
@@ -107,6 +130,9 @@ protected:
     //==============================================================================
     friend class HostFilterComponent;
 
+    //==============================================================================
+    void loadSession (XmlElement* xmlState, SessionChunks* chunks);
+
     // a dummy parameter
     // TODO - make parameters array to follow plugin parameters
     AudioParameter dummyParameter;
@@ -117,6 +143,12 @@ protected:
     // the real transport
     Transport* transport;
 
+    // saves the session in background
+    SessionAutosaver* autosaver;
+
+    // processing resumes once the session plugins are loaded
+    bool resumeWhenLoaded;
+
 #if JUCE_LASH
     // if we choose to use lash we will have this set
     LashManager* lashManager;
@@ -42,7 +42,9 @@ HostFilterComponent::HostFilterComponent (HostFilterBase* const ownerFilter_)
       main (0),
       browser (0),
       verticalDividerBar (0),
-      horizontalDividerBar (0)
+      horizontalDividerBar (0),
+      loadProgressBar (0),
+      loadProgress (0.0)
 {
     DBG ("HostFilterComponent::HostFilterComponent");
 
@@ -70,6 +72,8 @@ HostFilterComponent::HostFilterComponent (HostFilterBase* const ownerFilter_)
     addAndMakeVisible (browser = new BrowserTabbedComponent (this));
     addAndMakeVisible (navigator = new ViewportNavigator (0));
 
+    addChildComponent (loadProgressBar = new ProgressBar (loadProgress));
+
     addAndMakeVisible (resizer = new ResizableCornerComponent (this, &resizeLimits));
     resizeLimits.setSizeLimits (150, 150, 1280, 1024);
 
@@ -103,6 +107,13 @@ HostFilterComponent::HostFilterComponent (HostFilterBase* const ownerFilter_)
 
     // register as listener to transport
     getFilter()->getTransport()->addChangeListener (this);
+
+    // show the progress of the session being loaded, it could have started already
+    Host* host = getHost ();
+    host->addListener (this);
+    sessionLoadProgress (host,
+                         host->getPluginsToLoadCount () - host->getLoadingPluginsCount (),
+                         host->getPluginsToLoadCount ());
 }
 
 //==============================================================================
@@ -112,6 +123,7 @@ HostFilterComponent::~HostFilterComponent()
 
     // register as listener to transport
     getFilter()->getTransport()->removeChangeListener (this);
+    getHost()->removeListener (this);
 
     // deregister ouselves from the plugin (in this case the host)
     getFilter()->removeChangeListener (this);
@@ -133,6 +145,7 @@ HostFilterComponent::~HostFilterComponent()
     deleteAndZero (horizontalDividerBar);
     deleteAndZero (tooltipWindow);
     deleteAndZero (resizer);
+    deleteAndZero (loadProgressBar);
 
     // clear command manager commands... save keymappings before this point !
     CommandManager* commandManager = CommandManager::getInstance();
@@ -203,6 +216,25 @@ void HostFilterComponent::resized()
     }
     
     resizer->setBounds (getWidth() - 16, getHeight() - 16, 16, 16);
+
+    loadProgressBar->setBounds (getWidth() / 4, getHeight() - 40, getWidth() / 2, 20);
+}
+
+//==============================================================================
+void HostFilterComponent::sessionLoadProgress (Host* host, const int numLoaded, const int numPlugins)
+{
+    if (numPlugins > 0 && numLoaded < numPlugins)
+    {
+        loadProgress = numLoaded / (double) numPlugins;
+        loadProgressBar->setTextToDisplay (T("Loading plugins ") + String (numLoaded)
+                                           + T(" of ") + String (numPlugins));
+        loadProgressBar->setVisible (true);
+        loadProgressBar->toFront (false);
+    }
+    else
+    {
+        loadProgressBar->setVisible (false);
+    }
 }
 
 //==============================================================================
@@ -422,7 +454,8 @@ void HostFilterComponent::changeListenerCallback (void* source)
         for (int j = 0; j < host->getPluginsCount(); j++)
         {
             BasePlugin* plugin = host->getPluginByIndex (j);
-            if (plugin && plugin->getIntValue (PROP_WINDOWOPEN, 0))
+            if (plugin && plugin->getIntValue (PROP_WINDOWOPEN, 0)
+                && plugin->getType () != JOST_PLUGINTYPE_PLACEHOLDER)
                 openPluginEditorWindow (plugin);
         }
 
@@ -492,6 +525,7 @@ const PopupMenu HostFilterComponent::getMenuForIndex (int menuIndex,
             menu.addCommandItem (commandManager, CommandIDs::sessionNew);
             menu.addCommandItem (commandManager, CommandIDs::sessionLoad);
             menu.addCommandItem (commandManager, CommandIDs::sessionSave);
+            menu.addCommandItem (commandManager, CommandIDs::sessionExportXml);
             menu.addSubMenu (T("Recent sessions"), recentSessionsSubMenu);
             menu.addSeparator();
             menu.addCommandItem (commandManager, CommandIDs::pluginOpen);
@@ -513,6 +547,26 @@ const PopupMenu HostFilterComponent::getMenuForIndex (int menuIndex,
             menu.addCommandItem (commandManager, CommandIDs::audioRecord);
             menu.addCommandItem (commandManager, CommandIDs::audioStop);
             menu.addCommandItem (commandManager, CommandIDs::audioRewind);
+            menu.addSeparator ();
+            menu.addCommandItem (commandManager, CommandIDs::audioMetronome);
+            menu.addCommandItem (commandManager, CommandIDs::audioPreRoll);
+            menu.addSeparator ();
+
+            SceneManager* sceneManager = getFilter()->getHost ()->getSceneManager ();
+            PopupMenu storeScenesSubMenu, recallScenesSubMenu;
+            for (int i = 0; i < JOST_MENU_SCENES; i++)
+            {
+                const String sceneName = T("Scene ") + String (i + 1);
+                storeScenesSubMenu.addItem (CommandIDs::storeScenes + i, sceneName);
+                recallScenesSubMenu.addItem (CommandIDs::recallScenes + i, sceneName,
+                                             sceneManager->hasScene (i),
+                                             sceneManager->getCurrentScene () == i);
+            }
+            menu.addSubMenu (T("Store scene"), storeScenesSubMenu);
+            menu.addSubMenu (T("Recall scene"), recallScenesSubMenu);
+            menu.addSeparator ();
+            menu.addCommandItem (commandManager, CommandIDs::audioMidiClock);
+            menu.addCommandItem (commandManager, CommandIDs::audioMidiTimecode);
             break;
         }
     case 2: // CommandCategories::about
@@ -551,19 +605,33 @@ void HostFilterComponent::menuItemSelected (int menuItemID,
             fileID = menuItemID - CommandIDs::recentSessions;
             if (fileID >= 0 && fileID < config->recentSessions.getNumFiles())
             {
-                MemoryBlock fileData;
                 File fileToLoad = config->recentSessions.getFile (fileID);
 
                 if (fileToLoad.existsAsFile()
-                    && fileToLoad.loadFileAsData (fileData))
+                    && getFilter ()->loadSessionFromFile (fileToLoad))
                 {
-                    getFilter ()->setStateInformation (fileData.getData (), fileData.getSize());
-
                     Config::getInstance()->addRecentSession (fileToLoad);
                 }
             }
             break;
         }
+    case 1: // CommandCategories::audio
+        {
+            SceneManager* sceneManager = getFilter()->getHost ()->getSceneManager ();
+
+            // handle scenes store and recall
+            int sceneID = menuItemID - CommandIDs::storeScenes;
+            if (sceneID >= 0 && sceneID < JOST_MENU_SCENES)
+            {
+                sceneManager->storeScene (sceneID);
+                break;
+            }
+
+            sceneID = menuItemID - CommandIDs::recallScenes;
+            if (sceneID >= 0 && sceneID < JOST_MENU_SCENES)
+                sceneManager->recallScene (sceneID);
+            break;
+        }
     }
 
     toFront (true);
@@ -593,10 +661,15 @@ void HostFilterComponent::getAllCommands (Array <CommandID>& commands)
                                 CommandIDs::audioRecord,
                                 CommandIDs::audioRewind,
                                 CommandIDs::audioLoop,
+                                CommandIDs::audioMidiClock,
+                                CommandIDs::audioMidiTimecode,
+                                CommandIDs::audioMetronome,
+                                CommandIDs::audioPreRoll,
 
                                 CommandIDs::sessionNew,
                                 CommandIDs::sessionLoad,
                                 CommandIDs::sessionSave,
+                                CommandIDs::sessionExportXml,
 
                                 CommandIDs::appToolbar,
                                 CommandIDs::appBrowser,
@@ -692,6 +765,35 @@ void HostFilterComponent::getCommandInfo (const CommandID commandID, Application
         result.setTicked (transport->isLooping());
         result.setActive (true);
         break;
+        }
+    case CommandIDs::audioMidiClock:
+        {
+        result.setInfo (T("Send MIDI clock"), T("Send MIDI clock and song position"), CommandCategories::audio, 0);
+        result.setTicked (transport->isMidiClockMaster());
+        result.setActive (true);
+        break;
+        }
+    case CommandIDs::audioMidiTimecode:
+        {
+        result.setInfo (T("Send MIDI timecode"), T("Send MIDI timecode quarter frames"), CommandCategories::audio, 0);
+        result.setTicked (transport->isMidiTimecodeMaster());
+        result.setActive (true);
+        break;
+        }
+    case CommandIDs::audioMetronome:
+        {
+        result.setInfo (T("Metronome"), T("Click on every beat while playing"), CommandCategories::audio, 0);
+        result.addDefaultKeypress (T('m'), cmd);
+        result.setTicked (transport->isMetronomeEnabled());
+        result.setActive (true);
+        break;
+        }
+    case CommandIDs::audioPreRoll:
+        {
+        result.setInfo (T("Pre-roll"), T("Play one bar before punching in when recording"), CommandCategories::audio, 0);
+        result.setTicked (transport->getPreRollBars() > 0);
+        result.setActive (! transport->isPlaying());
+        break;
         }
     //----------------------------------------------------------------------------------------------
     case CommandIDs::sessionNew:
@@ -713,6 +815,12 @@ void HostFilterComponent::getCommandInfo (const CommandID commandID, Application
         result.setActive ((graph ? (graph->getPluginsCount () > 0) : false));
         break;
         }
+    case CommandIDs::sessionExportXml:
+        {
+        result.setInfo (T("Export session as XML..."), T("Save a session as an xml document"), CommandCategories::file, 0);
+        result.setActive ((graph ? (graph->getPluginsCount () > 0) : false));
+        break;
+        }
     //----------------------------------------------------------------------------------------------
     case CommandIDs::appToolbar:
         result.setInfo (T("Edit toolbar"), T("Edit toolbar items"), CommandCategories::about, 0);
@@ -805,11 +913,31 @@ bool HostFilterComponent::perform (const InvocationInfo& info)
             transport->setLooping (! transport->isLooping());
             break;
         }
+    case CommandIDs::audioMidiClock:
+        {
+            transport->setMidiClockMaster (! transport->isMidiClockMaster());
+            break;
+        }
+    case CommandIDs::audioMidiTimecode:
+        {
+            transport->setMidiTimecodeMaster (! transport->isMidiTimecodeMaster());
+            break;
+        }
+    case CommandIDs::audioMetronome:
+        {
+            transport->setMetronome (! transport->isMetronomeEnabled());
+            break;
+        }
+    case CommandIDs::audioPreRoll:
+        {
+            transport->setPreRollBars (transport->getPreRollBars() > 0 ? 0 : 1);
+            break;
+        }
 
     //----------------------------------------------------------------------------------------------
     case CommandIDs::sessionNew:
         {
-            getFilter()->getHost ()->closeAllPlugins (true);
+            getFilter()->getHost ()->closeAllPlugins (true, true);
 
             clearComponents ();
             rebuildComponents ();
@@ -824,14 +952,11 @@ bool HostFilterComponent::perform (const InvocationInfo& info)
 
             if (myChooser.browseForFileToOpen())
             {
-                MemoryBlock fileData;
                 File fileToLoad = myChooser.getResult();
 
                 if (fileToLoad.existsAsFile()
-                    && fileToLoad.loadFileAsData (fileData))
+                    && getFilter ()->loadSessionFromFile (fileToLoad))
                 {
-                    getFilter ()->setStateInformation (fileData.getData (), fileData.getSize());
-
                     Config::getInstance()->addRecentSession (fileToLoad);
                 }
             }
@@ -845,18 +970,29 @@ bool HostFilterComponent::perform (const InvocationInfo& info)
 
             if (myChooser.browseForFileToSave (true))
             {
-                MemoryBlock fileData;
-                getFilter ()->getStateInformation (fileData);
-
                 File fileToSave = myChooser.getResult().withFileExtension (JOST_SESSION_EXTENSION);
 
-                if (fileToSave.replaceWithData (fileData.getData (), fileData.getSize()))
+                if (getFilter ()->saveSessionToFile (fileToSave))
                 {
                     Config::getInstance()->addRecentSession (fileToSave);
                 }
             }
             break;
         }
+    case CommandIDs::sessionExportXml:
+        {
+            FileChooser myChooser (T("Export a session as XML..."),
+                                    Config::getInstance ()->lastSessionDirectory,
+                                    T("*.xml"));
+
+            if (myChooser.browseForFileToSave (true))
+            {
+                File fileToSave = myChooser.getResult().withFileExtension (T(".xml"));
+
+                getFilter ()->saveSessionToFile (fileToSave, true);
+            }
+            break;
+        }
 
     //----------------------------------------------------------------------------------------------
     case CommandIDs::appToolbar:
@@ -46,6 +46,7 @@
 class HostFilterComponent  : public AudioProcessorEditor,
                              public AudioParameterListener,
                              public ChangeListener,
+                             public HostListener,
                              public DragAndDropContainer,
                              public ApplicationCommandTarget,
                              public MenuBarModel
@@ -107,6 +108,13 @@ public:
     /** Parameter listener callback */
     void parameterChanged (AudioParameter* parameter, const int index);
 
+    //==============================================================================
+    /** Host listener callbacks, we show how far a session is loaded */
+    void processingGraphChanged (Host* host, ProcessingGraph* audioGraph) {}
+    void pluginAdded (Host* host, BasePlugin* plugin) {}
+    void pluginRemoved (Host* host, BasePlugin* plugin) {}
+    void sessionLoadProgress (Host* host, const int numLoaded, const int numPlugins);
+
     //==============================================================================
     /** Returns the names of the current menu bar */
     const StringArray getMenuBarNames ();
@@ -170,6 +178,10 @@ private:
     StretchableLayoutManager verticalLayout;
     StretchableLayoutManager horizontalLayout;
 
+    // session plugins loading
+    ProgressBar* loadProgressBar;
+    double loadProgress;
+
     // resizable corner when plugin
     ResizableCornerComponent* resizer;
     ComponentBoundsConstrainer resizeLimits;
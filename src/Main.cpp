@@ -30,6 +30,7 @@
 
 #include "HostFilterBase.h"
 #include "HostFilterComponent.h"
+#include "model/PluginScanner.h"
 
 #include "formats/Standalone/juce_AudioFilterStreamer.cpp"
 #include "formats/Standalone/juce_StandaloneFilterWindow.cpp"
@@ -139,7 +140,34 @@ private:
 };
 
 //==============================================================================
+#if JUCE_LINUX
+
+int main (int argc, char* argv[])
+{
+    // we have been started by the plugin scanner to probe some libraries
+    if (argc > 2 && strcmp (argv [1], JOST_PLUGIN_SCAN_ARGUMENT) == 0)
+    {
+        const int resultDescriptor = atoi (argv [2]);
+
+        StringArray filePaths;
+        for (int i = 3; i < argc; i++)
+            filePaths.add (String (argv [i]));
+
+        initialiseJuce_GUI ();
+        const int result = PluginScanner::runScanWorker (resultDescriptor, filePaths);
+        shutdownJuce_GUI ();
+
+        return result;
+    }
+
+    return JUCEApplication::main (argc, argv, new HostApplication());
+}
+
+#else
+
 START_JUCE_APPLICATION (HostApplication)
+
+#endif
 
 #else
 
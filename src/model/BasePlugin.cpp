@@ -27,6 +27,8 @@
 */
 
 #include "BasePlugin.h"
+#include "SessionFile.h"
+#include "../HostFilterBase.h"
 
 //==============================================================================
 int32 BasePlugin::globalUniqueCounter = 1;
@@ -39,7 +41,10 @@ BasePlugin::BasePlugin ()
       mutedOutput (false),
       bypassOutput (false),
       outputGain (1.0f),
-      currentOutputGain (1.0f)
+      currentOutputGain (1.0f),
+      capturingState (false),
+      doubleInputBuffer (0),
+      doubleOutputBuffer (0)
 {
     keyboardState.reset();
 
@@ -53,6 +58,43 @@ BasePlugin::BasePlugin ()
 
 BasePlugin::~BasePlugin ()
 {
+    freeDoubleBuffers ();
+}
+
+//==============================================================================
+void BasePlugin::allocateDoubleBuffers (const int numInputs,
+                                        const int numOutputs,
+                                        const int numSamples)
+{
+    freeDoubleBuffers ();
+
+    doubleInputBuffer = new DoubleSampleBuffer (numInputs, numSamples);
+    doubleOutputBuffer = new DoubleSampleBuffer (numOutputs, numSamples);
+}
+
+void BasePlugin::freeDoubleBuffers ()
+{
+    deleteAndZero (doubleInputBuffer);
+    deleteAndZero (doubleOutputBuffer);
+}
+
+void BasePlugin::convertDoubleInputs (const int numSamples)
+{
+    if (inputBuffer && doubleInputBuffer)
+        doubleInputBuffer->writeTo (*inputBuffer, numSamples);
+}
+
+void BasePlugin::processBlockDouble (AudioSampleBuffer& buffer,
+                                     MidiBuffer& midiMessages)
+{
+    const int numSamples = buffer.getNumSamples ();
+
+    convertDoubleInputs (numSamples);
+
+    processBlock (buffer, midiMessages);
+
+    if (outputBuffer && doubleOutputBuffer)
+        doubleOutputBuffer->readFrom (*outputBuffer, numSamples);
 }
 
 //==============================================================================
@@ -105,17 +147,24 @@ void BasePlugin::loadPropertiesFromXml (XmlElement* xml)
 }
 
 //==============================================================================
-void BasePlugin::savePresetToXml (XmlElement* xml)
+void BasePlugin::savePresetToXml (XmlElement* xml, const bool deferData)
 {
     xml->setAttribute (T("gain"), outputGain);
     xml->setAttribute (T("mute"), mutedOutput);
     xml->setAttribute (T("bypass"), bypassOutput);
 
-    MemoryBlock mb;
-    getStateInformation (mb);
-
     XmlElement* chunk = new XmlElement (T("data"));
-    chunk->addTextElement (mb.toBase64Encoding ());
+    if (deferData)
+    {
+        chunk->addTextElement (getDeferredStateMarker ());
+    }
+    else
+    {
+        MemoryBlock mb;
+        captureState (mb);
+
+        chunk->addTextElement (mb.toBase64Encoding ());
+    }
     xml->addChildElement (chunk);
 
     XmlElement* params = new XmlElement (T("parameters"));
@@ -123,7 +172,9 @@ void BasePlugin::savePresetToXml (XmlElement* xml)
     xml->addChildElement (params);
 }    
 
-void BasePlugin::loadPresetFromXml (XmlElement* xml)
+void BasePlugin::loadPresetFromXml (XmlElement* xml,
+                                    SessionChunks* chunks,
+                                    const bool onlyChangedState)
 {
     // default vst values
     outputGain =  xml->getDoubleAttribute (T("gain"), 1.0);
@@ -134,9 +185,18 @@ void BasePlugin::loadPresetFromXml (XmlElement* xml)
     XmlElement* chunk = xml->getChildByName (T("data"));
     if (chunk)
     {
+        const void* data = 0;
+        int size = 0;
         MemoryBlock mb;
-        mb.fromBase64Encoding (chunk->getAllSubText ());
-        setStateInformation (mb.getData(), mb.getSize ());
+
+        // autosaves leave the state empty when it was never known
+        if (readPresetData (chunk, chunks, data, size, mb)
+            && size > 0
+            && ! (onlyChangedState && hasSameState (data, size)))
+        {
+            setStateInformation (data, size);
+            rememberState (data, size);
+        }
     }
 
     XmlElement* params = xml->getChildByName (T("parameters"));
@@ -145,4 +205,116 @@ void BasePlugin::loadPresetFromXml (XmlElement* xml)
         readParametersFromXmlElement (params, false);
     }
 }
+
+bool BasePlugin::readPresetData (XmlElement* chunk,
+                                 SessionChunks* chunks,
+                                 const void*& data,
+                                 int& size,
+                                 MemoryBlock& storage)
+{
+    if (chunk->hasAttribute (T("chunk")))
+    {
+        return chunks != 0
+               && chunks->getChunk (chunk->getIntAttribute (T("chunk"), -1), data, size, storage);
+    }
+
+    storage.fromBase64Encoding (chunk->getAllSubText ());
+
+    data = storage.getData ();
+    size = storage.getSize ();
+    return true;
+}
+
+bool BasePlugin::hasSameState (const void* data, const int size)
+{
+    MemoryBlock mb;
+    captureState (mb);
+
+    return mb.getSize () == size
+           && memcmp (mb.getData (), data, size) == 0;
+}
 
+//==============================================================================
+void BasePlugin::captureState (MemoryBlock& destData)
+{
+    if (canCaptureStateWhileProcessing () || parentHost == 0)
+    {
+        getStateInformation (destData);
+        return;
+    }
+
+    {
+        // once we hold the lock no block is running, and the next ones will skip us
+        const ScopedLock sl (parentHost->getCallbackLock ());
+        capturingState = true;
+    }
+
+    try
+    {
+        getStateInformation (destData);
+    }
+    catch (...)
+    {
+        capturingState = false;
+        throw;
+    }
+
+    capturingState = false;
+
+    rememberState (destData.getData (), destData.getSize ());
+}
+
+bool BasePlugin::getLastKnownState (MemoryBlock& destData)
+{
+    const ScopedLock sl (lastKnownStateLock);
+
+    if (lastKnownState.getSize () == 0)
+        return false;
+
+    destData = lastKnownState;
+    return true;
+}
+
+void BasePlugin::rememberState (const void* data, const int size)
+{
+    // plugins captured while processing don't need it, save the memory
+    if (canCaptureStateWhileProcessing ())
+        return;
+
+    const ScopedLock sl (lastKnownStateLock);
+    lastKnownState = MemoryBlock (data, size);
+}
+
+bool BasePlugin::writeStateToStream (OutputStream& out)
+{
+    MemoryBlock mb;
+    captureState (mb);
+
+    const String header (String (mb.getSize ()) + T("."));
+    if (! out.write ((const char*) header, header.length ()))
+        return false;
+
+    // whole groups of 3 bytes encode to the same characters on their own, so
+    // the block can be encoded piece by piece instead of all in one string
+    const int pieceSize = 3 * 16384;
+
+    for (int start = 0; start < mb.getSize (); start += pieceSize)
+    {
+        const MemoryBlock piece ((const char*) mb.getData () + start,
+                                 jmin (pieceSize, mb.getSize () - start));
+
+        const String encoded (piece.toBase64Encoding ()
+                                .fromFirstOccurrenceOf (T("."), false, false));
+
+        if (! out.write ((const char*) encoded, encoded.length ()))
+            return false;
+    }
+
+    return true;
+}
+
+const String BasePlugin::getDeferredStateMarker () const
+{
+    return String (T("jost-deferred-state-")) + String (uniqueHash) + T("-");
+}
+
@@ -30,6 +30,7 @@
 #define __JUCETICE_JOSTBASEPLUGIN_HEADER__
 
 #include "../Config.h"
+#include "DoubleSampleBuffer.h"
 
 //==============================================================================
 /**
@@ -65,6 +66,7 @@
 class BasePlugin;
 class PluginEditorComponent;
 class HostFilterBase;
+class SessionChunks;
 
 //==============================================================================
 /**
@@ -111,6 +113,14 @@ public:
     virtual void openEditor (void* handle, void* display) {}
     virtual void idleEditor () {}
     virtual void closeEditor () {}
+
+    //==============================================================================
+    /** Apply the parameter changes queued from outside the audio thread
+
+        This is called by the host on the audio thread at the start of the
+        plugin slot, even when the plugin is bypassed.
+    */
+    virtual void processParameterChanges () {}
 
 public:
 
@@ -120,6 +130,9 @@ public:
     /** Returns the unique hash representing this plugin */
     int32 getUniqueHash () const                       { return uniqueHash; }
 
+    /** @internal */
+    void setUniqueHash (const int32 newHash)           { uniqueHash = newHash; }
+
     //==============================================================================
     void setParentHost (HostFilterBase* owner)         { parentHost = owner; }
 
@@ -133,11 +146,54 @@ public:
     virtual void loadPropertiesFromXml (XmlElement* element);
 
     //==============================================================================
-    /** Serialize track to an Xml element */
-    virtual void savePresetToXml (XmlElement* element);
+    /** Serialize track to an Xml element
+
+        If deferData is true, the state data is not captured: the data element
+        will hold the text returned by getDeferredStateMarker instead, to be
+        replaced later with what writeStateToStream outputs.
+    */
+    virtual void savePresetToXml (XmlElement* element, const bool deferData = false);
+
+    /** Deserialize track from an Xml element
+
+        Data elements of binary sessions refer to one of the chunks, which is
+        handed to setStateInformation straight from the session file.
+
+        With onlyChangedState, the state is not set again if the plugin has
+        the same one already.
+    */
+    virtual void loadPresetFromXml (XmlElement* element,
+                                    SessionChunks* chunks = 0,
+                                    const bool onlyChangedState = false);
+
+    //==============================================================================
+    /** Capture the plugin state from outside the audio thread
+
+        Unless the plugin can be asked for its state while processing, it will
+        be left out of the host processing until the state is taken.
+    */
+    void captureState (MemoryBlock& destData);
+
+    /** Get the state the plugin had when it was last captured or loaded
+
+        Only kept for plugins that can't capture their state while processing,
+        so it can be saved without leaving them out of processing. Returns
+        false if the state was never captured nor loaded.
+    */
+    bool getLastKnownState (MemoryBlock& destData);
+
+    /** Capture the plugin state and write it as the text of a preset data
+        element, without encoding it all in memory first */
+    bool writeStateToStream (OutputStream& out);
+
+    /** Returns the text standing for the state in a deferred preset */
+    const String getDeferredStateMarker () const;
+
+    /** Returns true if getStateInformation can run while the plugin processes */
+    virtual bool canCaptureStateWhileProcessing () const  { return true; }
 
-    /** Deserialize track from an Xml element */
-    virtual void loadPresetFromXml (XmlElement* element);
+    /** Returns true if the host should leave the plugin out of processing */
+    bool isCapturingState () const                     { return capturingState; }
 
     //==============================================================================
     /** Get the desired output gain */
@@ -180,11 +236,54 @@ public:
     /** Set the desired mute state */
     void setBypass (const bool bypass)                 { bypassOutput = bypass; }
 
+    //==============================================================================
+    /** Allocate the double precision buffers used when the host runs in double */
+    void allocateDoubleBuffers (const int numInputs,
+                                const int numOutputs,
+                                const int numSamples);
+
+    /** Free the double precision buffers */
+    void freeDoubleBuffers ();
+
+    /** Get the double precision buffers, or 0 if the host runs in float */
+    DoubleSampleBuffer* getDoubleInputBuffers () const   { return doubleInputBuffer; }
+    DoubleSampleBuffer* getDoubleOutputBuffers () const  { return doubleOutputBuffer; }
+
+    /** Convert the double input buffers into the float ones */
+    void convertDoubleInputs (const int numSamples);
+
+    /** Process a block from the double buffers to the double buffers
+
+        By default this converts the inputs to float, calls processBlock and
+        converts the outputs back. Plugins that can process doubles natively
+        should override this.
+    */
+    virtual void processBlockDouble (AudioSampleBuffer& buffer,
+                                     MidiBuffer& midiMessages);
+
 protected:
 
     //==============================================================================
     BasePlugin ();
 
+    //==============================================================================
+    /** Get the state held by a preset data element
+
+        The state comes from its chunk in binary sessions, or is decoded in
+        storage otherwise: data will point there, so keep it meanwhile.
+    */
+    static bool readPresetData (XmlElement* element,
+                                SessionChunks* chunks,
+                                const void*& data,
+                                int& size,
+                                MemoryBlock& storage);
+
+    /** Returns true if the current plugin state is the same as this one */
+    bool hasSameState (const void* data, const int size);
+
+    /** Keep the state as the last known one, if the plugin needs it */
+    void rememberState (const void* data, const int size);
+
     //==============================================================================
     static int32 globalUniqueCounter;
     int32 uniqueHash;
@@ -199,6 +298,16 @@ protected:
     //==============================================================================
     float outputGain, currentOutputGain;
     float outputPan, currentOutputPan;
+
+    //==============================================================================
+    volatile bool capturingState;
+
+    CriticalSection lastKnownStateLock;
+    MemoryBlock lastKnownState;
+
+    //==============================================================================
+    DoubleSampleBuffer* doubleInputBuffer;
+    DoubleSampleBuffer* doubleOutputBuffer;
 };
 
 
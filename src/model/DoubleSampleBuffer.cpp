@@ -0,0 +1,210 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#include "DoubleSampleBuffer.h"
+
+#if defined (__SSE2__)
+ #include <emmintrin.h>
+#endif
+
+
+//==============================================================================
+DoubleSampleBuffer::DoubleSampleBuffer (const int numChannels_,
+                                        const int numSamples_)
+  : numChannels (jmax (0, numChannels_)),
+    numSamples (jmax (0, numSamples_)),
+    data (0),
+    channels (0)
+{
+    data = new double [jmax (1, numChannels * numSamples)];
+    channels = new double* [jmax (1, numChannels)];
+
+    for (int i = 0; i < numChannels; i++)
+        channels [i] = data + i * numSamples;
+
+    clear ();
+}
+
+DoubleSampleBuffer::~DoubleSampleBuffer ()
+{
+    delete[] channels;
+    delete[] data;
+}
+
+//==============================================================================
+void DoubleSampleBuffer::clear ()
+{
+    for (int i = 0; i < numChannels; i++)
+        zeromem (channels [i], sizeof (double) * numSamples);
+}
+
+void DoubleSampleBuffer::copyFrom (const int destChannel,
+                                   const DoubleSampleBuffer& source,
+                                   const int sourceChannel,
+                                   const int num)
+{
+    jassert (destChannel >= 0 && destChannel < numChannels);
+    jassert (sourceChannel >= 0 && sourceChannel < source.numChannels);
+    jassert (num <= numSamples && num <= source.numSamples);
+
+    memcpy (channels [destChannel], source.channels [sourceChannel], sizeof (double) * num);
+}
+
+void DoubleSampleBuffer::addFrom (const int destChannel,
+                                  const double* source,
+                                  const int num)
+{
+    jassert (destChannel >= 0 && destChannel < numChannels);
+    jassert (num <= numSamples);
+
+    double* dest = channels [destChannel];
+
+    for (int i = 0; i < num; i++)
+        dest [i] += source [i];
+}
+
+void DoubleSampleBuffer::applyGainRamp (const int channel,
+                                        const int num,
+                                        double startGain,
+                                        const double endGain)
+{
+    jassert (channel >= 0 && channel < numChannels);
+    jassert (num <= numSamples);
+
+    double* d = channels [channel];
+
+    if (startGain == endGain)
+    {
+        if (endGain == 1.0)
+            return;
+
+        for (int i = 0; i < num; i++)
+            d [i] *= endGain;
+    }
+    else if (num > 0)
+    {
+        const double increment = (endGain - startGain) / num;
+
+        for (int i = 0; i < num; i++)
+        {
+            d [i] *= startGain;
+            startGain += increment;
+        }
+    }
+}
+
+//==============================================================================
+double DoubleSampleBuffer::getMagnitude (const int num) const
+{
+    jassert (num <= numSamples);
+
+    double magnitude = 0.0;
+
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        const double* d = channels [channel];
+
+        for (int i = 0; i < num; i++)
+            magnitude = jmax (magnitude, fabs (d [i]));
+    }
+
+    return magnitude;
+}
+
+double DoubleSampleBuffer::getRMSLevel (const int channel, const int num) const
+{
+    jassert (channel >= 0 && channel < numChannels);
+    jassert (num <= numSamples);
+
+    if (num <= 0)
+        return 0.0;
+
+    const double* d = channels [channel];
+    double sum = 0.0;
+
+    for (int i = 0; i < num; i++)
+        sum += d [i] * d [i];
+
+    return sqrt (sum / num);
+}
+
+//==============================================================================
+void DoubleSampleBuffer::readFrom (const AudioSampleBuffer& source, const int num)
+{
+    jassert (num <= numSamples);
+
+    const int numToCopy = jmin (numChannels, source.getNumChannels ());
+
+    for (int i = 0; i < numToCopy; i++)
+        floatToDouble (channels [i], source.getSampleData (i), num);
+}
+
+void DoubleSampleBuffer::writeTo (AudioSampleBuffer& dest, const int num) const
+{
+    jassert (num <= numSamples);
+
+    const int numToCopy = jmin (numChannels, dest.getNumChannels ());
+
+    for (int i = 0; i < numToCopy; i++)
+        doubleToFloat (dest.getSampleData (i), channels [i], num);
+}
+
+//==============================================================================
+void DoubleSampleBuffer::floatToDouble (double* dest, const float* source, const int num)
+{
+    int i = 0;
+
+#if defined (__SSE2__)
+    for (; i + 4 <= num; i += 4)
+    {
+        const __m128 f = _mm_loadu_ps (source + i);
+        _mm_storeu_pd (dest + i, _mm_cvtps_pd (f));
+        _mm_storeu_pd (dest + i + 2, _mm_cvtps_pd (_mm_movehl_ps (f, f)));
+    }
+#endif
+
+    for (; i < num; i++)
+        dest [i] = (double) source [i];
+}
+
+void DoubleSampleBuffer::doubleToFloat (float* dest, const double* source, const int num)
+{
+    int i = 0;
+
+#if defined (__SSE2__)
+    for (; i + 4 <= num; i += 4)
+    {
+        const __m128 lo = _mm_cvtpd_ps (_mm_loadu_pd (source + i));
+        const __m128 hi = _mm_cvtpd_ps (_mm_loadu_pd (source + i + 2));
+        _mm_storeu_ps (dest + i, _mm_movelh_ps (lo, hi));
+    }
+#endif
+
+    for (; i < num; i++)
+        dest [i] = (float) source [i];
+}
@@ -0,0 +1,116 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#ifndef __JUCETICE_JOSTDOUBLESAMPLEBUFFER_HEADER__
+#define __JUCETICE_JOSTDOUBLESAMPLEBUFFER_HEADER__
+
+#include "../Config.h"
+
+
+//==============================================================================
+/**
+    A multichannel buffer of double precision samples.
+
+    When the host runs in double precision, every plugin gets a pair of these
+    alongside its float buffers: the graph sums and applies gains on them,
+    and only plugins that can't process doubles get their audio converted to
+    float and back around their processBlock.
+
+    @see BasePlugin::processBlockDouble
+*/
+class DoubleSampleBuffer
+{
+public:
+
+    //==============================================================================
+    /** Creates a cleared buffer */
+    DoubleSampleBuffer (const int numChannels,
+                        const int numSamples);
+
+    /** Destructor */
+    ~DoubleSampleBuffer ();
+
+    //==============================================================================
+    int getNumChannels () const                        { return numChannels; }
+    int getNumSamples () const                         { return numSamples; }
+
+    double* getSampleData (const int channel) const    { return channels [channel]; }
+    double** getArrayOfChannels () const               { return channels; }
+
+    //==============================================================================
+    /** Clears all the samples in all channels */
+    void clear ();
+
+    /** Copies a channel from another buffer */
+    void copyFrom (const int destChannel,
+                   const DoubleSampleBuffer& source,
+                   const int sourceChannel,
+                   const int numSamples);
+
+    /** Adds samples to a channel */
+    void addFrom (const int destChannel,
+                  const double* source,
+                  const int numSamples);
+
+    /** Applies a gain going linearly from startGain to endGain */
+    void applyGainRamp (const int channel,
+                        const int numSamples,
+                        double startGain,
+                        const double endGain);
+
+    //==============================================================================
+    /** Returns the highest absolute sample value in all channels */
+    double getMagnitude (const int numSamples) const;
+
+    /** Returns the root mean squared level of a channel */
+    double getRMSLevel (const int channel, const int numSamples) const;
+
+    //==============================================================================
+    /** Converts a float buffer into this one, channel by channel */
+    void readFrom (const AudioSampleBuffer& source, const int numSamples);
+
+    /** Converts this buffer into a float one, channel by channel */
+    void writeTo (AudioSampleBuffer& dest, const int numSamples) const;
+
+    //==============================================================================
+    static void floatToDouble (double* dest, const float* source, const int numSamples);
+    static void doubleToFloat (float* dest, const double* source, const int numSamples);
+
+private:
+
+    int numChannels;
+    int numSamples;
+    double* data;
+    double** channels;
+
+    DoubleSampleBuffer (const DoubleSampleBuffer&);
+    const DoubleSampleBuffer& operator= (const DoubleSampleBuffer&);
+};
+
+
+#endif // __JUCETICE_JOSTDOUBLESAMPLEBUFFER_HEADER__
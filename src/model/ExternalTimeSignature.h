@@ -0,0 +1,56 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#ifndef __JUCETICE_JOSTEXTERNALTIMESIGNATURE_HEADER__
+#define __JUCETICE_JOSTEXTERNALTIMESIGNATURE_HEADER__
+
+
+//==============================================================================
+/**
+    An external transport that can also be told our time signature.
+
+    ExternalTransport only knows about tempo, so external transports able to
+    publish a time signature (like the JACK one when we are the timebase
+    master) implement this as well, and the transport finds it out with a
+    dynamic_cast.
+
+    @see Transport
+*/
+class ExternalTimeSignature
+{
+public:
+
+    /** Destructor */
+    virtual ~ExternalTimeSignature () {}
+
+    /** Set main time signature, used when we are the timebase master */
+    virtual void setTimeSignature (const int numerator, const int denominator) = 0;
+};
+
+
+#endif // __JUCETICE_JOSTEXTERNALTIMESIGNATURE_HEADER__
@@ -27,25 +27,130 @@
 */
 
 #include "Host.h"
+#include "PluginModule.h"
 #include "../HostFilterBase.h"
 
 
+//==============================================================================
+/**
+    A plugin of a session being loaded, standing as a placeholder meanwhile.
+*/
+class PendingPlugin
+{
+public:
+
+    PendingPlugin (XmlElement* element_)
+      : element (new XmlElement (*element_)),
+        file (File::nonexistent),
+        uniqueID (0),
+        placeholderHash (0),
+        plugin (0),
+        loaded (false)
+    {
+    }
+
+    ~PendingPlugin ()
+    {
+        delete element;
+    }
+
+    XmlElement* element;
+    SessionChunksPtr chunks;
+    File file;
+    int uniqueID;
+    int placeholderHash;
+    BasePlugin* plugin;
+    bool loaded;
+};
+
+//==============================================================================
+/**
+    Loads the plugins of a session coming from the same library.
+
+    Not every library is safe to instantiate from more threads at once, so
+    its instances are created and restored one after the other here, while
+    other libraries are loaded by the other threads of the pool.
+
+    VST plugins never come here, as most of them expect the gui thread: the
+    host loads them one by one from its timer, or while waiting for the jobs.
+*/
+class PluginLoadJob : public ThreadPoolJob
+{
+public:
+
+    PluginLoadJob (Host* host_, const File& file_)
+      : ThreadPoolJob (file_.getFileName ()),
+        host (host_),
+        file (file_)
+    {
+    }
+
+    //==============================================================================
+    const File& getFile () const                       { return file; }
+
+    void addPlugin (PendingPlugin* pending)            { plugins.add (pending); }
+
+    //==============================================================================
+    JobStatus runJob ()
+    {
+        for (int i = 0; i < plugins.size () && ! shouldExit (); i++)
+        {
+            PendingPlugin* pending = plugins.getUnchecked (i);
+
+            // pooled instances are there already
+            BasePlugin* plugin = pending->plugin;
+            if (plugin == 0)
+                plugin = PluginLoader::getFromFile (pending->file, pending->uniqueID);
+
+            if (plugin != 0)
+                host->restorePlugin (plugin, pending->element, pending->chunks);
+
+            host->pluginLoaded (pending, plugin);
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+
+    Host* host;
+    File file;
+    Array<PendingPlugin*> plugins;
+};
+
+
 //==============================================================================
 Host::Host (HostFilterBase* owner_,
             const int maxNumInputChannels,
             const int maxNumOutputChannels)
   : owner (owner_),
     currentPlugin (0),
+    loadThreads (0),
+    numPluginsLoaded (0),
+    numPluginsToLoad (0),
+    numPluginsReported (-1),
+    waitingForPlugins (false),
     audioGraph (0),
+    sceneManager (0),
     sampleRate (44100.0),
-    samplesPerBlock (512)
+    samplesPerBlock (512),
+    doublePrecision (false)
 {
     DBG ("Host::Host");
+
+    // loads the session plugins
+    loadThreads = new ThreadPool (jlimit (1, JOST_SESSION_LOAD_THREADS, SystemStats::getNumCpus ()));
 
     transport = owner->getTransport ();
 
     // create an empty audio processing graph
     audioGraph = new ProcessingGraph ();
+
+    // create the scenes holder
+    sceneManager = new SceneManager (owner, this);
+
+    // libraries are unloaded out of the audio callback
+    PluginModuleManager::getInstance ()->setCallbackLock (& owner->getCallbackLock ());
 
     // add generic plugins
     addPlugin (inputPlugin = new InputPlugin (maxNumInputChannels));
@@ -59,6 +164,14 @@ Host::~Host()
     // free plugins
     closeAllPlugins (false);
     plugins.clear (true);
+    clearPluginPool ();
+
+    deleteAndZero (loadThreads);
+
+    PluginModuleManager::getInstance ()->setCallbackLock (0);
+
+    // free scenes
+    deleteAndZero (sceneManager);
 
     // remove listeners after
     removeAllListeners ();
@@ -93,12 +206,12 @@ void Host::addPlugin (BasePlugin* plugin)
 }
 
 //==============================================================================
-BasePlugin* Host::loadPlugin (const File& pluginFile)
+BasePlugin* Host::loadPlugin (const File& pluginFile, const int uniqueID)
 {
     DBG ("Host::loadPlugin");
 
     // vst hosting a new plugin
-    BasePlugin* plugin = PluginLoader::getFromFile (pluginFile);
+    BasePlugin* plugin = PluginLoader::getFromFile (pluginFile, uniqueID);
 
     if (plugin)
     {
@@ -125,6 +238,8 @@ void Host::changePluginAudioGraph (ProcessingGraph* newAudioGraph)
     {
         const ScopedLock sl (owner->getCallbackLock());
         audioGraph = newAudioGraph;
+
+        prepareSynthGroups ();
     }
 
     if (oldAudioGraph)
@@ -145,22 +260,7 @@ void Host::openPlugin (BasePlugin* plugin, const bool suspendAudio)
         if (suspendAudio)
              owner->suspendProcessing (true);
 
-        // make it a child, and allocate buffers
-        plugin->setParentHost (owner);
-
-        plugin->allocateBuffers (plugin->getNumInputs(),
-                                 plugin->getNumOutputs(),
-                                 plugin->getNumMidiInputs(),
-                                 plugin->getNumMidiOutputs(),
-                                 samplesPerBlock);
-
-        plugin->setPlayConfigDetails (plugin->getNumInputs(),
-                                      plugin->getNumOutputs(),
-                                      sampleRate,
-                                      samplesPerBlock);
-
-        // try to open correctly the plugin
-        plugin->prepareToPlay (sampleRate, samplesPerBlock);
+        preparePlugin (plugin);
 
         if (suspendAudio)
              owner->suspendProcessing (false);
@@ -171,6 +271,28 @@ void Host::openPlugin (BasePlugin* plugin, const bool suspendAudio)
     }
 }
 
+void Host::preparePlugin (BasePlugin* plugin)
+{
+    // make it a child, and allocate buffers
+    plugin->setParentHost (owner);
+
+    plugin->allocateBuffers (plugin->getNumInputs(),
+                             plugin->getNumOutputs(),
+                             plugin->getNumMidiInputs(),
+                             plugin->getNumMidiOutputs(),
+                             samplesPerBlock);
+
+    allocateDoubleBuffers (plugin);
+
+    plugin->setPlayConfigDetails (plugin->getNumInputs(),
+                                  plugin->getNumOutputs(),
+                                  sampleRate,
+                                  samplesPerBlock);
+
+    // try to open correctly the plugin
+    plugin->prepareToPlay (sampleRate, samplesPerBlock);
+}
+
 //==============================================================================
 void Host::closePlugin (BasePlugin* plugin, const bool suspendAudio)
 {
@@ -181,48 +303,117 @@ void Host::closePlugin (BasePlugin* plugin, const bool suspendAudio)
         if (suspendAudio)
              owner->suspendProcessing (true);
 
-        if (audioGraph)
-            audioGraph->resetNodeData (plugin);
-
-        // release resources and close plugin
-        plugin->releaseResources ();
-        plugins.removeObject (plugin, false);
+        releasePlugin (plugin);
 
         if (suspendAudio)
              owner->suspendProcessing (false);
-
-        // notify listeners
-        for (int i = 0; i < listeners.size (); i++)
-            ((HostListener*) listeners.getUnchecked (i))->pluginRemoved (this, plugin);
 
         delete plugin;
     }
 }
 
+void Host::releasePlugin (BasePlugin* plugin)
+{
+    if (audioGraph)
+    {
+        const ScopedLock sl (owner->getCallbackLock());
+
+        audioGraph->resetNodeData (plugin);
+
+        prepareSynthGroups ();
+    }
+
+    // release resources and remove plugin
+    plugin->releaseResources ();
+    plugins.removeObject (plugin, false);
+
+    // notify listeners
+    for (int i = 0; i < listeners.size (); i++)
+        ((HostListener*) listeners.getUnchecked (i))->pluginRemoved (this, plugin);
+}
+
 //==============================================================================
-void Host::closeAllPlugins (const bool suspendAudio)
+void Host::closeAllPlugins (const bool suspendAudio, const bool keepInstances)
 {
     DBG ("Host::closeAllPlugins");
+
+    closeOtherPlugins (Array<BasePlugin*> (), suspendAudio, keepInstances);
+}
+
+void Host::closeOtherPlugins (const Array<BasePlugin*>& keptPlugins,
+                              const bool suspendAudio,
+                              const bool keepInstances)
+{
+    const int poolSize = keepInstances ? jmax (0, Config::getInstance ()->pluginPoolSize) : 0;
 
+    // the plugins still loading won't be needed
+    cancelPendingPlugins ();
+
     if (suspendAudio)
         owner->suspendProcessing (true);
 
+    // scenes refers to the plugins we are closing
+    sceneManager->clearScenes ();
+
     // remove and close all plugins except i/o
     for (int i = plugins.size (); --i >= 0;)
     {
         BasePlugin* plugin = plugins.getUnchecked (i);
 
         if (plugin->getType() != JOST_PLUGINTYPE_INPUT
-            && plugin->getType() != JOST_PLUGINTYPE_OUTPUT)
+            && plugin->getType() != JOST_PLUGINTYPE_OUTPUT
+            && ! keptPlugins.contains (plugin))
         {
-           closePlugin (plugin, false);
+            if (poolSize > 0
+                && plugin->getType () != JOST_PLUGINTYPE_PLACEHOLDER
+                && plugin->getFile ().existsAsFile ())
+            {
+                // deactivated, but ready for the next session
+                releasePlugin (plugin);
+                pluginPool.add (plugin);
+            }
+            else
+            {
+                closePlugin (plugin, false);
+            }
         }
     }
 
+    // keep only the most recently closed ones
+    if (keepInstances)
+    {
+        while (pluginPool.size () > poolSize)
+            pluginPool.remove (0, true);
+    }
+
     if (suspendAudio)
         owner->suspendProcessing (false);
 }
 
+void Host::clearPluginPool ()
+{
+    DBG ("Host::clearPluginPool");
+
+    pluginPool.clear (true);
+}
+
+BasePlugin* Host::takePooledPlugin (const File& pluginFile, const int uniqueID)
+{
+    for (int i = pluginPool.size (); --i >= 0;)
+    {
+        BasePlugin* plugin = pluginPool.getUnchecked (i);
+
+        if (plugin->getFile () == pluginFile
+            && (uniqueID == 0 || plugin->getID () == uniqueID))
+        {
+            pluginPool.remove (i, false);
+            return plugin;
+        }
+    }
+
+    return 0;
+}
+
 //==============================================================================
 void Host::prepareToPlay (double sampleRate_, int samplesPerBlock_)
 {
@@ -230,6 +421,7 @@ void Host::prepareToPlay (double sampleRate_, int samplesPerBlock_)
 
     sampleRate = sampleRate_;
     samplesPerBlock = samplesPerBlock_;
+    doublePrecision = Config::getInstance ()->doublePrecision;
 
     transport->prepareToPlay (sampleRate, samplesPerBlock);
 
@@ -243,6 +435,8 @@ void Host::prepareToPlay (double sampleRate_, int samplesPerBlock_)
                                      plugin->getNumMidiInputs(),
                                      plugin->getNumMidiOutputs(),
                                      samplesPerBlock);
+
+            allocateDoubleBuffers (plugin);
 
             plugin->setPlayConfigDetails (plugin->getNumInputs(),
                                           plugin->getNumOutputs(),
@@ -264,6 +458,16 @@ void Host::releaseResources()
     transport->releaseResources ();
 }
 
+void Host::allocateDoubleBuffers (BasePlugin* plugin)
+{
+    if (doublePrecision)
+        plugin->allocateDoubleBuffers (plugin->getNumInputs(),
+                                       plugin->getNumOutputs(),
+                                       samplesPerBlock);
+    else
+        plugin->freeDoubleBuffers ();
+}
+
 //==============================================================================
 void Host::processBlock (AudioSampleBuffer& buffer,
                          MidiBuffer& midiMessages)
@@ -275,11 +479,22 @@ void Host::processBlock (AudioSampleBuffer& buffer,
     transport->processIncomingMidi (midiMessages);
     transport->processAudioPlayHead (owner->getPlayHead());
 
+    // switch scenes at block boundary
+    sceneManager->processIncomingMidi (midiMessages);
+    sceneManager->processBlock (sampleRate, blockSamples);
+
     // process midi for plugins
     for (int j = plugins.size (); --j >= 0;)
         plugins.getUnchecked (j)->clearMidiBuffers ();
 
-    
+    // render midi clock and timecode for this block into the input sync port
+    transport->processMidiClock (blockSamples);
+
+    const MidiBuffer& midiClockBuffer = transport->getMidiClockBuffer ();
+    if (midiClockBuffer.getNumEvents () > 0)
+        inputPlugin->getMidiBuffer (inputPlugin->getMidiClockPort ())
+                        ->addEvents (midiClockBuffer, 0, blockSamples, 0);
+
     // process audio for plugins
     if (audioGraph)
     {
@@ -290,20 +505,60 @@ void Host::processBlock (AudioSampleBuffer& buffer,
             
             if (! currentPlugin)
                 continue;
+
+            // being snapshotted from another thread, leave it out of this block
+            if (currentPlugin->isCapturingState ())
+            {
+#if JUCE_ALSA && JOST_USE_DSSI
+                if (currentPlugin->getType () == JOST_PLUGINTYPE_DSSI)
+                    ((DssiPlugin*) currentPlugin)->clearProcessedInGroup ();
+#endif
+
+                if (currentPlugin->getInputBuffers ())
+                    currentPlugin->getInputBuffers ()->clear ();
+
+                if (currentPlugin->getDoubleInputBuffers ())
+                    currentPlugin->getDoubleInputBuffers ()->clear ();
+
+                continue;
+            }
             
             currentPluginType = currentPlugin->getType ();
+
+            // apply gui and automation changes before anything runs
+            currentPlugin->processParameterChanges ();
 
             // handle logic of mapping i/o --
             AudioSampleBuffer* inBuffers = currentPlugin->getInputBuffers ();
             AudioSampleBuffer* outBuffers = currentPlugin->getOutputBuffers ();
+            DoubleSampleBuffer* inDoubles = currentPlugin->getDoubleInputBuffers ();
+            DoubleSampleBuffer* outDoubles = currentPlugin->getDoubleOutputBuffers ();
 
             // process audio --
             if (currentPlugin->isBypass ()
                 && ! (currentPluginType == JOST_PLUGINTYPE_INPUT
                       || currentPluginType == JOST_PLUGINTYPE_OUTPUT))
             {
+#if JUCE_ALSA && JOST_USE_DSSI
+                if (currentPluginType == JOST_PLUGINTYPE_DSSI)
+                    ((DssiPlugin*) currentPlugin)->clearProcessedInGroup ();
+#endif
+
                 // bypass mode
-                if (inBuffers && outBuffers && inBuffers->getNumChannels() > 0)
+                if (doublePrecision)
+                {
+                    if (inDoubles && outDoubles && inDoubles->getNumChannels() > 0)
+                    {
+                        for (int channel = 0; channel < outDoubles->getNumChannels(); ++channel)
+                        {
+                            outDoubles->copyFrom (channel,
+                                                  *inDoubles,
+                                                  jmin (channel, inDoubles->getNumChannels() - 1),
+                                                  blockSamples);
+                        }
+                    }
+                }
+                else if (inBuffers && outBuffers && inBuffers->getNumChannels() > 0)
                 {
                     for (int channel = 0; channel < outBuffers->getNumChannels(); ++channel)
                     {
@@ -318,7 +573,16 @@ void Host::processBlock (AudioSampleBuffer& buffer,
             }
             else
             {
-                currentPlugin->processBlock (buffer, midiMessages);
+#if JUCE_ALSA && JOST_USE_DSSI
+                // run instances of the same dssi synth in a single call
+                if (currentPluginType == JOST_PLUGINTYPE_DSSI)
+                    processSynthGroup (j, blockSamples);
+#endif
+
+                if (doublePrecision)
+                    currentPlugin->processBlockDouble (buffer, midiMessages);
+                else
+                    currentPlugin->processBlock (buffer, midiMessages);
 
                 if (currentPluginType == JOST_PLUGINTYPE_OUTPUT)
                 {
@@ -327,7 +591,44 @@ void Host::processBlock (AudioSampleBuffer& buffer,
                 }
             }
 
-            if (outBuffers)
+            if (outBuffers && doublePrecision)
+            {
+                if (outDoubles)
+                {
+                    const double currentOutputGain = currentPlugin->getCurrentOutputGain ();
+                    const double desiredOutputGain = currentPlugin->isMuted() ? 0.0
+                                                                              : currentPlugin->getOutputGain ();
+
+                    // apply mixer gains and sum into the destinations, all in double --
+                    for (int i = currentPlugin->getNumOutputs (); --i >= 0;)
+                    {
+                        outDoubles->applyGainRamp (i,
+                                                   blockSamples,
+                                                   currentOutputGain,
+                                                   desiredOutputGain);
+                    }
+
+                    currentPlugin->setCurrentOutputGain ((float) desiredOutputGain);
+
+                    for (int i = node->getLinksCount (JOST_LINKTYPE_AUDIO); --i >= 0;)
+                    {
+                        ProcessingLink* link = node->getLink (JOST_LINKTYPE_AUDIO, i);
+                        BasePlugin* destination = (BasePlugin*) link->destination->getData ();
+
+                        if (destination)
+                        {
+                            DoubleSampleBuffer* destBuffer = destination->getDoubleInputBuffers();
+                            if (destBuffer)
+                            {
+                                destBuffer->addFrom (link->destinationPort,
+                                                     outDoubles->getSampleData (link->sourcePort),
+                                                     blockSamples);
+                            }
+                        }
+                    }
+                }
+            }
+            else if (outBuffers)
             {
                 const float currentOutputGain = currentPlugin->getCurrentOutputGain ();
                 const float desiredOutputGain = currentPlugin->isMuted() ? 0.0f
@@ -366,7 +667,9 @@ void Host::processBlock (AudioSampleBuffer& buffer,
             }
 
             // clear input buffers (avoid zipper noise, but can be optimized) --
-            if (inBuffers)
+            if (inDoubles)
+                inDoubles->clear ();
+            else if (inBuffers)
                 inBuffers->clear ();
 
             // copy over midi processing --    
@@ -394,6 +697,126 @@ void Host::processBlock (AudioSampleBuffer& buffer,
     transport->processBlock (blockSamples);
 }
 
+void Host::prepareSynthGroups ()
+{
+#if JUCE_ALSA && JOST_USE_DSSI
+    if (! audioGraph)
+        return;
+
+    const int numNodes = audioGraph->getNodeCount ();
+
+    // groups only depend on the graph, bypass and captures are left to the
+    // block: an instance out of it just runs on its own
+    for (int j = 0; j < numNodes; j++)
+    {
+        BasePlugin* plugin = (BasePlugin*) audioGraph->getNode (j)->getData ();
+
+        if (plugin != 0 && plugin->getType () == JOST_PLUGINTYPE_DSSI)
+            ((DssiPlugin*) plugin)->setGroupLeader (0);
+    }
+
+    for (int j = 0; j < numNodes; j++)
+    {
+        BasePlugin* plugin = (BasePlugin*) audioGraph->getNode (j)->getData ();
+
+        if (plugin == 0 || plugin->getType () != JOST_PLUGINTYPE_DSSI)
+            continue;
+
+        DssiPlugin* leader = (DssiPlugin*) plugin;
+        if (leader->getGroupLeader () != 0 || ! leader->runsMultipleSynths ())
+            continue;
+
+        // the whole group runs where the leader is, so every other instance
+        // must not be fed by anything processed between the leader and it
+        int numInstances = 1;
+        bool canGroup = true;
+
+        for (int k = j + 1; k < numNodes && canGroup; k++)
+        {
+            ProcessingNode* node = audioGraph->getNode (k);
+            BasePlugin* other = (BasePlugin*) node->getData ();
+
+            if (other == 0
+                || other->getType () != JOST_PLUGINTYPE_DSSI
+                || other->getLowLevelHandle () != leader->getLowLevelHandle ())
+                continue;
+
+            for (int s = j; s < k && canGroup; s++)
+            {
+                ProcessingNode* source = audioGraph->getNode (s);
+
+                for (int type = JOST_LINKTYPE_AUDIO; type <= JOST_LINKTYPE_MIDI && canGroup; type++)
+                    for (int i = source->getLinksCount (type); --i >= 0;)
+                        if (source->getLink (type, i)->destination == node)
+                            canGroup = false;
+            }
+
+            if (++numInstances > JOST_DSSI_MAX_SYNTHS)
+                canGroup = false;
+        }
+
+        // otherwise every instance runs on its own
+        if (! canGroup)
+            continue;
+
+        leader->setGroupLeader (leader);
+
+        for (int k = j + 1; k < numNodes; k++)
+        {
+            BasePlugin* other = (BasePlugin*) audioGraph->getNode (k)->getData ();
+
+            if (other != 0
+                && other->getType () == JOST_PLUGINTYPE_DSSI
+                && other->getLowLevelHandle () == leader->getLowLevelHandle ())
+                ((DssiPlugin*) other)->setGroupLeader (leader);
+        }
+    }
+#endif
+}
+
+void Host::processSynthGroup (const int nodeIndex, const int blockSamples)
+{
+#if JUCE_ALSA && JOST_USE_DSSI
+    DssiPlugin* leader = (DssiPlugin*) audioGraph->getNode (nodeIndex)->getData ();
+
+    if (leader->getGroupLeader () != leader || leader->isProcessedInGroup ())
+        return;
+
+    DssiPlugin* group [JOST_DSSI_MAX_SYNTHS];
+    int numInstances = 0;
+
+    group [numInstances++] = leader;
+
+    for (int j = nodeIndex + 1;
+         j < audioGraph->getNodeCount () && numInstances < JOST_DSSI_MAX_SYNTHS;
+         j++)
+    {
+        BasePlugin* plugin = (BasePlugin*) audioGraph->getNode (j)->getData ();
+
+        if (plugin != 0
+            && plugin->getType () == JOST_PLUGINTYPE_DSSI
+            && ! plugin->isBypass ()
+            && ! plugin->isCapturingState ()
+            && ((DssiPlugin*) plugin)->getGroupLeader () == leader)
+        {
+            DssiPlugin* follower = (DssiPlugin*) plugin;
+
+            // the leader got its changes already, the others need them before running
+            follower->processParameterChanges ();
+
+            group [numInstances++] = follower;
+        }
+    }
+
+    // the group runs before each member converts its own inputs
+    if (doublePrecision)
+        for (int i = 0; i < numInstances; i++)
+            group [i]->convertDoubleInputs (blockSamples);
+
+    DssiPlugin::processSynthGroup (group, numInstances, blockSamples);
+#endif
+}
+
 //==============================================================================
 void Host::suspendProcessing (const bool suspend)
 {
@@ -419,7 +842,7 @@ void Host::removeAllListeners ()
 }
 
 //==============================================================================
-void Host::saveToXml (XmlElement* xml)
+void Host::saveToXml (XmlElement* xml, const bool deferPluginStates)
 {
     xml->setAttribute (T("version"), JucePlugin_VersionCode);
 
@@ -428,6 +851,11 @@ void Host::saveToXml (XmlElement* xml)
     transport->saveToXml (trans);
     xml->addChildElement (trans);
 
+    // save scenes
+    XmlElement* scenes = new XmlElement (T("scenes"));
+    sceneManager->saveToXml (scenes);
+    xml->addChildElement (scenes);
+
     // save plugins and connections
     for (int i = 0; i < plugins.size (); i++)
     {
@@ -435,7 +863,11 @@ void Host::saveToXml (XmlElement* xml)
 
         XmlElement* e = new XmlElement (T("plugin"));
         e->setAttribute (T("hash"), plugin->getUniqueHash());
-        e->setAttribute (T("type"), plugin->getType());
+        // placeholders are saved as the plugins they stand for
+        if (plugin->getType() == JOST_PLUGINTYPE_PLACEHOLDER)
+            e->setAttribute (T("type"), ((PlaceholderPlugin*) plugin)->getPluginType());
+        else
+            e->setAttribute (T("type"), plugin->getType());
         e->setAttribute (T("uniqueid"), plugin->getID());
         e->setAttribute (T("path"), plugin->getFile().getFullPathName());
         e->setAttribute (T("preset"), plugin->getCurrentProgram());
@@ -447,7 +879,7 @@ void Host::saveToXml (XmlElement* xml)
 
         // current internal parameter state
         XmlElement* chunk = new XmlElement (T("state"));
-        plugin->savePresetToXml (chunk);
+        plugin->savePresetToXml (chunk, deferPluginStates);
         e->addChildElement (chunk);
 
         // add to main
@@ -515,15 +947,86 @@ void Host::saveGraphToXml (XmlElement* xml)
 }
 
 //==============================================================================
-void Host::loadFromXml (XmlElement* xml)
+void Host::restorePlugin (BasePlugin* plugin, XmlElement* e, SessionChunks* chunks)
+{
+    // extended options
+    XmlElement* ext = e->getChildByName (T("options"));
+    if (ext) plugin->loadPropertiesFromXml (ext);
+
+    // open it, without telling anyone yet
+    preparePlugin (plugin);
+
+    // XXX - is this needed here ?
+    if (plugin->getNumPrograms() > 0)
+        plugin->setCurrentProgram (e->getIntAttribute (T("preset"), 0));
+
+    // current preset
+    XmlElement* state = e->getChildByName (T("state"));
+    if (state) plugin->loadPresetFromXml (state, chunks);
+}
+
+void Host::updatePlugin (BasePlugin* plugin, XmlElement* e, SessionChunks* chunks)
+{
+    // extended options
+    XmlElement* ext = e->getChildByName (T("options"));
+    if (ext) plugin->loadPropertiesFromXml (ext);
+
+    // changing program would throw away the current state
+    const int program = e->getIntAttribute (T("preset"), 0);
+    if (plugin->getNumPrograms() > 0 && plugin->getCurrentProgram () != program)
+        plugin->setCurrentProgram (program);
+
+    // current preset, only if it is not the one playing
+    XmlElement* state = e->getChildByName (T("state"));
+    if (state) plugin->loadPresetFromXml (state, chunks, true);
+}
+
+BasePlugin* Host::findRunningPlugin (XmlElement* e) const
+{
+    BasePlugin* plugin = getPluginByUniqueHash (e->getIntAttribute (T("hash"), -1));
+
+    // hashes are unique only while jost runs, check it is really the same
+    if (plugin == 0
+        || plugin->getType () == JOST_PLUGINTYPE_PLACEHOLDER
+        || plugin->getType () != e->getIntAttribute (T("type"), 0)
+        || plugin->getID () != e->getIntAttribute (T("uniqueid"), 0)
+        || plugin->getFile ().getFullPathName () != e->getStringAttribute (T("path"), String::empty))
+    {
+        return 0;
+    }
+
+    return plugin;
+}
+
+//==============================================================================
+void Host::loadFromXml (XmlElement* xml, SessionChunks* chunks)
 {
     int version = xml->getIntAttribute (T("version"), -1);
     if (version < JucePlugin_VersionCode)
         printf ("Session made with a previous version of jost. "
                 "Something may be broken... sorry for that! \n");
 
-    // remove already added plugins
-    closeAllPlugins (false);
+    // plugins found again in the session keep running
+    Array<BasePlugin*> keptPlugins, sessionPlugins;
+
+    forEachXmlChildElementWithTagName (*xml, e, T("plugin"))
+    {
+        BasePlugin* plugin = findRunningPlugin (e);
+        if (plugin != 0 && keptPlugins.contains (plugin))
+            plugin = 0;
+
+        if (plugin != 0)
+            keptPlugins.add (plugin);
+
+        sessionPlugins.add (plugin);
+    }
+
+    // remove the others, keeping them warm if we can
+    closeOtherPlugins (keptPlugins, false, true);
+
+    // they will be added back in the session order
+    for (int i = 0; i < keptPlugins.size (); i++)
+        plugins.removeObject (keptPlugins.getUnchecked (i), false);
 
     if (plugins.contains (inputPlugin));
         plugins.removeObject (inputPlugin, false);
@@ -532,12 +1035,13 @@ void Host::loadFromXml (XmlElement* xml)
         plugins.removeObject (outputPlugin, false);
 
     // load transport
-    XmlElement* trans = xml->getChildByName (T("options"));
+    XmlElement* trans = xml->getChildByName (T("transport"));
     if (trans) transport->loadFromXml (trans);
 
     // start adding stuff
     Array<int> oldHash, newHash;
     ProcessingGraph* newAudioGraph = new ProcessingGraph ();
+    int sessionIndex = 0;
 
     forEachXmlChildElement (*xml, e)
     {
@@ -550,36 +1054,80 @@ void Host::loadFromXml (XmlElement* xml)
             String pluginPath = e->getStringAttribute (T("path"), String::empty);
             int pluginPreset = e->getIntAttribute (T("preset"), 0);
 
-            // handle input plugin (hash is fixed between sessions)
-            bool isExternalSharedLibrary = false;
-            BasePlugin* plugin = PluginLoader::getFromTypeID (pluginUniqueType,
-                                                              inputPlugin,
-                                                              outputPlugin);
-            if (plugin == 0)
+            // still running, restore only what changed
+            BasePlugin* plugin = sessionPlugins [sessionIndex++];
+            if (plugin)
+            {
+                updatePlugin (plugin, e, chunks);
+            }
+            else
+            {
+                // handle input plugin (hash is fixed between sessions)
+                plugin = PluginLoader::getFromTypeID (pluginUniqueType,
+                                                      inputPlugin,
+                                                      outputPlugin);
+                if (plugin)
+                    restorePlugin (plugin, e, chunks);
+            }
+
+            if (plugin == 0)
             {
-                plugin = PluginLoader::getFromFile (pluginPath == String::empty ? File::nonexistent
-                                                                                : pluginPath);
-                isExternalSharedLibrary = true;
+                const File pluginFile (pluginPath == String::empty ? File::nonexistent
+                                                                   : File (pluginPath));
+
+                // a placeholder stands for it until it is loaded
+                PluginCacheEntry sessionEntry;
+                sessionEntry.filePath = pluginFile.getFullPathName ();
+                sessionEntry.type = pluginUniqueType;
+                sessionEntry.uniqueID = pluginUniqueID;
+                sessionEntry.name = pluginFile.getFileNameWithoutExtension ();
+                getSessionPorts (xml, pluginHash, sessionEntry);
+
+                plugin = PluginLoader::getPlaceholderFromFile (sessionEntry, pluginPreset);
+                if (plugin)
+                {
+                    PendingPlugin* pending = new PendingPlugin (e);
+                    pending->chunks = chunks;
+                    pending->file = pluginFile;
+                    pending->uniqueID = pluginUniqueID;
+                    pending->placeholderHash = plugin->getUniqueHash ();
+
+                    // an instance from a previous session only needs its state
+                    pending->plugin = takePooledPlugin (pluginFile, pluginUniqueID);
+
+                    pendingPlugins.add (pending);
+
+                    if (((PlaceholderPlugin*) plugin)->getPluginType () == JOST_PLUGINTYPE_VST)
+                    {
+                        // vst plugins expect to be created and restored from the gui thread
+                        messageThreadPlugins.add (pending);
+                    }
+                    else
+                    {
+                        PluginLoadJob* job = 0;
+                        for (int i = 0; i < loadJobs.size () && job == 0; i++)
+                        {
+                            if (loadJobs.getUnchecked (i)->getFile () == pluginFile)
+                                job = loadJobs.getUnchecked (i);
+                        }
+
+                        if (job == 0)
+                            loadJobs.add (job = new PluginLoadJob (this, pluginFile));
+
+                        job->addPlugin (pending);
+                    }
+
+                    restorePlugin (plugin, e, chunks);
+                }
             }
 
-            if (plugin
-                && ((isExternalSharedLibrary && plugin->getID() == pluginUniqueID) || true))
+            if (plugin)
             {
-                // extended options
-                XmlElement* ext = e->getChildByName (T("options"));
-                if (ext) plugin->loadPropertiesFromXml (ext);
+                // notify listeners
+                for (int i = 0; i < listeners.size (); i++)
+                    ((HostListener*) listeners.getUnchecked (i))->pluginAdded (this, plugin);
 
-                // add plugin (do not suspend processing)
-                openPlugin (plugin, false);
                 addPlugin (plugin);
-
-                // XXX - is this needed here ?
-                if (plugin->getNumPrograms() > 0)
-                    plugin->setCurrentProgram (pluginPreset);
-
-                // current preset
-                XmlElement* state = e->getChildByName (T("state"));
-                if (state) plugin->loadPresetFromXml (state);
 
                 // add to the graph
                 newAudioGraph->addNode (plugin);
@@ -587,22 +1135,317 @@ void Host::loadFromXml (XmlElement* xml)
                 oldHash.add (pluginHash);
                 newHash.add (plugin->getUniqueHash());
 
-                printf ("Plugin %s loaded OK \n", (const char*) plugin->getName ());
+                printf ("Plugin %s added OK \n", (const char*) plugin->getName ());
             }
             else
             {
-                printf ("Plugin %s could not be loaded \n", (const char*) pluginPath);
-
-                deleteAndZero (plugin);
+                printf ("Plugin %s could not be loaded \n", (const char*) pluginPath);
             }
         }
     }
+
+    // what the new session didn't take is left for the next one
+    const int poolSize = jmax (0, Config::getInstance ()->pluginPoolSize);
+    while (pluginPool.size () > poolSize)
+        pluginPool.remove (0, true);
+
+    // start loading the real plugins
+    numPluginsToLoad = pendingPlugins.size ();
+    numPluginsLoaded = 0;
+    numPluginsReported = -1;
+
+    for (int i = 0; i < loadJobs.size (); i++)
+        loadThreads->addJob (loadJobs.getUnchecked (i));
 
     // load back graphs !
     loadGraphFromXml (xml, newAudioGraph, oldHash, newHash);
+
+    // load scenes, remapping plugin hashes
+    XmlElement* scenes = xml->getChildByName (T("scenes"));
+    if (scenes) sceneManager->loadFromXml (scenes, oldHash, newHash);
 
     // swap graphs !
     changePluginAudioGraph (newAudioGraph);
+
+    // play with the placeholders, or wait for the real plugins: either way
+    // the timer polls the loading, so the gui keeps running meanwhile
+    if (numPluginsToLoad > 0)
+    {
+        reportLoadProgress ();
+
+        if (Config::getInstance ()->lazyPluginLoading)
+        {
+            startTimer (JOST_SESSION_LOAD_SWAP_INTERVAL);
+        }
+        else
+        {
+            waitingForPlugins = true;
+            startTimer (JOST_SESSION_LOAD_REPORT_INTERVAL);
+        }
+    }
+}
+
+//==============================================================================
+int Host::getLoadingPluginsCount () const
+{
+    const ScopedLock sl (loadLock);
+
+    return numPluginsToLoad - numPluginsLoaded;
+}
+
+void Host::pluginLoaded (PendingPlugin* pending, BasePlugin* plugin)
+{
+    const ScopedLock sl (loadLock);
+
+    pending->plugin = plugin;
+    pending->loaded = true;
+    numPluginsLoaded++;
+}
+
+bool Host::loadMessageThreadPlugin ()
+{
+    // libraries still being scanned would keep us waiting for the scanner
+    PendingPlugin* pending = 0;
+    for (int i = 0; i < messageThreadPlugins.size () && pending == 0; i++)
+    {
+        PendingPlugin* candidate = messageThreadPlugins.getUnchecked (i);
+
+        if (candidate->plugin != 0
+            || PluginScanner::getInstance ()->isUpToDate (candidate->file))
+        {
+            pending = candidate;
+            messageThreadPlugins.remove (i);
+        }
+    }
+
+    if (pending == 0)
+        return false;
+
+    // pooled instances are there already
+    BasePlugin* plugin = pending->plugin;
+    if (plugin == 0)
+        plugin = PluginLoader::getFromFile (pending->file, pending->uniqueID);
+
+    if (plugin != 0)
+        restorePlugin (plugin, pending->element, pending->chunks);
+
+    pluginLoaded (pending, plugin);
+
+    return true;
+}
+
+void Host::reportLoadProgress ()
+{
+    const int numLoaded = numPluginsToLoad - getLoadingPluginsCount ();
+    if (numLoaded == numPluginsReported)
+        return;
+
+    numPluginsReported = numLoaded;
+
+    printf ("Loaded %d of %d plugins \n", numLoaded, numPluginsToLoad);
+
+    for (int i = 0; i < listeners.size (); i++)
+        ((HostListener*) listeners.getUnchecked (i))->sessionLoadProgress (this, numLoaded, numPluginsToLoad);
+}
+
+bool Host::addLoadedPlugins ()
+{
+    DBG ("Host::addLoadedPlugins");
+
+    reportLoadProgress ();
+
+    // take what the load threads have done so far
+    OwnedArray<PendingPlugin> loaded;
+    {
+        const ScopedLock sl (loadLock);
+
+        for (int i = 0; i < pendingPlugins.size ();)
+        {
+            if (pendingPlugins.getUnchecked (i)->loaded)
+            {
+                loaded.add (pendingPlugins.getUnchecked (i));
+                pendingPlugins.remove (i, false);
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+
+    for (int i = 0; i < loaded.size (); i++)
+    {
+        PendingPlugin* pending = loaded.getUnchecked (i);
+        BasePlugin* placeholder = getPluginByUniqueHash (pending->placeholderHash);
+
+        if (pending->plugin == 0)
+        {
+            // the placeholder stays, keeping the session state
+            printf ("Plugin %s could not be loaded \n",
+                    (const char*) pending->file.getFullPathName ());
+        }
+        else if (placeholder == 0
+                 || placeholder->getType () != JOST_PLUGINTYPE_PLACEHOLDER)
+        {
+            // it has been closed while loading
+            pending->plugin->releaseResources ();
+            deleteAndZero (pending->plugin);
+        }
+        else
+        {
+            replacePlaceholder (placeholder, pending->plugin);
+
+            printf ("Plugin %s loaded OK \n", (const char*) pending->plugin->getName ());
+        }
+    }
+
+    // every job is over
+    if (pendingPlugins.size () == 0 && loadThreads->getNumJobs () == 0)
+        loadJobs.clear (true);
+
+    return loaded.size () > 0;
+}
+
+void Host::replacePlaceholder (BasePlugin* placeholder, BasePlugin* plugin)
+{
+    // keep what has been changed while it was loading
+    XmlElement options (T("options"));
+    placeholder->savePropertiesToXml (&options);
+    plugin->loadPropertiesFromXml (&options);
+
+    plugin->setOutputGain (placeholder->getOutputGain ());
+    plugin->setCurrentOutputGain (placeholder->getCurrentOutputGain ());
+    plugin->setOutputPanning (placeholder->getOutputPanning ());
+    plugin->setCurrentOutputPanning (placeholder->getCurrentOutputPanning ());
+    plugin->setMuted (placeholder->isMuted ());
+    plugin->setBypass (placeholder->isBypass ());
+
+    // scenes and wires know it by this hash
+    plugin->setUniqueHash (placeholder->getUniqueHash ());
+
+    // the audio setup could have changed meanwhile
+    if (plugin->getSampleRate () != sampleRate
+        || plugin->getBlockSize () != samplesPerBlock
+        || (plugin->getDoubleOutputBuffers () != 0) != doublePrecision)
+    {
+        preparePlugin (plugin);
+    }
+
+    int numRemovedLinks = 0;
+
+    {
+        const ScopedLock sl (owner->getCallbackLock());
+
+        plugins.set (plugins.indexOf (placeholder), plugin, false);
+
+        ProcessingNode* node = audioGraph ? audioGraph->findNode (placeholder) : 0;
+        if (node)
+        {
+            node->setData (plugin);
+
+            // the session wires can't go past the ports the real plugin has
+            numRemovedLinks = removeInvalidLinks (node);
+
+            prepareSynthGroups ();
+        }
+    }
+
+    if (numRemovedLinks > 0)
+        printf ("Plugin %s has less ports than the session, %d wires removed \n",
+                (const char*) plugin->getName (), numRemovedLinks);
+
+    // notify listeners
+    for (int i = 0; i < listeners.size (); i++)
+    {
+        ((HostListener*) listeners.getUnchecked (i))->pluginRemoved (this, placeholder);
+        ((HostListener*) listeners.getUnchecked (i))->pluginAdded (this, plugin);
+    }
+
+    placeholder->releaseResources ();
+    delete placeholder;
+}
+
+void Host::cancelPendingPlugins ()
+{
+    stopTimer ();
+
+    // wait for the plugins being loaded right now, forget the others
+    loadThreads->removeAllJobs (true, -1);
+    loadJobs.clear (true);
+    messageThreadPlugins.clear ();
+
+    for (int i = 0; i < pendingPlugins.size (); i++)
+    {
+        BasePlugin* plugin = pendingPlugins.getUnchecked (i)->plugin;
+        if (plugin)
+        {
+            plugin->releaseResources ();
+            delete plugin;
+        }
+    }
+
+    pendingPlugins.clear (true);
+
+    const bool wasLoading = numPluginsToLoad > 0;
+
+    numPluginsToLoad = 0;
+    numPluginsLoaded = 0;
+    numPluginsReported = -1;
+
+    if (wasLoading)
+    {
+        for (int i = 0; i < listeners.size (); i++)
+            ((HostListener*) listeners.getUnchecked (i))->sessionLoadProgress (this, 0, 0);
+    }
+
+    // nothing to wait for anymore
+    if (waitingForPlugins)
+    {
+        waitingForPlugins = false;
+        owner->sessionPluginsLoaded ();
+    }
+}
+
+//==============================================================================
+void Host::timerCallback ()
+{
+    if (waitingForPlugins)
+    {
+        // nothing plays meanwhile, load our own ones for a slice of the interval
+        const uint32 startTime = Time::getMillisecondCounter ();
+        while (loadMessageThreadPlugin ()
+               && Time::getMillisecondCounter () - startTime < JOST_SESSION_LOAD_REPORT_INTERVAL)
+        {
+        }
+
+        reportLoadProgress ();
+
+        // the session plays once every plugin is there
+        if (getLoadingPluginsCount () > 0)
+            return;
+
+        waitingForPlugins = false;
+        addLoadedPlugins ();
+
+        if (pendingPlugins.size () == 0)
+            stopTimer ();
+
+        owner->sessionPluginsLoaded ();
+        owner->sendChangeMessage (owner);
+        return;
+    }
+
+    // one at a time, so the gui stays responsive
+    loadMessageThreadPlugin ();
+
+    const bool pluginsChanged = addLoadedPlugins ();
+
+    if (pendingPlugins.size () == 0)
+        stopTimer ();
+
+    // let the gui show the real plugins
+    if (pluginsChanged)
+        owner->sendChangeMessage (owner);
 }
 
 //==============================================================================
@@ -632,7 +1475,8 @@ void Host::loadGraphFromXml (XmlElement* xml,
 
                         BasePlugin* dstPlugin =
                             getPluginByUniqueHash (newHash [oldHash.indexOf (destPluginHash)]);
-                        if (dstPlugin != 0 && srcPort >= 0 && dstPort >= 0)
+                        // the plugin could have less ports than when saved
+                        if (isValidLink (srcPlugin, srcPort, dstPlugin, dstPort, JOST_LINKTYPE_AUDIO))
                         {
                             newAudioGraph->connectTo (srcPlugin,
                                                       srcPort,
@@ -668,7 +1512,8 @@ void Host::loadGraphFromXml (XmlElement* xml,
 
                         BasePlugin* dstPlugin =
                             getPluginByUniqueHash (newHash [oldHash.indexOf (destPluginHash)]);
-                        if (dstPlugin != 0 && srcPort >= 0 && dstPort >= 0)
+                        // the plugin could have less ports than when saved
+                        if (isValidLink (srcPlugin, srcPort, dstPlugin, dstPort, JOST_LINKTYPE_MIDI))
                         {
                             newAudioGraph->connectTo (srcPlugin,
                                                       srcPort,
@@ -684,3 +1529,83 @@ void Host::loadGraphFromXml (XmlElement* xml,
     // end
 }
 
+void Host::getSessionPorts (XmlElement* xml, const int pluginHash, PluginCacheEntry& entry)
+{
+    // the wires tell at least how many ports the plugin had
+    entry.numInputs = entry.numOutputs = 0;
+    entry.numMidiInputs = entry.numMidiOutputs = 0;
+
+    for (int type = JOST_LINKTYPE_AUDIO; type <= JOST_LINKTYPE_MIDI; type++)
+    {
+        XmlElement* links = xml->getChildByName (type == JOST_LINKTYPE_AUDIO ? T("audio") : T("midi"));
+        if (links == 0)
+            continue;
+
+        int& numInputs = (type == JOST_LINKTYPE_AUDIO) ? entry.numInputs : entry.numMidiInputs;
+        int& numOutputs = (type == JOST_LINKTYPE_AUDIO) ? entry.numOutputs : entry.numMidiOutputs;
+
+        forEachXmlChildElementWithTagName (*links, e, T("plugin"))
+        {
+            const bool isSource = e->getIntAttribute (T("hash"), -1) == pluginHash;
+
+            forEachXmlChildElementWithTagName (*e, wire, T("wire"))
+            {
+                if (isSource)
+                    numOutputs = jmax (numOutputs, wire->getIntAttribute (T("srcPort"), -1) + 1);
+
+                if (wire->getIntAttribute (T("dstPlugin"), -1) == pluginHash)
+                    numInputs = jmax (numInputs, wire->getIntAttribute (T("dstPort"), -1) + 1);
+            }
+        }
+    }
+}
+
+bool Host::isValidLink (BasePlugin* source,
+                        const int sourcePort,
+                        BasePlugin* destination,
+                        const int destinationPort,
+                        const int type)
+{
+    if (source == 0 || destination == 0 || sourcePort < 0 || destinationPort < 0)
+        return false;
+
+    // midi ports share the same buffers in both directions
+    if (type == JOST_LINKTYPE_MIDI)
+        return sourcePort < jmax (source->getNumMidiInputs (), source->getNumMidiOutputs ())
+               && destinationPort < jmax (destination->getNumMidiInputs (), destination->getNumMidiOutputs ());
+
+    return sourcePort < source->getNumOutputs ()
+           && destinationPort < destination->getNumInputs ();
+}
+
+int Host::removeInvalidLinks (ProcessingNode* node)
+{
+    int numRemoved = 0;
+
+    for (int j = 0; j < audioGraph->getNodeCount (); j++)
+    {
+        ProcessingNode* source = audioGraph->getNode (j);
+
+        for (int type = JOST_LINKTYPE_AUDIO; type <= JOST_LINKTYPE_MIDI; type++)
+        {
+            for (int i = source->getLinksCount (type); --i >= 0;)
+            {
+                ProcessingLink* link = source->getLink (type, i);
+
+                if ((source == node || link->destination == node)
+                    && ! isValidLink ((BasePlugin*) source->getData (),
+                                      link->sourcePort,
+                                      (BasePlugin*) link->destination->getData (),
+                                      link->destinationPort,
+                                      type))
+                {
+                    source->deleteLink (type, i);
+                    numRemoved++;
+                }
+            }
+        }
+    }
+
+    return numRemoved;
+}
+
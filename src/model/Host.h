@@ -34,6 +34,11 @@
 #include "ProcessingGraph.h"
 #include "PluginLoader.h"
 #include "Transport.h"
+#include "SceneManager.h"
+#include "SessionFile.h"
+
+class PendingPlugin;
+class PluginLoadJob;
 
 
 //==============================================================================
@@ -55,6 +60,9 @@ public:
     /** This will be called when a new plugin is removed from the graph */
     virtual  void pluginRemoved (Host* host, BasePlugin* plugin) = 0;
 
+    /** This will be called while a session is loading its plugins */
+    virtual  void sessionLoadProgress (Host* host, const int numLoaded, const int numPlugins) {}
+
 protected:
 
     HostListener () {}
@@ -76,7 +84,7 @@ protected:
     @see Transport
 
 */
-class Host
+class Host : public Timer
 {
 public:
 
@@ -103,6 +111,12 @@ public:
     void processBlock (AudioSampleBuffer& buffer,
                        MidiBuffer& midiMessages);
 
+    /** Returns true if the graph is summed in double precision
+
+        This is taken from the configuration every time the host is prepared.
+    */
+    bool isDoublePrecision () const                      { return doublePrecision; }
+
     //==============================================================================
     void suspendProcessing (const bool shouldBeSuspended);
 
@@ -161,8 +175,21 @@ public:
 
         This will free every plugin currently playing, apart
         from in / out plugins !
+
+        With keepInstances, plugins loaded from a library are kept in the
+        plugin pool instead, up to the configured pool size, so the next
+        session using them won't instantiate them again.
+
+        @see clearPluginPool
     */
-    void closeAllPlugins (const bool suspendAudio = true);
+    void closeAllPlugins (const bool suspendAudio = true,
+                          const bool keepInstances = false);
+
+    /** Free the plugins kept warm by closeAllPlugins */
+    void clearPluginPool ();
+
+    /** Returns how many plugins are kept warm */
+    int getPooledPluginsCount () const                 { return pluginPool.size (); }
 
     //==============================================================================
     /** Try to load a plugin given a string with the absolute path
@@ -171,11 +198,15 @@ public:
         is a valid plugin, it will be opened and the internal buffers
         will be allocated regarding how many inputs/outputs the plugin have.
 
+        Libraries holding more than one plugin will load the one with
+        the unique id specified, or the first one if it is 0: if the
+        library doesn't hold it, nothing is loaded.
+
         Remember that plugin will not be added to the internal array !
 
         @see allocateBuffers
     */
-    BasePlugin* loadPlugin (const File& pluginFile);
+    BasePlugin* loadPlugin (const File& pluginFile, const int uniqueID = 0);
 
     //==============================================================================
     /** This changes the AUDIO processing order of the plugins
@@ -189,6 +220,10 @@ public:
     /** Returns the current audio graph */
     ProcessingGraph* getAudioGraph () const            { return audioGraph; }
 
+    //==============================================================================
+    /** Returns the scenes of this host */
+    SceneManager* getSceneManager () const             { return sceneManager; }
+
     //==============================================================================
     /** Add a listener to this host */
     void addListener (HostListener* listener);
@@ -200,20 +235,95 @@ public:
     void removeAllListeners ();
 
     //==============================================================================
-    /** Serialize host to an Xml element */
-    void saveToXml (XmlElement* element);
+    /** Serialize host to an Xml element
+
+        With deferPluginStates, plugin states are not captured and the document
+        holds their markers instead.
+
+        @see BasePlugin::writeStateToStream
+    */
+    void saveToXml (XmlElement* element, const bool deferPluginStates = false);
+
+    /** Deserialize host from an Xml element
+
+        Plugins coming from libraries are added as placeholders, so the graph
+        can be restored right away, and are instantiated and get their state
+        back in a pool of threads: instances of the same library are loaded
+        one after the other, different libraries at the same time.
+
+        With lazy plugin loading, the session plays while the real plugins
+        take the place of the placeholders as soon as they are ready,
+        otherwise they take it all at once when every one is ready, and
+        the owner is told to resume processing. This never waits for them,
+        the loading is polled from the timer, and listeners are told about
+        the progress.
 
-    /** Deserialize host from an Xml element */
-    void loadFromXml (XmlElement* element);
+        The plugin states of binary sessions are taken from their chunks.
+
+        Plugins of the running session found again in the new one, with the
+        same hash, type, unique id and path, are kept running: only their
+        options and program are restored, and their state is set only if it
+        changed. Reloading a session edited outside jost will only load or
+        close the plugins that differ, and swap the graph once.
+
+        @see PlaceholderPlugin, SessionFile
+    */
+    void loadFromXml (XmlElement* element, SessionChunks* chunks = 0);
+
+    /** Returns how many plugins of the last session are still loading */
+    int getLoadingPluginsCount () const;
+
+    /** Returns how many plugins the last session had to load */
+    int getPluginsToLoadCount () const                 { return numPluginsToLoad; }
+
+    /** Returns true while the session waits for all its plugins to play */
+    bool isWaitingForPlugins () const                  { return waitingForPlugins; }
+
+    //==============================================================================
+    /** @internal */
+    void timerCallback ();
 
 private:
+
+    friend class PluginLoadJob;
 
+    //==============================================================================
+    void prepareSynthGroups ();
+    void processSynthGroup (const int nodeIndex, const int blockSamples);
+    void allocateDoubleBuffers (BasePlugin* plugin);
+
+    //==============================================================================
+    void preparePlugin (BasePlugin* plugin);
+    void restorePlugin (BasePlugin* plugin, XmlElement* element, SessionChunks* chunks);
+    void updatePlugin (BasePlugin* plugin, XmlElement* element, SessionChunks* chunks);
+    BasePlugin* findRunningPlugin (XmlElement* element) const;
+    void closeOtherPlugins (const Array<BasePlugin*>& keptPlugins,
+                            const bool suspendAudio,
+                            const bool keepInstances);
+    void releasePlugin (BasePlugin* plugin);
+    BasePlugin* takePooledPlugin (const File& pluginFile, const int uniqueID);
+
+    //==============================================================================
+    void pluginLoaded (PendingPlugin* pending, BasePlugin* plugin);
+    bool loadMessageThreadPlugin ();
+    bool addLoadedPlugins ();
+    void replacePlaceholder (BasePlugin* placeholder, BasePlugin* plugin);
+    void cancelPendingPlugins ();
+    void reportLoadProgress ();
+
     //==============================================================================
     void saveGraphToXml (XmlElement* element);
     void loadGraphFromXml (XmlElement* element,
                            ProcessingGraph* newAudioGraph,
                            Array<int>& oldHash,
                            Array<int>& newHash);
+    int removeInvalidLinks (ProcessingNode* node);
+    static void getSessionPorts (XmlElement* xml, const int pluginHash, PluginCacheEntry& entry);
+    static bool isValidLink (BasePlugin* source,
+                             const int sourcePort,
+                             BasePlugin* destination,
+                             const int destinationPort,
+                             const int type);
 
     //==============================================================================
     // host holder
@@ -228,12 +338,30 @@ private:
     OwnedArray<BasePlugin> plugins;
     BasePlugin* currentPlugin;
 
+    // closed plugins kept instantiated, oldest first
+    OwnedArray<BasePlugin> pluginPool;
+
+    // session plugins loading in the background
+    ThreadPool* loadThreads;
+    OwnedArray<PluginLoadJob> loadJobs;
+    OwnedArray<PendingPlugin> pendingPlugins;
+    Array<PendingPlugin*> messageThreadPlugins;
+    CriticalSection loadLock;
+    int numPluginsLoaded;
+    int numPluginsToLoad;
+    int numPluginsReported;
+    bool waitingForPlugins;
+
     ProcessingGraph* audioGraph;
 
+    // mixer and parameters snapshots
+    SceneManager* sceneManager;
+
     VoidArray listeners;
 
     double sampleRate;
     int samplesPerBlock;
+    bool doublePrecision;
 
     Host (const Host&);
     const Host& operator= (const Host&);
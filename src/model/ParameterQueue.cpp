@@ -0,0 +1,127 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#include "ParameterQueue.h"
+
+
+//==============================================================================
+ParameterQueue::ParameterQueue (const int maxChanges)
+  : fifo (maxChanges),
+    overflow (false),
+    numParameters (0),
+    changedValues (0),
+    changed (0),
+    changedIndices (0),
+    numChanged (0)
+{
+}
+
+ParameterQueue::~ParameterQueue ()
+{
+    delete[] changedValues;
+    delete[] changed;
+    delete[] changedIndices;
+}
+
+//==============================================================================
+void ParameterQueue::setNumParameters (const int numParameters_)
+{
+    delete[] changedValues;
+    delete[] changed;
+    delete[] changedIndices;
+
+    numParameters = jmax (0, numParameters_);
+    numChanged = 0;
+
+    changedValues = new float [jmax (1, numParameters)];
+    changed = new bool [jmax (1, numParameters)];
+    changedIndices = new int [jmax (1, numParameters)];
+
+    for (int i = 0; i < numParameters; i++)
+    {
+        changedValues [i] = 0.0f;
+        changed [i] = false;
+    }
+}
+
+//==============================================================================
+void ParameterQueue::put (const int index, const float value)
+{
+    uint32 valueBits;
+    memcpy (&valueBits, &value, sizeof (float));
+
+    const int64 change = (((int64) index) << 32) | (int64) valueBits;
+
+    // the fifo only takes a single writer at a time
+    const ScopedLock sl (writeLock);
+
+    if (fifo.isFull ())
+        overflow = true;
+    else
+        fifo.put (change);
+}
+
+//==============================================================================
+int ParameterQueue::collectChanges ()
+{
+    // forget about the previous block
+    for (int i = 0; i < numChanged; i++)
+        changed [changedIndices [i]] = false;
+
+    numChanged = 0;
+
+    if (overflow)
+    {
+        overflow = false;
+
+        while (! fifo.isEmpty ())
+            fifo.get ();
+
+        return -1;
+    }
+
+    while (! fifo.isEmpty ())
+    {
+        const int64 change = fifo.get ();
+        const uint32 valueBits = (uint32) (change & 0xffffffff);
+        const int index = (int) (change >> 32);
+
+        if (index < 0 || index >= numParameters)
+            continue;
+
+        if (! changed [index])
+        {
+            changed [index] = true;
+            changedIndices [numChanged++] = index;
+        }
+
+        memcpy (&changedValues [index], &valueBits, sizeof (float));
+    }
+
+    return numChanged;
+}
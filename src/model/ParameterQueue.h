@@ -0,0 +1,100 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#ifndef __JUCETICE_JOSTPARAMETERQUEUE_HEADER__
+#define __JUCETICE_JOSTPARAMETERQUEUE_HEADER__
+
+#include "../Config.h"
+
+
+//==============================================================================
+/**
+    Parameter changes made outside the audio thread, waiting for the next block.
+
+    Any number of threads (the gui, midi learn, state restore) can put changes
+    in, while the audio thread takes them out at the start of the plugin slot
+    without ever locking. Repeated writes to the same parameter in between two
+    blocks are coalesced, so the plugin only sees the last one.
+
+    If the queue fills up, the changes are lost and collectChanges will tell the
+    audio thread to take every parameter from its current value instead.
+*/
+class ParameterQueue
+{
+public:
+
+    //==============================================================================
+    /** Creates a queue holding up to maxChanges pending changes */
+    ParameterQueue (const int maxChanges);
+
+    /** Destructor */
+    ~ParameterQueue ();
+
+    //==============================================================================
+    /** Sets how many parameters the changes can refer to
+
+        This must not be called while the plugin is processing.
+    */
+    void setNumParameters (const int numParameters);
+
+    //==============================================================================
+    /** Queue a change, from any thread but the audio one */
+    void put (const int index, const float value);
+
+    //==============================================================================
+    /** Take out every pending change, from the audio thread
+
+        Returns how many parameters changed since the last call, or -1 if some
+        changes were lost and every parameter should be set again.
+    */
+    int collectChanges ();
+
+    /** Returns the parameter of a change collected by collectChanges */
+    int getChangedIndex (const int n) const            { return changedIndices [n]; }
+
+    /** Returns the last value written to a changed parameter */
+    float getChangedValue (const int n) const          { return changedValues [changedIndices [n]]; }
+
+private:
+
+    LockFreeFifo<int64> fifo;
+    CriticalSection writeLock;
+    volatile bool overflow;
+
+    int numParameters;
+    float* changedValues;
+    bool* changed;
+    int* changedIndices;
+    int numChanged;
+
+    ParameterQueue (const ParameterQueue&);
+    const ParameterQueue& operator= (const ParameterQueue&);
+};
+
+
+#endif // __JUCETICE_JOSTPARAMETERQUEUE_HEADER__
@@ -31,111 +31,132 @@
 
 //==============================================================================
 bool PluginLoader::canUnderstand (const File& file)
-{
-    DBG ("PluginLoader::canUnderstand");
-
-    if (! file.exists ())
-    {
-        printf ("Plugin %s doesn't exists on disk !", (const char*) file.getFullPathName ());
-        return false;
-    }
+{
+    DBG ("PluginLoader::canUnderstand");
 
-    // try with VST
-#if JOST_USE_VST
+    if (! file.exists ())
     {
-        VstPlugin* loadedPlugin = new VstPlugin ();
-        bool loadedOk = loadedPlugin->loadPluginFromFile (file);
-        
-        if (loadedOk)
-        {
-            deleteAndZero (loadedPlugin);
-            return true;
-        }
-        
-        deleteAndZero (loadedPlugin);
+        printf ("Plugin %s doesn't exists on disk !", (const char*) file.getFullPathName ());
+        return false;
     }
-#endif
 
-    // try with DSSI
-#if JUCE_ALSA && JOST_USE_DSSI
+    return PluginScanner::getInstance ()->getPluginType (file) != JOST_PLUGINTYPE_INVALID;
+}
+
+//==============================================================================
+BasePlugin* PluginLoader::getFromFile (const File& file, const int uniqueID)
+{
+    DBG ("PluginLoader::getFromFile");
+
+    BasePlugin* loadedPlugin = 0;
+
+    if (! file.exists ())
     {
-        DssiPlugin* loadedPlugin = new DssiPlugin ();
-        bool loadedOk = loadedPlugin->loadPluginFromFile (file);
-        
-        if (loadedOk)
-        {
-            deleteAndZero (loadedPlugin);
-            return true;
-        }
-        
-        deleteAndZero (loadedPlugin);
+        printf ("Plugin %s doesn't exists on disk !", (const char*) file.getFullPathName ());
+        return loadedPlugin;
     }
-#endif
 
-    // try with LADSPA
-#if JOST_USE_LADSPA
+    // the cache already knows which plugins this library holds
+    OwnedArray<PluginCacheEntry> entries;
+    PluginScanner::getInstance ()->getPluginEntries (file, entries);
+
+    PluginCacheEntry* entry = entries [0];
+    if (uniqueID != 0)
     {
-        LadspaPlugin* loadedPlugin = new LadspaPlugin ();
-        bool loadedOk = loadedPlugin->loadPluginFromFile (file);
-        
-        if (loadedOk)
-        {
-            deleteAndZero (loadedPlugin);
-            return true;
-        }
-        
-        deleteAndZero (loadedPlugin);
+        int i;
+        for (i = 0; i < entries.size (); i++)
+        {
+            if (entries.getUnchecked (i)->uniqueID == uniqueID)
+            {
+                entry = entries.getUnchecked (i);
+                break;
+            }
+        }
+
+        // don't load another plugin in place of the one wanted
+        if (i == entries.size ())
+        {
+            printf ("Plugin %d not found in %s !",
+                    uniqueID, (const char*) file.getFullPathName ());
+            return 0;
+        }
     }
-#endif
 
-    return false;
-}
+#if JOST_USE_BRIDGE
+    // libraries built for another architecture run in a bridge process
+    if (entry != 0 && BridgePlugin::isForeignLibrary (file))
+    {
+        loadedPlugin = new BridgePlugin (entry->type, entry->descriptorIndex);
 
-//==============================================================================
-BasePlugin* PluginLoader::getFromFile (const File& file)
-{    DBG ("PluginLoader::getFromFile");
-
-    BasePlugin* loadedPlugin = 0;
-
-    if (! file.exists ())
-    {
-        printf ("Plugin %s doesn't exists on disk !", (const char*) file.getFullPathName ());
-        return loadedPlugin;
-    }
+        if (! loadedPlugin->loadPluginFromFile (file))
+            deleteAndZero (loadedPlugin);
 
-    // try with VST
-#if JOST_USE_VST
-    {
-        loadedPlugin = new VstPlugin ();
-        if (loadedPlugin->loadPluginFromFile (file))
-            return loadedPlugin;
-        deleteAndZero (loadedPlugin);
+        return loadedPlugin;
     }
 #endif
 
-    // try with DSSI
-#if JUCE_ALSA && JOST_USE_DSSI
+    switch (entry != 0 ? entry->type : JOST_PLUGINTYPE_INVALID)
     {
-        loadedPlugin = new DssiPlugin ();
-        if (loadedPlugin->loadPluginFromFile (file))
-            return loadedPlugin;
-        deleteAndZero (loadedPlugin);
-    }
+#if JOST_USE_VST
+    case JOST_PLUGINTYPE_VST:
+        loadedPlugin = new VstPlugin ();
+        break;
+#endif
+#if JUCE_ALSA && JOST_USE_DSSI
+    case JOST_PLUGINTYPE_DSSI:
+        loadedPlugin = new DssiPlugin (entry->descriptorIndex);
+        break;
 #endif
-
-    // try with LADSPA
 #if JOST_USE_LADSPA
-    {
-        loadedPlugin = new LadspaPlugin ();
-        if (loadedPlugin->loadPluginFromFile (file))
-            return loadedPlugin;
+    case JOST_PLUGINTYPE_LADSPA:
+        loadedPlugin = new LadspaPlugin (entry->descriptorIndex);
+        break;
+#endif
+    default:
+        printf ("Plugin %s is not a known plugin type !", (const char*) file.getFullPathName ());
+        return 0;
+    }
+
+    if (! loadedPlugin->loadPluginFromFile (file))
         deleteAndZero (loadedPlugin);
+
+    return loadedPlugin;
+}
+
+//==============================================================================
+BasePlugin* PluginLoader::getPlaceholderFromFile (const PluginCacheEntry& sessionEntry,
+                                                  const int program)
+{
+    DBG ("PluginLoader::getPlaceholderFromFile");
+
+    const File file (sessionEntry.filePath);
+    const int uniqueID = sessionEntry.uniqueID;
+
+    if (! file.exists ())
+        return 0;
+
+    // we are loading a session, don't wait for the scanner
+    OwnedArray<PluginCacheEntry> entries;
+    if (PluginScanner::getInstance ()->getPluginEntries (file, entries, false) == 0)
+        return new PlaceholderPlugin (sessionEntry, program);
+
+    PluginCacheEntry entry (*entries.getUnchecked (0));
+    for (int i = 0; i < entries.size () && uniqueID != 0; i++)
+    {
+        if (entries.getUnchecked (i)->uniqueID == uniqueID)
+        {
+            entry = *entries.getUnchecked (i);
+            break;
+        }
     }
-#endif
 
-    return 0;
+    // if it is not there anymore the load will fail, but we still save it back
+    if (uniqueID != 0)
+        entry.uniqueID = uniqueID;
+
+    return new PlaceholderPlugin (entry, program);
 }
-
+
 //==============================================================================
 BasePlugin* PluginLoader::getFromTypeID (const int typeID,
                                          BasePlugin* inputPlugin,
@@ -177,6 +198,9 @@ BasePlugin* PluginLoader::getFromTypeID (const int typeID,
     case JOST_PLUGINTYPE_AUDIOSPECMETER:
         plugin = new AudioSpecMeterPlugin ();
         break;
+    case JOST_PLUGINTYPE_METRONOME:
+        plugin = new MetronomePlugin ();
+        break;
     case JOST_PLUGINTYPE_VST:
     case JOST_PLUGINTYPE_LADSPA:
     case JOST_PLUGINTYPE_DSSI:
@@ -210,6 +234,7 @@ BasePlugin* PluginLoader::handlePopupMenu ()
     menu.addItem (JOST_PLUGINTYPE_MIDIMONITOR,     "Add midi monitor");
     menu.addSeparator ();
     menu.addItem (JOST_PLUGINTYPE_AUDIOSPECMETER,  "Add audio meter");
+    menu.addItem (JOST_PLUGINTYPE_METRONOME,       "Add metronome");
 
     BasePlugin* plugin = 0;
 
@@ -220,3 +245,23 @@ BasePlugin* PluginLoader::handlePopupMenu ()
     return plugin;
 }
 
+//==============================================================================
+int PluginLoader::handleDescriptorPopupMenu (const File& file)
+{
+    DBG ("PluginLoader::handleDescriptorPopupMenu");
+
+    OwnedArray<PluginCacheEntry> entries;
+    if (PluginScanner::getInstance ()->getPluginEntries (file, entries) <= 1)
+        return 0;
+
+    PopupMenu menu;
+    for (int i = 0; i < entries.size (); i++)
+        menu.addItem (i + 1, entries.getUnchecked (i)->name);
+
+    const int result = menu.show();
+    if (result)
+        return entries.getUnchecked (result - 1)->uniqueID;
+
+    return -1;
+}
+
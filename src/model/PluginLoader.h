@@ -33,6 +33,7 @@
 #include "../Commands.h"
 
 #include "BasePlugin.h"
+#include "PluginScanner.h"
 
 #include "plugins/InputPlugin.h"
 #include "plugins/OutputPlugin.h"
@@ -46,16 +47,21 @@
 #include "plugins/MidiPads.h"
 
 #include "plugins/AudioSpecMeterPlugin.h"
+#include "plugins/MetronomePlugin.h"
 
 #include "plugins/VstPlugin.h"
 #include "plugins/LadspaPlugin.h"
 #include "plugins/DssiPlugin.h"
+#include "plugins/BridgePlugin.h"
+#include "plugins/PlaceholderPlugin.h"
 
 
 //==============================================================================
 /**
-    Plugin loader class. It will try to load each plugin type in series,
-    returning the first plugin technology it is able to open.
+    Plugin loader class. It will ask the plugin scanner which technology a
+    library is using, then open it directly with that plugin type.
+
+    @see PluginScanner
 */
 class PluginLoader
 {
@@ -64,8 +70,8 @@ public:
     //==============================================================================
     /** Try to see if we can load the file as a plugin
 
-        This method will try to load the file, managing to check if is one
-        of the known plugin type
+        This method will look up the file in the plugin cache, managing to
+        check if is one of the known plugin type, scanning it if needed
 
         @param file     the file to try to load
         @returns        true if it can load it, false otherwise.
@@ -79,12 +85,32 @@ public:
         of the known plugin type, and return it.
 
         @param file     the file to try to load
+        @param uniqueID the unique id of the plugin to load from a library
+                        holding more than one, 0 means the first one
         @returns        the plugin, or null if it there was an error loading it
+                        or the library doesn't hold the plugin wanted
+    */
+    static BasePlugin* getFromFile (const File& file, const int uniqueID = 0);
+
+    /** Creates a placeholder for a plugin in a file
+
+        The placeholder is made from the plugin cache, without opening the
+        library, and stands for the plugin until it is loaded. A library not
+        scanned yet is not waited for, it is queued for the scanner and the
+        placeholder is made from what the session knows instead.
+
+        @param sessionEntry the library path, type, unique id (0 means the
+                            first plugin) and ports as saved in the session
+        @param program      the program the plugin had
+        @returns            the placeholder, or null if the library is gone
+        @see PlaceholderPlugin
     */
-    static BasePlugin* getFromFile (const File& file);
+    static BasePlugin* getPlaceholderFromFile (const PluginCacheEntry& sessionEntry,
+                                               const int program);
 
     //==============================================================================
-    /** Loads an internal plugin based on type ID
+    /** Loads an internal plugin based on type ID
+
         This method will try to load the intern plugin
 
         @param typeID   the internal type id
@@ -94,7 +120,8 @@ public:
                                       BasePlugin* inputPlugin,
                                       BasePlugin* outputPlugin);
 
-    /** Loads an internal plugin from a popup menu selector
+    /** Loads an internal plugin from a popup menu selector
+
         This method will try to load the intern plugin
 
         @param typeID   the internal type id
@@ -102,6 +129,16 @@ public:
     */
     static BasePlugin* handlePopupMenu ();
 
+    /** Let choose a plugin from a library holding more than one
+
+        The plugins are listed from the plugin cache, without opening them.
+
+        @param file     the library to choose from
+        @returns        the unique id of the chosen plugin, 0 if the library
+                        holds a single plugin, or -1 if nothing was chosen
+    */
+    static int handleDescriptorPopupMenu (const File& file);
+
 };
 
 
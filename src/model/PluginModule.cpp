@@ -0,0 +1,235 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#include "PluginModule.h"
+
+#include <stdlib.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+
+//==============================================================================
+PluginModule::PluginModule (const String& path_,
+                            const int64 device_,
+                            const int64 inode_,
+                            void* handle_)
+  : path (path_),
+    device (device_),
+    inode (inode_),
+    handle (handle_),
+    refCount (0)
+{
+}
+
+PluginModule::~PluginModule ()
+{
+    jassert (refCount == 0);
+
+    if (handle)
+        PlatformUtilities::freeDynamicLibrary (handle);
+    handle = 0;
+}
+
+//==============================================================================
+void* PluginModule::getEntryPoint (const String& functionName)
+{
+    const ScopedLock sl (lock);
+
+    const int index = symbolNames.indexOf (functionName);
+    if (index >= 0)
+        return symbols.getUnchecked (index);
+
+    void* symbol = PlatformUtilities::getProcedureEntryPoint (handle, functionName);
+
+    symbolNames.add (functionName);
+    symbols.add (symbol);
+
+    return symbol;
+}
+
+const void* PluginModule::getDescriptor (const String& functionName, const int index)
+{
+    typedef const void* (*DescriptorFunction) (unsigned long);
+
+    const String key (functionName + T(":") + String (index));
+
+    {
+        const ScopedLock sl (lock);
+
+        const int keyIndex = descriptorKeys.indexOf (key);
+        if (keyIndex >= 0)
+            return descriptors.getUnchecked (keyIndex);
+    }
+
+    DescriptorFunction descriptorFunction = (DescriptorFunction) getEntryPoint (functionName);
+    if (descriptorFunction == 0)
+        return 0;
+
+    const void* descriptor = descriptorFunction (index);
+
+    const ScopedLock sl (lock);
+
+    descriptorKeys.add (key);
+    descriptors.add ((void*) descriptor);
+
+    return descriptor;
+}
+
+
+//==============================================================================
+PluginModuleManager::PluginModuleManager ()
+  : callbackLock (0)
+{
+}
+
+PluginModuleManager::~PluginModuleManager ()
+{
+    stopTimer ();
+
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = modules.size (); --i >= 0;)
+        {
+            PluginModule* module = modules.getUnchecked (i);
+            if (module->refCount > 0)
+            {
+                // somebody is still using it, better leak than crash
+                printf ("Plugin library %s still in use, not unloading \n",
+                        (const char*) module->getPath ());
+
+                modules.remove (i, false);
+            }
+        }
+
+        modules.clear (true);
+    }
+
+    clearSingletonInstance ();
+}
+
+//==============================================================================
+PluginModule* PluginModuleManager::openModule (const File& file)
+{
+    DBG ("PluginModuleManager::openModule");
+
+    String canonicalPath (file.getFullPathName ());
+    int64 device = 0, inode = 0;
+
+    char resolvedPath [PATH_MAX];
+    if (realpath ((const char*) file.getFullPathName (), resolvedPath) != 0)
+        canonicalPath = String (resolvedPath);
+
+    struct stat info;
+    if (stat ((const char*) canonicalPath, &info) == 0)
+    {
+        device = (int64) info.st_dev;
+        inode = (int64) info.st_ino;
+    }
+
+    const ScopedLock sl (lock);
+
+    for (int i = 0; i < modules.size (); i++)
+    {
+        PluginModule* module = modules.getUnchecked (i);
+
+        const bool sameFile = (inode != 0) ? (module->device == device && module->inode == inode)
+                                           : (module->path == canonicalPath);
+        if (sameFile)
+        {
+            module->refCount++;
+            return module;
+        }
+    }
+
+    void* handle = PlatformUtilities::loadDynamicLibrary (canonicalPath);
+    if (handle == 0)
+        return 0;
+
+    PluginModule* module = new PluginModule (canonicalPath, device, inode, handle);
+    module->refCount++;
+    modules.add (module);
+
+    return module;
+}
+
+void PluginModuleManager::releaseModule (PluginModule* module)
+{
+    DBG ("PluginModuleManager::releaseModule");
+
+    if (module == 0)
+        return;
+
+    const ScopedLock sl (lock);
+
+    jassert (modules.contains (module));
+    jassert (module->refCount > 0);
+
+    // the audio thread could still be in a block using it, leave it to the timer
+    if (--module->refCount == 0)
+        startTimer (JOST_PLUGIN_MODULE_UNLOAD_INTERVAL);
+}
+
+void PluginModuleManager::setCallbackLock (const CriticalSection* callbackLock_)
+{
+    const ScopedLock sl (lock);
+
+    callbackLock = callbackLock_;
+}
+
+void PluginModuleManager::timerCallback ()
+{
+    DBG ("PluginModuleManager::timerCallback");
+
+    stopTimer ();
+
+    OwnedArray<PluginModule> unusedModules;
+
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = modules.size (); --i >= 0;)
+        {
+            if (modules.getUnchecked (i)->refCount == 0)
+            {
+                unusedModules.add (modules.getUnchecked (i));
+                modules.remove (i, false);
+            }
+        }
+    }
+
+    // nothing can reach them anymore, wait for the block in flight if any
+    if (unusedModules.size () > 0 && callbackLock != 0)
+    {
+        const ScopedLock sl (*callbackLock);
+        unusedModules.clear (true);
+    }
+}
+
+//==============================================================================
+juce_ImplementSingleton (PluginModuleManager)
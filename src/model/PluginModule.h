@@ -0,0 +1,147 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#ifndef __JUCETICE_JOSTPLUGINMODULE_HEADER__
+#define __JUCETICE_JOSTPLUGINMODULE_HEADER__
+
+#include "../Config.h"
+
+
+//==============================================================================
+/**
+    A plugin shared library, opened once and shared by all the plugin
+    instances coming from it.
+
+    Entry points and descriptors are resolved the first time they are asked
+    for, then returned from here to every other instance.
+
+    @see PluginModuleManager
+*/
+class PluginModule
+{
+public:
+
+    //==============================================================================
+    /** Returns the canonical path of the library */
+    const String& getPath () const                  { return path; }
+
+    /** Returns the raw library handle */
+    void* getHandle () const                        { return handle; }
+
+    //==============================================================================
+    /** Find a function exported by the library, 0 if it isn't there */
+    void* getEntryPoint (const String& functionName);
+
+    /** Returns a descriptor from a LADSPA style descriptor function
+
+        This will call the function with the index only the first time.
+
+        @param functionName     the descriptor function, like "ladspa_descriptor"
+        @param index            the descriptor index
+        @returns                the descriptor, 0 if there is none at that index
+    */
+    const void* getDescriptor (const String& functionName, const int index);
+
+private:
+
+    friend class PluginModuleManager;
+    friend class OwnedArray<PluginModule>;
+
+    PluginModule (const String& path, const int64 device, const int64 inode, void* handle);
+    ~PluginModule ();
+
+    String path;
+    int64 device;
+    int64 inode;
+    void* handle;
+
+    int refCount;
+
+    CriticalSection lock;
+    StringArray symbolNames;
+    VoidArray symbols;
+    StringArray descriptorKeys;
+    VoidArray descriptors;
+};
+
+
+//==============================================================================
+/**
+    Reference counted registry of the plugin libraries opened by the host.
+
+    Libraries are keyed by device and inode of their canonical path, so
+    symlinks and different paths to the same library share a single module.
+
+    A module nothing references anymore is not unloaded right away, but
+    from a message thread timer holding the audio callback lock: no block
+    can be running the library code while it goes, and an instance opened
+    again meanwhile takes the module back.
+
+    @see PluginModule
+*/
+class PluginModuleManager : public Timer
+{
+public:
+
+    //==============================================================================
+    PluginModuleManager ();
+    ~PluginModuleManager ();
+
+    //==============================================================================
+    /** Open a library, or get a new reference to it if is already opened
+
+        @returns        the module, or 0 if the library couldn't be opened
+    */
+    PluginModule* openModule (const File& file);
+
+    /** Release a module previously opened
+
+        If that was the last reference, it will be unloaded by the timer.
+    */
+    void releaseModule (PluginModule* module);
+
+    /** Set the lock held while processing audio, taken when unloading modules */
+    void setCallbackLock (const CriticalSection* callbackLock);
+
+    //==============================================================================
+    /** @internal */
+    void timerCallback ();
+
+    //==============================================================================
+    /** Singleton declaration */
+    juce_DeclareSingleton (PluginModuleManager, true)
+
+private:
+
+    CriticalSection lock;
+    OwnedArray<PluginModule> modules;
+    const CriticalSection* volatile callbackLock;
+};
+
+
+#endif // __JUCETICE_JOSTPLUGINMODULE_HEADER__
@@ -0,0 +1,1051 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#include "PluginScanner.h"
+
+#include "plugins/VstPlugin.h"
+#include "plugins/LadspaPlugin.h"
+#include "plugins/DssiPlugin.h"
+#include "plugins/BridgePlugin.h"
+
+#if JUCE_LINUX
+ #include <unistd.h>
+ #include <poll.h>
+ #include <signal.h>
+ #include <sys/types.h>
+ #include <sys/wait.h>
+#endif
+
+
+//==============================================================================
+PluginCacheEntry::PluginCacheEntry ()
+  : fileTime (0),
+    fileSize (0),
+    type (JOST_PLUGINTYPE_INVALID),
+    blacklisted (false),
+    descriptorIndex (0),
+    uniqueID (0),
+    numInputs (0),
+    numOutputs (0),
+    numMidiInputs (0),
+    numMidiOutputs (0),
+    numParameters (0)
+{
+}
+
+PluginCacheEntry::PluginCacheEntry (const PluginCacheEntry& other)
+{
+    operator= (other);
+}
+
+const PluginCacheEntry& PluginCacheEntry::operator= (const PluginCacheEntry& other)
+{
+    filePath = other.filePath;
+    fileTime = other.fileTime;
+    fileSize = other.fileSize;
+    type = other.type;
+    blacklisted = other.blacklisted;
+    descriptorIndex = other.descriptorIndex;
+    uniqueID = other.uniqueID;
+    name = other.name;
+    numInputs = other.numInputs;
+    numOutputs = other.numOutputs;
+    numMidiInputs = other.numMidiInputs;
+    numMidiOutputs = other.numMidiOutputs;
+    numParameters = other.numParameters;
+    return *this;
+}
+
+//==============================================================================
+bool PluginCacheEntry::isUpToDate (const File& file) const
+{
+    return file.getLastModificationTime ().toMilliseconds () == fileTime
+           && file.getSize () == fileSize;
+}
+
+//==============================================================================
+void PluginCacheEntry::saveToXml (XmlElement* xml) const
+{
+    xml->setAttribute (T("file"), filePath);
+    xml->setAttribute (T("time"), String (fileTime));
+    xml->setAttribute (T("size"), String (fileSize));
+    xml->setAttribute (T("type"), type);
+    if (blacklisted)
+        xml->setAttribute (T("blacklisted"), 1);
+    xml->setAttribute (T("index"), descriptorIndex);
+    xml->setAttribute (T("id"), uniqueID);
+    xml->setAttribute (T("name"), name);
+    xml->setAttribute (T("ins"), numInputs);
+    xml->setAttribute (T("outs"), numOutputs);
+    xml->setAttribute (T("midiins"), numMidiInputs);
+    xml->setAttribute (T("midiouts"), numMidiOutputs);
+    xml->setAttribute (T("params"), numParameters);
+}
+
+void PluginCacheEntry::loadFromXml (XmlElement* xml)
+{
+    filePath = xml->getStringAttribute (T("file"));
+    fileTime = xml->getStringAttribute (T("time"), T("0")).getLargeIntValue ();
+    fileSize = xml->getStringAttribute (T("size"), T("0")).getLargeIntValue ();
+    type = xml->getIntAttribute (T("type"), JOST_PLUGINTYPE_INVALID);
+    blacklisted = xml->getBoolAttribute (T("blacklisted"), false);
+    descriptorIndex = xml->getIntAttribute (T("index"), 0);
+    uniqueID = xml->getIntAttribute (T("id"), 0);
+    name = xml->getStringAttribute (T("name"));
+    numInputs = xml->getIntAttribute (T("ins"), 0);
+    numOutputs = xml->getIntAttribute (T("outs"), 0);
+    numMidiInputs = xml->getIntAttribute (T("midiins"), 0);
+    numMidiOutputs = xml->getIntAttribute (T("midiouts"), 0);
+    numParameters = xml->getIntAttribute (T("params"), 0);
+}
+
+
+//==============================================================================
+/**
+    Sorts the cache entries by library path, keeping the order of a library
+*/
+class PluginCacheEntryComparator
+{
+public:
+
+    static int compareElements (PluginCacheEntry* first, PluginCacheEntry* second)
+    {
+        return first->filePath.compare ((const tchar*) second->filePath);
+    }
+};
+
+
+//==============================================================================
+PluginScanner::PluginScanner ()
+  : Thread (T("PluginScanner")),
+    cacheChanged (false)
+{
+    loadCache ();
+}
+
+PluginScanner::~PluginScanner ()
+{
+    stopThread (5000);
+
+    saveCache ();
+
+    clearSingletonInstance ();
+}
+
+//==============================================================================
+int PluginScanner::getPluginType (const File& file)
+{
+    if (! isUpToDate (file))
+        scanFile (file);
+
+    const ScopedLock sl (lock);
+
+    const int index = findFirstEntry (file.getFullPathName ());
+
+    return (index >= 0) ? entries.getUnchecked (index)->type
+                        : JOST_PLUGINTYPE_INVALID;
+}
+
+int PluginScanner::getPluginEntries (const File& file,
+                                     OwnedArray<PluginCacheEntry>& results,
+                                     const bool waitForScan)
+{
+    if (! isUpToDate (file))
+    {
+        if (waitForScan)
+            scanFile (file);
+        else
+            addUrgentFile (file);
+    }
+
+    const ScopedLock sl (lock);
+
+    const String filePath (file.getFullPathName ());
+
+    int numFound = 0;
+    for (int i = findFirstEntry (filePath); i >= 0 && i < entries.size (); i++)
+    {
+        PluginCacheEntry* entry = entries.getUnchecked (i);
+        if (entry->filePath != filePath)
+            break;
+
+        if (entry->type != JOST_PLUGINTYPE_INVALID)
+        {
+            results.add (new PluginCacheEntry (*entry));
+            ++numFound;
+        }
+    }
+
+    return numFound;
+}
+
+//==============================================================================
+bool PluginScanner::scanFile (const File& file)
+{
+    DBG ("PluginScanner::scanFile " + file.getFullPathName ());
+
+    if (! file.existsAsFile ())
+        return false;
+
+    // the scanner thread itself can't wait for itself
+    if (Thread::getCurrentThreadId () == getThreadId ())
+    {
+        StringArray filePaths;
+        filePaths.add (file.getFullPathName ());
+
+        scanFiles (filePaths);
+        return isUpToDate (file);
+    }
+
+    addUrgentFile (file);
+
+    // don't keep the caller stuck for longer than a worker would be
+    const uint32 startTime = Time::getMillisecondCounter ();
+    const bool isMessageThread = MessageManager::getInstance ()->isThisTheMessageThread ();
+
+    while (! isUpToDate (file))
+    {
+        if (hasScanFailed (file))
+            return false;
+
+        if (Time::getMillisecondCounter () - startTime > JOST_PLUGIN_SCAN_TIMEOUT)
+        {
+            printf ("Plugin %s is still being scanned \n", (const char*) file.getFullPathName ());
+            return false;
+        }
+
+        if (isMessageThread)
+            MessageManager::getInstance ()->runDispatchLoopUntil (JOST_PLUGIN_SCAN_POLL_INTERVAL);
+        else
+            Thread::sleep (JOST_PLUGIN_SCAN_POLL_INTERVAL);
+    }
+
+    return true;
+}
+
+void PluginScanner::scanDirectory (const File& directory, const bool recursive)
+{
+    OwnedArray<File> files;
+    directory.findChildFiles (files, File::findFiles, recursive, JOST_PLUGIN_WILDCARD);
+
+    StringArray filePaths;
+    for (int i = 0; i < files.size (); i++)
+        filePaths.add (files.getUnchecked (i)->getFullPathName ());
+
+    addPendingFiles (filePaths);
+
+    startThread (2);
+    notify ();
+}
+
+void PluginScanner::rescanChangedFiles ()
+{
+    StringArray filePaths;
+
+    {
+        const ScopedLock sl (lock);
+
+        // the entries of a library are together, take its path once
+        for (int i = 0; i < entries.size (); i++)
+        {
+            const String& filePath = entries.getUnchecked (i)->filePath;
+            if (i == 0 || filePath != entries.getUnchecked (i - 1)->filePath)
+                filePaths.add (filePath);
+        }
+    }
+
+    addPendingFiles (filePaths);
+
+    startThread (2);
+    notify ();
+}
+
+void PluginScanner::addUrgentFile (const File& file)
+{
+    {
+        const ScopedLock sl (lock);
+        urgentFiles.addIfNotAlreadyThere (file.getFullPathName ());
+
+        // asking again means trying again
+        failedFiles.removeString (file.getFullPathName ());
+    }
+
+    startThread (2);
+    notify ();
+}
+
+//==============================================================================
+void PluginScanner::run ()
+{
+    // a round is what the workers take at once, so waiting callers get in soon
+    const int maxFilesPerRound = jmax (1, SystemStats::getNumCpus ()) * JOST_PLUGIN_SCAN_BATCH;
+
+    while (! threadShouldExit ())
+    {
+        StringArray filePaths;
+
+        {
+            const ScopedLock sl (lock);
+
+            // libraries someone is waiting for go first
+            filePaths = urgentFiles;
+            urgentFiles.clear ();
+
+            while (filePaths.size () < maxFilesPerRound && pendingFiles.size () > 0)
+            {
+                filePaths.add (pendingFiles [pendingFiles.size () - 1]);
+                pendingFiles.remove (pendingFiles.size () - 1);
+            }
+        }
+
+        if (filePaths.size () == 0)
+        {
+            // we are done with this bunch, make it persistent
+            saveCache ();
+            sendChangeMessage (this);
+
+            wait (-1);
+            continue;
+        }
+
+        // don't bother the workers with unchanged libraries
+        for (int i = filePaths.size (); --i >= 0;)
+            if (isUpToDate (File (filePaths [i])))
+                filePaths.remove (i);
+
+        scanFiles (filePaths);
+    }
+}
+
+void PluginScanner::scanFailed (const File& file)
+{
+    const ScopedLock sl (lock);
+    failedFiles.addIfNotAlreadyThere (file.getFullPathName ());
+}
+
+bool PluginScanner::hasScanFailed (const File& file) const
+{
+    const ScopedLock sl (lock);
+    return failedFiles.contains (file.getFullPathName ());
+}
+
+//==============================================================================
+static void writeScanLine (const int resultDescriptor, const String& line)
+{
+    const String text (line + T("\n"));
+    const char* data = (const char*) text;
+    int bytesLeft = strlen (data);
+
+    while (bytesLeft > 0)
+    {
+        const int written = write (resultDescriptor, data, bytesLeft);
+        if (written <= 0)
+            break;
+
+        data += written;
+        bytesLeft -= written;
+    }
+}
+
+int PluginScanner::runScanWorker (const int resultDescriptor, const StringArray& filePaths)
+{
+    for (int i = 0; i < filePaths.size (); i++)
+    {
+        writeScanLine (resultDescriptor, T("B\t") + String (i));
+
+        OwnedArray<PluginCacheEntry> results;
+        probeFile (File (filePaths [i]), results);
+
+        for (int j = 0; j < results.size (); j++)
+        {
+            PluginCacheEntry* entry = results.getUnchecked (j);
+
+            writeScanLine (resultDescriptor, T("E\t") + String (entry->type)
+                           + T("\t") + String (entry->descriptorIndex)
+                           + T("\t") + String (entry->uniqueID)
+                           + T("\t") + String (entry->numInputs)
+                           + T("\t") + String (entry->numOutputs)
+                           + T("\t") + String (entry->numMidiInputs)
+                           + T("\t") + String (entry->numMidiOutputs)
+                           + T("\t") + String (entry->numParameters)
+                           + T("\t") + entry->name.replaceCharacters (T("\t\n"), T("  ")));
+        }
+
+        writeScanLine (resultDescriptor, T("D\t") + String (i));
+    }
+
+    return 0;
+}
+
+const File PluginScanner::findScanExecutable ()
+{
+#ifndef JOST_VST_PLUGIN
+    // we are jost, so are the workers
+    return File::getSpecialLocation (File::currentExecutableFile);
+#else
+    // we run inside another host, look for jost in the path
+    const char* path = getenv ("PATH");
+
+    StringArray paths;
+    if (path != 0)
+        paths.addTokens (String (path), T(":"), T(""));
+
+    for (int i = 0; i < paths.size (); i++)
+    {
+        if (paths [i].isEmpty ())
+            continue;
+
+        const File candidate (File (paths [i]).getChildFile (JOST_PLUGIN_SCAN_EXECUTABLE));
+        if (candidate.existsAsFile ())
+            return candidate;
+    }
+
+    return File::nonexistent;
+#endif
+}
+
+//==============================================================================
+#if JUCE_LINUX
+
+/**
+    A worker process probing a batch of libraries.
+
+    The worker is jost started again with JOST_PLUGIN_SCAN_ARGUMENT, so it
+    doesn't inherit the state of our threads. For every library it writes
+    to a pipe of its own a begin line, a line for each plugin entry found
+    and a done line: if it dies or hangs between a begin and a done line, we
+    know which library is the culprit. Its standard output goes to the
+    standard error, so what the libraries print can't mix with the lines.
+*/
+class PluginScanWorker
+{
+public:
+
+    PluginScanWorker (const StringArray& filePaths_)
+      : filePaths (filePaths_),
+        pid (-1),
+        fd (-1),
+        currentFile (-1),
+        numDone (0),
+        lastActivity (Time::getMillisecondCounter ())
+    {
+    }
+
+    ~PluginScanWorker ()
+    {
+        if (fd >= 0)
+            close (fd);
+    }
+
+    //==============================================================================
+    bool start (const File& executable)
+    {
+        if (! executable.existsAsFile ())
+            return false;
+
+        int fds [2];
+        if (pipe (fds) != 0)
+            return false;
+
+        // take everything before forking, the child will only exec
+        const String executablePath (executable.getFullPathName ());
+        const String resultDescriptor (fds [1]);
+
+        const char** arguments = new const char* [filePaths.size () + 4];
+        arguments [0] = (const char*) executablePath;
+        arguments [1] = JOST_PLUGIN_SCAN_ARGUMENT;
+        arguments [2] = (const char*) resultDescriptor;
+        for (int i = 0; i < filePaths.size (); i++)
+            arguments [i + 3] = (const char*) filePaths [i];
+        arguments [filePaths.size () + 3] = 0;
+
+        pid = fork ();
+        if (pid == 0)
+        {
+            // the write end stays open through exec, it is where results go
+            dup2 (STDERR_FILENO, STDOUT_FILENO);
+            close (fds [0]);
+
+            execv (arguments [0], (char* const*) arguments);
+            _exit (1);
+        }
+
+        delete[] arguments;
+        close (fds [1]);
+
+        if (pid < 0)
+        {
+            close (fds [0]);
+            return false;
+        }
+
+        fd = fds [0];
+        lastActivity = Time::getMillisecondCounter ();
+        return true;
+    }
+
+    /** Read what the worker has written, returns false when the pipe is closed */
+    bool readResults (PluginScanner* scanner)
+    {
+        char buffer [4096];
+        const int bytesRead = read (fd, buffer, sizeof (buffer) - 1);
+        if (bytesRead <= 0)
+            return false;
+
+        buffer [bytesRead] = 0;
+        pendingData += String (buffer);
+
+        int lineEnd;
+        while ((lineEnd = pendingData.indexOfChar (T('\n'))) >= 0)
+        {
+            handleLine (scanner, pendingData.substring (0, lineEnd));
+            pendingData = pendingData.substring (lineEnd + 1);
+
+            lastActivity = Time::getMillisecondCounter ();
+        }
+
+        return true;
+    }
+
+    /** True if nothing came from the worker since it started or its last line */
+    bool hasTimedOut () const
+    {
+        return Time::getMillisecondCounter () - lastActivity > JOST_PLUGIN_SCAN_TIMEOUT;
+    }
+
+    /** Wait for the worker to finish, killing it if asked */
+    void finish (const bool shouldKill)
+    {
+        if (shouldKill)
+            kill (pid, SIGKILL);
+
+        int status = 0;
+        waitpid (pid, &status, 0);
+
+        close (fd);
+        fd = -1;
+    }
+
+    //==============================================================================
+    StringArray filePaths;
+    int pid;
+    int fd;
+    int currentFile;
+    int numDone;
+    uint32 lastActivity;
+
+private:
+
+    //==============================================================================
+    void handleLine (PluginScanner* scanner, const String& line)
+    {
+        StringArray tokens;
+        tokens.addTokens (line, T("\t"), T(""));
+
+        if (tokens [0] == T("B"))
+        {
+            currentFile = tokens [1].getIntValue ();
+            results.clear ();
+        }
+        else if (tokens [0] == T("E") && currentFile >= 0)
+        {
+            PluginCacheEntry* entry = new PluginCacheEntry ();
+            entry->type = tokens [1].getIntValue ();
+            entry->descriptorIndex = tokens [2].getIntValue ();
+            entry->uniqueID = tokens [3].getIntValue ();
+            entry->numInputs = tokens [4].getIntValue ();
+            entry->numOutputs = tokens [5].getIntValue ();
+            entry->numMidiInputs = tokens [6].getIntValue ();
+            entry->numMidiOutputs = tokens [7].getIntValue ();
+            entry->numParameters = tokens [8].getIntValue ();
+            entry->name = tokens [9];
+            results.add (entry);
+        }
+        else if (tokens [0] == T("D") && currentFile >= 0)
+        {
+            scanner->updateEntries (File (filePaths [currentFile]), results);
+            results.clear ();
+
+            numDone = currentFile + 1;
+            currentFile = -1;
+        }
+    }
+
+    String pendingData;
+    OwnedArray<PluginCacheEntry> results;
+};
+
+#endif
+
+void PluginScanner::scanFiles (const StringArray& filePaths)
+{
+#if JUCE_LINUX
+    StringArray queue (filePaths);
+    StringArray retried;
+    OwnedArray<PluginScanWorker> workers;
+
+    const File executable (findScanExecutable ());
+    const int maxWorkers = jmax (1, SystemStats::getNumCpus ());
+
+    while (queue.size () > 0 || workers.size () > 0)
+    {
+        // we are quitting, what is not scanned will be scanned next time
+        if (threadShouldExit ())
+        {
+            for (int i = 0; i < workers.size (); i++)
+                workers.getUnchecked (i)->finish (true);
+
+            break;
+        }
+
+        // spawn workers for the queued libraries
+        while (workers.size () < maxWorkers && queue.size () > 0)
+        {
+            StringArray batch;
+            while (batch.size () < JOST_PLUGIN_SCAN_BATCH && queue.size () > 0)
+            {
+                batch.add (queue [queue.size () - 1]);
+                queue.remove (queue.size () - 1);
+            }
+
+            PluginScanWorker* worker = new PluginScanWorker (batch);
+            if (worker->start (executable))
+            {
+                workers.add (worker);
+            }
+            else
+            {
+                printf ("Cannot start a plugin scanner, scanning in process \n");
+
+                for (int i = 0; i < batch.size (); i++)
+                {
+                    OwnedArray<PluginCacheEntry> newEntries;
+                    probeFile (File (batch [i]), newEntries);
+                    updateEntries (File (batch [i]), newEntries);
+                }
+
+                delete worker;
+            }
+        }
+
+        if (workers.size () == 0)
+            break;
+
+        // wait for the workers to tell us something
+        struct pollfd* fds = new struct pollfd [workers.size ()];
+        for (int i = 0; i < workers.size (); i++)
+        {
+            fds [i].fd = workers.getUnchecked (i)->fd;
+            fds [i].events = POLLIN;
+            fds [i].revents = 0;
+        }
+
+        poll (fds, workers.size (), 100);
+
+        for (int i = workers.size (); --i >= 0;)
+        {
+            PluginScanWorker* worker = workers.getUnchecked (i);
+
+            bool finished = false, hung = false;
+
+            if (fds [i].revents != 0)
+                finished = ! worker->readResults (this);
+
+            if (! finished && worker->hasTimedOut ())
+                finished = hung = true;
+
+            if (! finished)
+                continue;
+
+            worker->finish (hung);
+
+            // the library being probed when the worker died is the culprit,
+            // a slow one is tried again next time instead of being blacklisted
+            int nextFile = worker->numDone;
+            if (worker->currentFile >= 0)
+            {
+                const File culprit (worker->filePaths [worker->currentFile]);
+
+                if (hung)
+                {
+                    printf ("Plugin %s timed out while scanning, it will be scanned again \n",
+                            (const char*) culprit.getFullPathName ());
+
+                    scanFailed (culprit);
+                }
+                else
+                {
+                    printf ("Plugin %s crashed while scanning, blacklisted \n",
+                            (const char*) culprit.getFullPathName ());
+
+                    blacklistFile (culprit);
+                }
+
+                nextFile = worker->currentFile + 1;
+            }
+
+            // give the others another chance, but only one if no library is to blame
+            for (int j = nextFile; j < worker->filePaths.size (); j++)
+            {
+                const String filePath (worker->filePaths [j]);
+
+                if (worker->currentFile < 0)
+                {
+                    if (retried.contains (filePath))
+                    {
+                        printf ("Plugin %s could not be scanned \n", (const char*) filePath);
+                        scanFailed (File (filePath));
+                        continue;
+                    }
+
+                    retried.add (filePath);
+                }
+
+                queue.add (filePath);
+            }
+
+            workers.remove (i, true);
+        }
+
+        delete[] fds;
+    }
+#else
+    for (int i = 0; i < filePaths.size (); i++)
+    {
+        const File file (filePaths [i]);
+
+        OwnedArray<PluginCacheEntry> newEntries;
+        if (file.existsAsFile ())
+            probeFile (file, newEntries);
+
+        updateEntries (file, newEntries);
+    }
+#endif
+}
+
+//==============================================================================
+#if JOST_USE_LADSPA || (JUCE_ALSA && JOST_USE_DSSI)
+static void fillEntryFromLadspa (PluginCacheEntry* entry, const LADSPA_Descriptor* descriptor)
+{
+    entry->uniqueID = descriptor->UniqueID;
+    entry->name = descriptor->Label ? String (descriptor->Label) : String::empty;
+
+    for (uint i = 0; i < descriptor->PortCount; i++)
+    {
+        const LADSPA_PortDescriptor pod = descriptor->PortDescriptors [i];
+
+        if (LADSPA_IS_PORT_CONTROL (pod) && LADSPA_IS_PORT_INPUT (pod))
+            entry->numParameters++;
+
+        if (LADSPA_IS_PORT_AUDIO (pod))
+        {
+            if (LADSPA_IS_PORT_INPUT (pod))     entry->numInputs++;
+            if (LADSPA_IS_PORT_OUTPUT (pod))    entry->numOutputs++;
+        }
+    }
+}
+#endif
+
+void PluginScanner::probeFile (const File& file, OwnedArray<PluginCacheEntry>& results)
+{
+#if JOST_USE_BRIDGE
+    // we can't load these, the bridge will tell us what's inside
+    if (BridgePlugin::isForeignLibrary (file))
+    {
+        BridgePlugin::probeFile (file, results);
+        return;
+    }
+#endif
+
+    void* library = PlatformUtilities::loadDynamicLibrary (file.getFullPathName ());
+    if (library == 0)
+        return;
+
+    // try with VST
+#if JOST_USE_VST
+    if (results.size () == 0
+        && (PlatformUtilities::getProcedureEntryPoint (library, T("VSTPluginMain")) != 0
+            || PlatformUtilities::getProcedureEntryPoint (library, T("main")) != 0))
+    {
+        // vst will tell us something only when instantiated
+        VstPlugin* plugin = new VstPlugin ();
+        if (plugin->loadPluginFromFile (file))
+        {
+            PluginCacheEntry* entry = new PluginCacheEntry ();
+            entry->type = JOST_PLUGINTYPE_VST;
+            entry->uniqueID = plugin->getID ();
+            entry->name = plugin->getName ();
+            entry->numInputs = plugin->getNumInputs ();
+            entry->numOutputs = plugin->getNumOutputs ();
+            entry->numMidiInputs = plugin->getNumMidiInputs ();
+            entry->numMidiOutputs = plugin->getNumMidiOutputs ();
+            entry->numParameters = plugin->getNumParameters ();
+            results.add (entry);
+        }
+        deleteAndZero (plugin);
+    }
+#endif
+
+    // try with DSSI
+#if JUCE_ALSA && JOST_USE_DSSI
+    if (results.size () == 0)
+    {
+        DSSI_Descriptor_Function descriptorFunction
+                = (DSSI_Descriptor_Function)
+                        PlatformUtilities::getProcedureEntryPoint (library, T("dssi_descriptor"));
+
+        if (descriptorFunction != 0)
+        {
+            const DSSI_Descriptor* descriptor;
+            for (int index = 0; (descriptor = descriptorFunction (index)) != 0; index++)
+            {
+                if (descriptor->LADSPA_Plugin == 0)
+                    continue;
+
+                PluginCacheEntry* entry = new PluginCacheEntry ();
+                entry->type = JOST_PLUGINTYPE_DSSI;
+                entry->descriptorIndex = index;
+                entry->numMidiInputs = 1;
+                fillEntryFromLadspa (entry, descriptor->LADSPA_Plugin);
+                results.add (entry);
+            }
+        }
+    }
+#endif
+
+    // try with LADSPA
+#if JOST_USE_LADSPA
+    if (results.size () == 0)
+    {
+        LADSPA_Descriptor_Function descriptorFunction
+                = (LADSPA_Descriptor_Function)
+                        PlatformUtilities::getProcedureEntryPoint (library, T("ladspa_descriptor"));
+
+        if (descriptorFunction != 0)
+        {
+            const LADSPA_Descriptor* descriptor;
+            for (int index = 0; (descriptor = descriptorFunction (index)) != 0; index++)
+            {
+                PluginCacheEntry* entry = new PluginCacheEntry ();
+                entry->type = JOST_PLUGINTYPE_LADSPA;
+                entry->descriptorIndex = index;
+                entry->numMidiInputs = 1;
+                fillEntryFromLadspa (entry, descriptor);
+                results.add (entry);
+            }
+        }
+    }
+#endif
+
+    PlatformUtilities::freeDynamicLibrary (library);
+}
+
+//==============================================================================
+void PluginScanner::loadCache ()
+{
+    const File cacheFile (JOST_PLUGIN_CACHE_PATH);
+    if (! cacheFile.existsAsFile ())
+        return;
+
+    XmlDocument xmlDoc (cacheFile);
+    XmlElement* xml = xmlDoc.getDocumentElement ();
+    if (xml == 0 || ! xml->hasTagName (JOST_PLUGIN_CACHE_TAG))
+    {
+        printf ("Plugin cache %s is not valid, it will be rebuilt \n",
+                (const char*) cacheFile.getFullPathName ());
+        delete xml;
+        return;
+    }
+
+    const ScopedLock sl (lock);
+
+    entries.clear ();
+
+    forEachXmlChildElementWithTagName (*xml, e, JOST_PRESET_PLUGINTAG)
+    {
+        PluginCacheEntry* entry = new PluginCacheEntry ();
+        entry->loadFromXml (e);
+        entries.add (entry);
+    }
+
+    // caches written by older versions may not be sorted
+    PluginCacheEntryComparator comparator;
+    entries.sort (comparator, true);
+
+    cacheChanged = false;
+
+    delete xml;
+}
+
+void PluginScanner::saveCache ()
+{
+    XmlElement xml (JOST_PLUGIN_CACHE_TAG);
+
+    {
+        const ScopedLock sl (lock);
+
+        if (! cacheChanged)
+            return;
+
+        for (int i = 0; i < entries.size (); i++)
+        {
+            XmlElement* e = new XmlElement (JOST_PRESET_PLUGINTAG);
+            entries.getUnchecked (i)->saveToXml (e);
+            xml.addChildElement (e);
+        }
+
+        cacheChanged = false;
+    }
+
+    // write aside and move, so a crash won't leave a truncated cache
+    const File cacheFile (JOST_PLUGIN_CACHE_PATH);
+    const File tempFile (cacheFile.getNonexistentSibling ());
+
+    cacheFile.getParentDirectory ().createDirectory ();
+
+    if (! xml.writeToFile (tempFile, String::empty)
+        || ! tempFile.moveFileTo (cacheFile))
+    {
+        printf ("Cannot write plugin cache %s \n",
+                (const char*) cacheFile.getFullPathName ());
+        tempFile.deleteFile ();
+    }
+}
+
+//==============================================================================
+int PluginScanner::findInsertIndex (const String& filePath) const
+{
+    int start = 0;
+    int end = entries.size ();
+
+    while (start < end)
+    {
+        const int middle = (start + end) / 2;
+
+        if (entries.getUnchecked (middle)->filePath.compare ((const tchar*) filePath) < 0)
+            start = middle + 1;
+        else
+            end = middle;
+    }
+
+    return start;
+}
+
+int PluginScanner::findFirstEntry (const String& filePath) const
+{
+    const int index = findInsertIndex (filePath);
+
+    if (index < entries.size () && entries.getUnchecked (index)->filePath == filePath)
+        return index;
+
+    return -1;
+}
+
+void PluginScanner::removeEntries (const String& filePath)
+{
+    const int index = findInsertIndex (filePath);
+
+    int end = index;
+    while (end < entries.size () && entries.getUnchecked (end)->filePath == filePath)
+        ++end;
+
+    entries.removeRange (index, end - index, true);
+}
+
+void PluginScanner::addPendingFiles (const StringArray& filePaths)
+{
+    const ScopedLock sl (lock);
+
+    pendingFiles.addArray (filePaths);
+
+    // sorted, duplicates are next to each other
+    pendingFiles.sort (false);
+
+    for (int i = pendingFiles.size (); --i > 0;)
+        if (pendingFiles [i] == pendingFiles [i - 1])
+            pendingFiles.remove (i);
+}
+
+void PluginScanner::updateEntries (const File& file, OwnedArray<PluginCacheEntry>& newEntries)
+{
+    const String filePath (file.getFullPathName ());
+
+    // mark non plugins too, so we won't open them again
+    if (newEntries.size () == 0)
+        newEntries.add (new PluginCacheEntry ());
+
+    const ScopedLock sl (lock);
+
+    removeEntries (filePath);
+
+    if (file.existsAsFile ())
+    {
+        const int64 fileTime = file.getLastModificationTime ().toMilliseconds ();
+        const int64 fileSize = file.getSize ();
+
+        // keep the entries of a library together, in their sorted place
+        const int index = findInsertIndex (filePath);
+
+        for (int i = 0; i < newEntries.size (); i++)
+        {
+            PluginCacheEntry* entry = newEntries.getUnchecked (i);
+            entry->filePath = filePath;
+            entry->fileTime = fileTime;
+            entry->fileSize = fileSize;
+            entries.insert (index + i, entry);
+        }
+
+        newEntries.clear (false);
+    }
+
+    cacheChanged = true;
+}
+
+void PluginScanner::blacklistFile (const File& file)
+{
+    OwnedArray<PluginCacheEntry> newEntries;
+
+    PluginCacheEntry* entry = new PluginCacheEntry ();
+    entry->blacklisted = true;
+    entry->name = file.getFileNameWithoutExtension ();
+    newEntries.add (entry);
+
+    updateEntries (file, newEntries);
+}
+
+bool PluginScanner::isUpToDate (const File& file) const
+{
+    const ScopedLock sl (lock);
+
+    const int index = findFirstEntry (file.getFullPathName ());
+
+    return index >= 0 && entries.getUnchecked (index)->isUpToDate (file);
+}
+
+//==============================================================================
+juce_ImplementSingleton (PluginScanner)
@@ -0,0 +1,215 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#ifndef __JUCETICE_JOSTPLUGINSCANNER_HEADER__
+#define __JUCETICE_JOSTPLUGINSCANNER_HEADER__
+
+#include "../Config.h"
+
+
+//==============================================================================
+/**
+    What we know about a single plugin found in a library on disk.
+
+    A library holding more than one descriptor (LADSPA and DSSI ones) will
+    have one entry per descriptor. A library that isn't a plugin at all will
+    have one entry of JOST_PLUGINTYPE_INVALID type, so we won't try to open
+    it again until it changes on disk. The same goes for blacklisted ones,
+    that crashed or hung while being scanned.
+*/
+class PluginCacheEntry
+{
+public:
+
+    //==============================================================================
+    PluginCacheEntry ();
+    PluginCacheEntry (const PluginCacheEntry& other);
+    const PluginCacheEntry& operator= (const PluginCacheEntry& other);
+
+    //==============================================================================
+    /** Returns true if the library on disk is the one we have scanned */
+    bool isUpToDate (const File& file) const;
+
+    //==============================================================================
+    void saveToXml (XmlElement* xml) const;
+    void loadFromXml (XmlElement* xml);
+
+    //==============================================================================
+    String filePath;
+    int64 fileTime;
+    int64 fileSize;
+
+    int type;
+    bool blacklisted;
+    int descriptorIndex;
+    int uniqueID;
+    String name;
+
+    int numInputs;
+    int numOutputs;
+    int numMidiInputs;
+    int numMidiOutputs;
+    int numParameters;
+};
+
+
+//==============================================================================
+/**
+    Keeps the plugin metadata cache, and scan libraries in a background thread.
+
+    Every library is probed once and the results are kept in
+    JOST_PLUGIN_CACHE_PATH, along with the library modification time and
+    size: next time we are asked about that file we answer from the cache,
+    and the loader can open it with the right plugin technology directly.
+
+    Libraries are probed by the scanner thread in worker processes, one per
+    cpu, each one taking a batch of files: jost runs itself again with
+    JOST_PLUGIN_SCAN_ARGUMENT for that. A library crashing or hanging for
+    longer than JOST_PLUGIN_SCAN_TIMEOUT will only take down its worker. A
+    crashing one is blacklisted until it changes on disk, a hanging one is
+    left out of the cache, so it will be scanned again next time.
+
+    @see PluginLoader
+*/
+class PluginScanner : public Thread,
+                      public ChangeBroadcaster
+{
+public:
+
+    //==============================================================================
+    /** Constructor, it will read the cache from disk */
+    PluginScanner ();
+
+    /** Destructor, it will stop scanning and write the cache to disk */
+    ~PluginScanner ();
+
+    //==============================================================================
+    /** Returns the plugin type of a library
+
+        If the library is not in the cache, or it changed on disk, it will be
+        scanned now. It returns JOST_PLUGINTYPE_INVALID for non plugins, and
+        for libraries that couldn't be scanned.
+
+        @see scanFile
+    */
+    int getPluginType (const File& file);
+
+    /** Copy all the cached entries of a library
+
+        If the library is not in the cache, or it changed on disk, it will be
+        scanned now. Invalid libraries will return no entries.
+
+        @param waitForScan  if false, a library not scanned yet is only queued
+                            before the others and what the cache has is returned
+
+        @see scanFile
+    */
+    int getPluginEntries (const File& file,
+                          OwnedArray<PluginCacheEntry>& results,
+                          const bool waitForScan = true);
+
+    /** Returns true if the cache knows the library as it is on disk now */
+    bool isUpToDate (const File& file) const;
+
+    //==============================================================================
+    /** Probe a library now, replacing its cached entries
+
+        The library is probed by the scanner thread before the other queued
+        ones, while we wait for it to be scanned or to fail. On the message
+        thread, messages are dispatched meanwhile so the gui keeps running.
+
+        @returns true if the library is in the cache now
+    */
+    bool scanFile (const File& file);
+
+    /** Queue a directory for scanning in the background thread */
+    void scanDirectory (const File& directory, const bool recursive);
+
+    /** Queue every cached library, they will be probed again only if changed */
+    void rescanChangedFiles ();
+
+    //==============================================================================
+    /** Open a library and fill in the entries for every plugin found in it
+
+        This is where the library code is run, so the less we do it...
+    */
+    static void probeFile (const File& file, OwnedArray<PluginCacheEntry>& results);
+
+    /** Probe some libraries, writing what is found to a descriptor
+
+        This is what the worker processes run. The results don't go to the
+        standard output, as the libraries and our loader print there too.
+    */
+    static int runScanWorker (const int resultDescriptor, const StringArray& filePaths);
+
+    //==============================================================================
+    /** Read the cache from disk */
+    void loadCache ();
+
+    /** Write the cache to disk, if it has changed */
+    void saveCache ();
+
+    //==============================================================================
+    /** @internal */
+    void run ();
+
+    //==============================================================================
+    /** Singleton declaration */
+    juce_DeclareSingleton (PluginScanner, true)
+
+private:
+
+    friend class PluginScanWorker;
+
+    //==============================================================================
+    void scanFiles (const StringArray& filePaths);
+    static const File findScanExecutable ();
+
+    //==============================================================================
+    int findInsertIndex (const String& filePath) const;
+    int findFirstEntry (const String& filePath) const;
+    void addPendingFiles (const StringArray& filePaths);
+    void removeEntries (const String& filePath);
+    void updateEntries (const File& file, OwnedArray<PluginCacheEntry>& newEntries);
+    void blacklistFile (const File& file);
+    void addUrgentFile (const File& file);
+    void scanFailed (const File& file);
+    bool hasScanFailed (const File& file) const;
+
+    CriticalSection lock;
+
+    // sorted by library path, the entries of a library one after the other
+    OwnedArray<PluginCacheEntry> entries;
+    StringArray pendingFiles;
+    StringArray urgentFiles;
+    StringArray failedFiles;
+    bool cacheChanged;
+};
+
+
+#endif // __JUCETICE_JOSTPLUGINSCANNER_HEADER__
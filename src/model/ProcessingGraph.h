@@ -100,6 +100,13 @@ public:
         return (ProcessingLink*) links[type].getUnchecked (index);
     }
 
+    /** Removes a connection, freeing it */
+    inline void deleteLink (const int type, const int index)
+    {
+        delete ((ProcessingLink*) links[type].getUnchecked (index));
+        links[type].remove (index);
+    }
+
     /** Clears all available connections, freeing up */
     inline void deleteAllLinks (const int type = -1)
     {
@@ -0,0 +1,379 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#include "SceneManager.h"
+#include "../HostFilterBase.h"
+
+
+//==============================================================================
+static inline void writeSceneValue (MemoryBlock& data, const int32 value)
+{
+    data.append (&value, sizeof (int32));
+}
+
+static inline void writeSceneValue (MemoryBlock& data, const float value)
+{
+    data.append (&value, sizeof (float));
+}
+
+static inline int32 readSceneInt (const char*& ptr)
+{
+    int32 value;
+    memcpy (&value, ptr, sizeof (int32));
+    ptr += sizeof (int32);
+    return value;
+}
+
+static inline float readSceneFloat (const char*& ptr)
+{
+    float value;
+    memcpy (&value, ptr, sizeof (float));
+    ptr += sizeof (float);
+    return value;
+}
+
+// size of a plugin header: hash, gain, flags, numParameters
+#define SCENE_PLUGIN_HEADER_SIZE        (4 * sizeof (int32))
+
+
+//==============================================================================
+Scene::Scene (const String& name_)
+  : name (name_)
+{
+}
+
+Scene::~Scene ()
+{
+}
+
+//==============================================================================
+void Scene::capture (Host* host)
+{
+    data.setSize (0);
+
+    writeSceneValue (data, (int32) host->getPluginsCount ());
+
+    for (int i = 0; i < host->getPluginsCount (); i++)
+    {
+        BasePlugin* plugin = host->getPluginByIndex (i);
+
+        int32 flags = 0;
+        if (plugin->isMuted ())   flags |= Scene::muted;
+        if (plugin->isBypass ())  flags |= Scene::bypass;
+
+        const int numParameters = plugin->getNumParameters ();
+
+        writeSceneValue (data, (int32) plugin->getUniqueHash ());
+        writeSceneValue (data, plugin->getOutputGain ());
+        writeSceneValue (data, flags);
+        writeSceneValue (data, (int32) numParameters);
+
+        for (int p = 0; p < numParameters; p++)
+            writeSceneValue (data, plugin->getParameter (p));
+    }
+}
+
+void Scene::remapHashes (const Array<int>& oldHash, const Array<int>& newHash)
+{
+    if (data.getSize () < (int) sizeof (int32))
+        return;
+
+    char* ptr = (char*) data.getData ();
+    const char* end = ptr + data.getSize ();
+
+    const char* readPtr = ptr;
+    const int numPlugins = readSceneInt (readPtr);
+    ptr = (char*) readPtr;
+
+    for (int i = 0; i < numPlugins && ptr + SCENE_PLUGIN_HEADER_SIZE <= end; i++)
+    {
+        readPtr = ptr;
+        const int hash = readSceneInt (readPtr);
+        readSceneFloat (readPtr);
+        readSceneInt (readPtr);
+        const int numParameters = readSceneInt (readPtr);
+
+        const int hashIndex = oldHash.indexOf (hash);
+        if (hashIndex >= 0)
+        {
+            const int32 remappedHash = newHash [hashIndex];
+            memcpy (ptr, &remappedHash, sizeof (int32));
+        }
+
+        ptr = (char*) readPtr + numParameters * sizeof (float);
+    }
+}
+
+
+//==============================================================================
+SceneManager::SceneManager (HostFilterBase* owner_, Host* host_)
+  : owner (owner_),
+    host (host_),
+    activeScene (0),
+    pendingScene (-1),
+    currentScene (-1),
+    rampMilliseconds (50),
+    rampSamplesLeft (0),
+    programChangeChannel (0)
+{
+}
+
+SceneManager::~SceneManager ()
+{
+    clearScenes ();
+}
+
+//==============================================================================
+void SceneManager::storeScene (const int sceneIndex)
+{
+    if (sceneIndex < 0 || sceneIndex >= JOST_MAX_SCENES)
+        return;
+
+    Scene* scene = new Scene (T("Scene ") + String (sceneIndex + 1));
+    scene->capture (host);
+
+    setScene (sceneIndex, scene);
+}
+
+void SceneManager::recallScene (const int sceneIndex)
+{
+    if (sceneIndex >= 0 && sceneIndex < JOST_MAX_SCENES)
+        pendingScene = sceneIndex;
+}
+
+bool SceneManager::hasScene (const int sceneIndex) const
+{
+    return scenes [sceneIndex] != 0;
+}
+
+void SceneManager::clearScenes ()
+{
+    const ScopedLock sl (owner->getCallbackLock ());
+
+    pendingScene = -1;
+    activeScene = 0;
+    currentScene = -1;
+    rampSamplesLeft = 0;
+
+    scenes.clear (true);
+}
+
+void SceneManager::setScene (const int sceneIndex, Scene* newScene)
+{
+    const ScopedLock sl (owner->getCallbackLock ());
+
+    while (scenes.size () <= sceneIndex)
+        scenes.add (0);
+
+    if (activeScene == scenes [sceneIndex])
+    {
+        activeScene = 0;
+        rampSamplesLeft = 0;
+    }
+
+    scenes.set (sceneIndex, newScene, true);
+}
+
+//==============================================================================
+void SceneManager::processIncomingMidi (MidiBuffer& midiMessages)
+{
+    if (programChangeChannel == 0)
+        return;
+
+    const uint8* data;
+    int numBytes, samplePosition;
+    bool consumed = false;
+
+    MidiBuffer::Iterator it (midiMessages);
+    while (it.getNextEvent (data, numBytes, samplePosition))
+    {
+        if (isSceneProgramChange (data, numBytes))
+        {
+            recallScene (data[1]);
+            consumed = true;
+        }
+    }
+
+    if (! consumed)
+        return;
+
+    // plugins listening on that channel must not see the scene changes
+    passedMessages.clear ();
+
+    MidiBuffer::Iterator passed (midiMessages);
+    while (passed.getNextEvent (data, numBytes, samplePosition))
+    {
+        if (! isSceneProgramChange (data, numBytes))
+            passedMessages.addEvent (data, numBytes, samplePosition);
+    }
+
+    midiMessages.clear ();
+    midiMessages.addEvents (passedMessages, 0, -1, 0);
+}
+
+bool SceneManager::isSceneProgramChange (const uint8* data, const int numBytes) const
+{
+    return numBytes >= 2
+           && (data[0] & 0xf0) == 0xc0
+           && (data[0] & 0x0f) + 1 == programChangeChannel;
+}
+
+bool SceneManager::handleMidiMessage (const MidiMessage& message)
+{
+    if (message.isController ())
+    {
+        recallScene (message.getControllerValue ());
+        return true;
+    }
+
+    return false;
+}
+
+//==============================================================================
+void SceneManager::processBlock (const double sampleRate, const int blockSize)
+{
+    bool applyMixer = false;
+
+    const int newScene = pendingScene;
+    if (newScene >= 0)
+    {
+        pendingScene = -1;
+
+        Scene* scene = scenes [newScene];
+        if (scene)
+        {
+            activeScene = scene;
+            currentScene = newScene;
+            rampSamplesLeft = roundDoubleToInt (sampleRate * rampMilliseconds / 1000.0);
+            applyMixer = true;
+        }
+    }
+
+    if (activeScene && (applyMixer || rampSamplesLeft > 0))
+    {
+        const float rampAmount = (rampSamplesLeft > blockSize) ? blockSize / (float) rampSamplesLeft
+                                                               : 1.0f;
+
+        applyScene (activeScene, rampAmount, applyMixer);
+
+        rampSamplesLeft = jmax (0, rampSamplesLeft - blockSize);
+    }
+}
+
+void SceneManager::applyScene (Scene* scene, const float rampAmount, const bool applyMixer)
+{
+    const MemoryBlock& data = scene->getData ();
+    if (data.getSize () < (int) sizeof (int32))
+        return;
+
+    const char* ptr = (const char*) data.getData ();
+    const char* end = ptr + data.getSize ();
+
+    const int numPlugins = readSceneInt (ptr);
+
+    for (int i = 0; i < numPlugins && ptr + SCENE_PLUGIN_HEADER_SIZE <= end; i++)
+    {
+        const int hash = readSceneInt (ptr);
+        const float gain = readSceneFloat (ptr);
+        const int flags = readSceneInt (ptr);
+        const int numParameters = readSceneInt (ptr);
+
+        const char* nextPlugin = ptr + numParameters * sizeof (float);
+        if (nextPlugin > end)
+            break;
+
+        BasePlugin* plugin = host->getPluginByUniqueHash (hash);
+        if (plugin)
+        {
+            if (applyMixer)
+            {
+                // the host will ramp the gain for us
+                plugin->setOutputGain (gain);
+                plugin->setMuted ((flags & Scene::muted) != 0);
+                plugin->setBypass ((flags & Scene::bypass) != 0);
+            }
+
+            const int count = jmin (numParameters, plugin->getNumParameters ());
+            for (int p = 0; p < count; p++)
+            {
+                const float target = readSceneFloat (ptr);
+                const float current = plugin->getParameter (p);
+
+                if (current != target)
+                    plugin->setParameter (p, current + (target - current) * rampAmount);
+            }
+        }
+
+        ptr = nextPlugin;
+    }
+}
+
+//==============================================================================
+void SceneManager::saveToXml (XmlElement* xml)
+{
+    xml->setAttribute (T("ramp"), rampMilliseconds);
+    xml->setAttribute (T("channel"), programChangeChannel);
+    xml->setAttribute (T("controller"), getControllerNumber ());
+
+    for (int i = 0; i < scenes.size (); i++)
+    {
+        Scene* scene = scenes.getUnchecked (i);
+        if (scene)
+        {
+            XmlElement* e = new XmlElement (T("scene"));
+            e->setAttribute (T("index"), i);
+            e->setAttribute (T("name"), scene->getName ());
+            e->addTextElement (scene->getData ().toBase64Encoding ());
+            xml->addChildElement (e);
+        }
+    }
+}
+
+void SceneManager::loadFromXml (XmlElement* xml,
+                                const Array<int>& oldHash,
+                                const Array<int>& newHash)
+{
+    clearScenes ();
+
+    setRampTime (xml->getIntAttribute (T("ramp"), 50));
+    setProgramChangeChannel (xml->getIntAttribute (T("channel"), 0));
+    setControllerNumber (xml->getIntAttribute (T("controller"), -1));
+
+    forEachXmlChildElementWithTagName (*xml, e, T("scene"))
+    {
+        const int index = e->getIntAttribute (T("index"), -1);
+        if (index < 0 || index >= JOST_MAX_SCENES)
+            continue;
+
+        Scene* scene = new Scene (e->getStringAttribute (T("name"), T("Scene ") + String (index + 1)));
+        scene->getData ().fromBase64Encoding (e->getAllSubText ());
+        scene->remapHashes (oldHash, newHash);
+
+        setScene (index, scene);
+    }
+}
@@ -0,0 +1,175 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#ifndef __JUCETICE_JOSTSCENEMANAGER_HEADER__
+#define __JUCETICE_JOSTSCENEMANAGER_HEADER__
+
+#include "../Config.h"
+
+class Host;
+class HostFilterBase;
+
+
+//==============================================================================
+/**
+    A scene is a compact binary snapshot of the mixer and parameters state
+
+    The data is laid out as a flat sequence of native values, so it can be
+    applied from the audio thread by walking it, without any allocation:
+
+        int32 numPlugins
+        for each plugin:
+            int32 uniqueHash, float gain, int32 flags,
+            int32 numParameters, float parameters [numParameters]
+*/
+class Scene
+{
+public:
+
+    //==============================================================================
+    enum Flags
+    {
+        muted   = 1 << 0,
+        bypass  = 1 << 1
+    };
+
+    //==============================================================================
+    Scene (const String& name);
+    ~Scene ();
+
+    //==============================================================================
+    const String& getName () const                 { return name; }
+    void setName (const String& newName)           { name = newName; }
+
+    /** Returns the raw snapshot data */
+    const MemoryBlock& getData () const            { return data; }
+    MemoryBlock& getData ()                        { return data; }
+
+    //==============================================================================
+    /** Take a snapshot of all the plugins in the host */
+    void capture (Host* host);
+
+    /** Change the plugin hashes after a session reload */
+    void remapHashes (const Array<int>& oldHash, const Array<int>& newHash);
+
+private:
+
+    String name;
+    MemoryBlock data;
+};
+
+
+//==============================================================================
+/**
+    Holds the scenes of a host, and switch them while playing
+
+    A scene change requested from any thread (gui, midi program change or a
+    learned midi controller) is picked up atomically at the next block
+    boundary: gains, mutes and bypasses are applied at once (the host will
+    ramp the gains), while the parameters are ramped towards the scene values
+    over the configured ramp time.
+
+    @see Scene, Host
+*/
+class SceneManager : public MidiAutomatable
+{
+public:
+
+    //==============================================================================
+    SceneManager (HostFilterBase* owner, Host* host);
+    ~SceneManager ();
+
+    //==============================================================================
+    /** Store the current host state into a scene slot */
+    void storeScene (const int sceneIndex);
+
+    /** Ask to switch to a scene, it will happen at the next block */
+    void recallScene (const int sceneIndex);
+
+    /** Returns true if a scene slot has been stored */
+    bool hasScene (const int sceneIndex) const;
+
+    /** Returns the last recalled scene, or -1 */
+    int getCurrentScene () const                   { return currentScene; }
+
+    /** Remove all the scenes */
+    void clearScenes ();
+
+    //==============================================================================
+    /** Set the parameters ramp time in milliseconds, 0 means no ramp */
+    void setRampTime (const int milliseconds)      { rampMilliseconds = jmax (0, milliseconds); }
+    int getRampTime () const                       { return rampMilliseconds; }
+
+    /** Set the midi channel whose program changes select scenes, 0 disables it
+
+        Program changes on that channel are taken out of the incoming midi,
+        the ones on other channels still reach the plugins.
+    */
+    void setProgramChangeChannel (const int channel) { programChangeChannel = jlimit (0, 16, channel); }
+    int getProgramChangeChannel () const           { return programChangeChannel; }
+
+    //==============================================================================
+    /** Handle program changes in the incoming midi buffer */
+    void processIncomingMidi (MidiBuffer& midiMessages);
+
+    /** Apply pending scene changes and ramps, called at block start */
+    void processBlock (const double sampleRate, const int blockSize);
+
+    //==============================================================================
+    /** A learned midi controller value selects the scene */
+    bool handleMidiMessage (const MidiMessage& message);
+
+    //==============================================================================
+    void saveToXml (XmlElement* xml);
+    void loadFromXml (XmlElement* xml,
+                      const Array<int>& oldHash,
+                      const Array<int>& newHash);
+
+private:
+
+    //==============================================================================
+    void applyScene (Scene* scene, const float rampAmount, const bool applyMixer);
+    void setScene (const int sceneIndex, Scene* newScene);
+    bool isSceneProgramChange (const uint8* data, const int numBytes) const;
+
+    HostFilterBase* owner;
+    Host* host;
+
+    OwnedArray<Scene> scenes;
+    Scene* activeScene;
+
+    volatile int pendingScene;
+    int currentScene;
+    int rampMilliseconds;
+    int rampSamplesLeft;
+    int programChangeChannel;
+    MidiBuffer passedMessages;
+};
+
+
+#endif
@@ -0,0 +1,364 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#include "SessionAutosaver.h"
+#include "Host.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <sys/file.h>
+
+
+//==============================================================================
+bool SessionAutosaver::Snapshot::hasSameStates (const Snapshot& other) const
+{
+    if (markers != other.markers
+        || states.size () != other.states.size ())
+        return false;
+
+    for (int i = 0; i < states.size (); i++)
+    {
+        if (*states.getUnchecked (i) != *other.states.getUnchecked (i))
+            return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+SessionAutosaver::SessionAutosaver (Host* host_)
+  : Thread (T("SessionAutosaver")),
+    host (host_),
+    lockDescriptor (-1),
+    pendingSnapshot (0),
+    writing (false),
+    lastSnapshot (0)
+{
+    const File directory (JOST_AUTOSAVE_DIRECTORY);
+    directory.createDirectory ();
+
+    // a crashed process with our pid may have left its files, don't take them
+    const File lockFile (directory.getNonexistentChildFile (JOST_AUTOSAVE_PREFIX + String (getpid ()),
+                                                            JOST_AUTOSAVE_LOCK_EXTENSION));
+
+    autosaveFile = lockFile.withFileExtension (JOST_AUTOSAVE_EXTENSION);
+
+    lockDescriptor = open ((const char*) lockFile.getFullPathName (), O_RDWR | O_CREAT, 0644);
+    if (lockDescriptor >= 0
+        && flock (lockDescriptor, LOCK_EX | LOCK_NB) != 0)
+    {
+        close (lockDescriptor);
+        lockDescriptor = -1;
+    }
+
+    if (lockDescriptor < 0)
+        printf ("Cannot lock %s, autosave disabled\n", (const char*) lockFile.getFullPathName ());
+
+    startThread (1);
+}
+
+SessionAutosaver::~SessionAutosaver ()
+{
+    stopTimer ();
+    stopThread (10000);
+
+    deleteAndZero (pendingSnapshot);
+    deleteAndZero (lastSnapshot);
+
+    if (lockDescriptor >= 0)
+    {
+        // remove the files while still holding the lock, no one must think we crashed
+        discardAutosave (autosaveFile);
+
+        close (lockDescriptor);
+    }
+}
+
+//==============================================================================
+void SessionAutosaver::setInterval (const int seconds)
+{
+    if (seconds > 0 && lockDescriptor >= 0)
+        startTimer (seconds * 1000);
+    else
+        stopTimer ();
+}
+
+//==============================================================================
+const File SessionAutosaver::findRecoverableSession ()
+{
+    OwnedArray<File> files;
+    File (JOST_AUTOSAVE_DIRECTORY).findChildFiles (files,
+                                                   File::findFiles,
+                                                   false,
+                                                   String (JOST_AUTOSAVE_PREFIX) + T("*") + JOST_AUTOSAVE_EXTENSION);
+
+    File recoverableFile (File::nonexistent);
+
+    for (int i = 0; i < files.size (); i++)
+    {
+        const File& file = *files.getUnchecked (i);
+
+        if (! isLocked (file)
+            && (recoverableFile == File::nonexistent
+                || file.getLastModificationTime () > recoverableFile.getLastModificationTime ()))
+        {
+            recoverableFile = file;
+        }
+    }
+
+    return recoverableFile;
+}
+
+void SessionAutosaver::discardAutosave (const File& file)
+{
+    file.deleteFile ();
+    getLockFile (file).deleteFile ();
+}
+
+//==============================================================================
+const File SessionAutosaver::getLockFile (const File& autosaveFile)
+{
+    return autosaveFile.withFileExtension (JOST_AUTOSAVE_LOCK_EXTENSION);
+}
+
+bool SessionAutosaver::isLocked (const File& autosaveFile)
+{
+    // no lock file, nobody can be holding it
+    const int fd = open ((const char*) getLockFile (autosaveFile).getFullPathName (), O_RDWR);
+    if (fd < 0)
+        return false;
+
+    // flock is per open file, so this fails for our own autosave as well
+    const bool locked = flock (fd, LOCK_EX | LOCK_NB) != 0;
+
+    close (fd);
+    return locked;
+}
+
+//==============================================================================
+void SessionAutosaver::timerCallback ()
+{
+    {
+        // still writing the last one, try next time
+        const ScopedLock sl (lock);
+        if (pendingSnapshot != 0 || writing)
+            return;
+    }
+
+    DBG ("SessionAutosaver::timerCallback");
+
+    Snapshot* snapshot = new Snapshot ();
+
+#ifndef JUCE_DEBUG
+    try
+    {
+#endif
+        // only raw states are taken here, encoding them is left to the writer
+        snapshot->document = new XmlElement (JOST_PRESET_SESSIONTAG);
+
+        XmlElement* e = new XmlElement (JOST_PRESET_TRACKTAG);
+        host->saveToXml (e, true);
+        snapshot->document->addChildElement (e);
+
+        // never leave a plugin out of processing for an autosave: those which
+        // can't be captured while processing give the state they last had
+        for (int i = 0; i < host->getPluginsCount (); i++)
+        {
+            BasePlugin* plugin = host->getPluginByIndex (i);
+
+            MemoryBlock* state = new MemoryBlock ();
+            snapshot->states.add (state);
+            snapshot->markers.add (plugin->getDeferredStateMarker ());
+
+            if (plugin->canCaptureStateWhileProcessing ())
+                plugin->captureState (*state);
+            else
+                plugin->getLastKnownState (*state);
+        }
+#ifndef JUCE_DEBUG
+    }
+    catch (...)
+    {
+        printf ("Error autosaving session\n");
+
+        delete snapshot;
+        return;
+    }
+#endif
+
+    {
+        const ScopedLock sl (lock);
+        pendingSnapshot = snapshot;
+    }
+
+    notify ();
+}
+
+void SessionAutosaver::run ()
+{
+    while (! threadShouldExit ())
+    {
+        wait (-1);
+
+        Snapshot* snapshot;
+
+        {
+            const ScopedLock sl (lock);
+            snapshot = pendingSnapshot;
+            pendingSnapshot = 0;
+            writing = (snapshot != 0);
+        }
+
+        if (snapshot == 0)
+            continue;
+
+        const String comparedDocument (createComparedDocument (snapshot->document));
+
+        // nothing changed since the last autosave, it is still good
+        if (lastSnapshot != 0
+            && comparedDocument == lastDocument
+            && snapshot->hasSameStates (*lastSnapshot))
+        {
+            delete snapshot;
+        }
+        else
+        {
+            const String document (snapshot->document->createDocument (String::empty, true));
+
+            // autosaves are xml sessions, binary ones need the plugins while writing
+            String text;
+
+            int position = 0;
+            for (int i = 0; i < snapshot->markers.size (); i++)
+            {
+                const String& marker = snapshot->markers [i];
+                const int markerPosition = document.indexOf (position, marker);
+                if (markerPosition < 0)
+                    continue;
+
+                text << document.substring (position, markerPosition)
+                     << snapshot->states.getUnchecked (i)->toBase64Encoding ();
+
+                position = markerPosition + marker.length ();
+            }
+
+            text << document.substring (position);
+
+            if (writeFileSafely (autosaveFile, text))
+            {
+                delete lastSnapshot;
+                lastSnapshot = snapshot;
+                lastDocument = comparedDocument;
+            }
+            else
+            {
+                printf ("Error writing autosave to %s\n", (const char*) autosaveFile.getFullPathName ());
+
+                delete snapshot;
+            }
+        }
+
+        {
+            const ScopedLock sl (lock);
+            writing = false;
+        }
+    }
+}
+
+//==============================================================================
+const String SessionAutosaver::createComparedDocument (XmlElement* document)
+{
+    // the transport moves while playing, that alone doesn't make a new session
+    XmlElement* track = document->getChildByName (JOST_PRESET_TRACKTAG);
+    XmlElement* transport = (track != 0) ? track->getChildByName (T("transport")) : 0;
+
+    if (transport == 0)
+        return document->createDocument (String::empty, true);
+
+    const String position (transport->getStringAttribute (T("position")));
+    transport->removeAttribute (T("position"));
+
+    const String text (document->createDocument (String::empty, true));
+
+    transport->setAttribute (T("position"), position);
+    return text;
+}
+
+//==============================================================================
+bool SessionAutosaver::writeFileSafely (const File& file, const String& text)
+{
+    const File tempFile (file.getSiblingFile (file.getFileName () + T(".tmp")));
+
+    file.getParentDirectory ().createDirectory ();
+
+    const int fd = open ((const char*) tempFile.getFullPathName (),
+                         O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+
+    const char* data = (const char*) text;
+    int bytesLeft = text.length ();
+    bool written = true;
+
+    while (bytesLeft > 0 && written)
+    {
+        const ssize_t bytesWritten = write (fd, data, bytesLeft);
+        written = bytesWritten > 0;
+
+        if (written)
+        {
+            data += bytesWritten;
+            bytesLeft -= (int) bytesWritten;
+        }
+    }
+
+    // the data must be on disk before the rename makes it the autosave
+    written = fsync (fd) == 0 && written;
+    written = close (fd) == 0 && written;
+
+    if (written)
+        written = rename ((const char*) tempFile.getFullPathName (),
+                          (const char*) file.getFullPathName ()) == 0;
+
+    if (! written)
+    {
+        tempFile.deleteFile ();
+        return false;
+    }
+
+    // and so must the rename
+    const int dirFd = open ((const char*) file.getParentDirectory ().getFullPathName (), O_RDONLY);
+    if (dirFd >= 0)
+    {
+        fsync (dirFd);
+        close (dirFd);
+    }
+
+    return true;
+}
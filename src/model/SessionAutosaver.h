@@ -0,0 +1,128 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#ifndef __JUCETICE_JOSTSESSIONAUTOSAVER_HEADER__
+#define __JUCETICE_JOSTSESSIONAUTOSAVER_HEADER__
+
+#include "../Config.h"
+
+class Host;
+
+
+//==============================================================================
+/**
+    Saves the session in the background every now and then.
+
+    The session document and the plugin states are taken on the message
+    thread. Autosaving never leaves a plugin out of processing, so plugins
+    that can't be captured while processing give the state they had when
+    last captured or loaded instead. A low priority thread then compares
+    them with the last autosave, leaving out the transport position, and if
+    anything changed it encodes them, writes a temporary file, syncs it to
+    disk and renames it over the autosave, so a crash while writing never
+    leaves a broken autosave behind.
+
+    Every process has its own autosave, named after its pid, and holds a
+    lock on a file next to it while running. The autosave is removed when
+    jost is closed, so finding one whose lock is free at startup means the
+    process that wrote it didn't shut down properly.
+
+    @see HostFilterBase
+*/
+class SessionAutosaver : public Thread,
+                         public Timer
+{
+public:
+
+    //==============================================================================
+    /** Constructor */
+    SessionAutosaver (Host* host);
+
+    /** Destructor, it will wait for the autosave being written */
+    ~SessionAutosaver ();
+
+    //==============================================================================
+    /** Save the session every number of seconds, 0 to stop autosaving */
+    void setInterval (const int seconds);
+
+    //==============================================================================
+    /** Returns the file holding the autosaved session of this process */
+    const File getAutosaveFile () const                 { return autosaveFile; }
+
+    /** Returns the most recent autosave left by a process that didn't close,
+        or File::nonexistent if there is none */
+    static const File findRecoverableSession ();
+
+    /** Remove an autosaved session along with its lock file */
+    static void discardAutosave (const File& file);
+
+    //==============================================================================
+    /** @internal */
+    void timerCallback ();
+    /** @internal */
+    void run ();
+
+private:
+
+    //==============================================================================
+    /** The session as taken on the message thread */
+    class Snapshot
+    {
+    public:
+        Snapshot () : document (0) {}
+        ~Snapshot ()                                    { delete document; }
+
+        bool hasSameStates (const Snapshot& other) const;
+
+        XmlElement* document;
+        StringArray markers;
+        OwnedArray<MemoryBlock> states;
+    };
+
+    //==============================================================================
+    static const File getLockFile (const File& autosaveFile);
+    static bool isLocked (const File& autosaveFile);
+    static const String createComparedDocument (XmlElement* document);
+    static bool writeFileSafely (const File& file, const String& text);
+
+    Host* host;
+
+    File autosaveFile;
+    int lockDescriptor;
+
+    CriticalSection lock;
+    Snapshot* pendingSnapshot;
+    bool writing;
+
+    // only touched by the writer thread
+    Snapshot* lastSnapshot;
+    String lastDocument;
+};
+
+
+#endif // __JUCETICE_JOSTSESSIONAUTOSAVER_HEADER__
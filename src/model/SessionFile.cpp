@@ -0,0 +1,356 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#include "SessionFile.h"
+#include "Host.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define SESSION_MAGIC               0x4253584a // "JXSB"
+#define SESSION_VERSION             1
+#define SESSION_HEADER_SIZE         40
+#define SESSION_CHUNK_ENTRY_SIZE    32
+#define SESSION_CHUNK_COMPRESSED    1
+
+
+//==============================================================================
+/**
+    The header of a binary session, all values are little endian
+*/
+struct SessionHeader
+{
+    uint32 magic;
+    uint32 version;
+    uint32 headerSize;
+    uint32 numChunks;
+    uint64 tableOffset;
+    uint64 documentOffset;
+    uint64 documentSize;
+};
+
+/**
+    An entry of the chunks table, right after the blobs
+*/
+struct SessionChunkEntry
+{
+    uint64 offset;
+    uint64 storedSize;
+    uint64 size;
+    uint32 flags;
+    uint32 reserved;
+};
+
+
+//==============================================================================
+SessionChunks::SessionChunks (void* mapping_, const int64 mappingSize_,
+                              const int64 tableOffset_, const int numChunks_)
+  : mapping (mapping_),
+    mappingSize (mappingSize_),
+    tableOffset (tableOffset_),
+    numChunks (numChunks_)
+{
+}
+
+SessionChunks::~SessionChunks ()
+{
+    if (mapping != 0)
+        munmap (mapping, mappingSize);
+}
+
+bool SessionChunks::getChunk (const int index,
+                              const void*& data,
+                              int& size,
+                              MemoryBlock& inflated) const
+{
+    if (index < 0 || index >= numChunks)
+        return false;
+
+    const SessionChunkEntry* entry = (const SessionChunkEntry*)
+        ((const char*) mapping + tableOffset + index * SESSION_CHUNK_ENTRY_SIZE);
+
+    const int64 offset = (int64) swapIfBigEndian (entry->offset);
+    const int64 storedSize = (int64) swapIfBigEndian (entry->storedSize);
+    const int64 chunkSize = (int64) swapIfBigEndian (entry->size);
+
+    if (offset < SESSION_HEADER_SIZE
+        || storedSize < 0 || offset + storedSize > tableOffset
+        || chunkSize < 0 || chunkSize > 0x7fffffff)
+    {
+        printf ("Session chunk %d is broken \n", index);
+        return false;
+    }
+
+    const char* stored = (const char*) mapping + offset;
+
+    if ((swapIfBigEndian (entry->flags) & SESSION_CHUNK_COMPRESSED) == 0)
+    {
+        // right from the file
+        data = stored;
+        size = (int) storedSize;
+        return storedSize == chunkSize;
+    }
+
+    inflated.setSize ((int) chunkSize, false);
+
+    MemoryInputStream compressed (stored, (int) storedSize, false);
+    GZIPDecompressorInputStream in (&compressed, false, false, chunkSize);
+
+    if (in.read (inflated.getData (), (int) chunkSize) != (int) chunkSize)
+    {
+        printf ("Session chunk %d cannot be inflated \n", index);
+        return false;
+    }
+
+    data = inflated.getData ();
+    size = (int) chunkSize;
+    return true;
+}
+
+
+//==============================================================================
+static bool writePadding (OutputStream& out, const int64 start)
+{
+    static const char zeros [JOST_SESSION_CHUNK_ALIGNMENT] = { 0 };
+
+    const int64 misalignment = (out.getPosition () - start) % JOST_SESSION_CHUNK_ALIGNMENT;
+    if (misalignment == 0)
+        return true;
+
+    return out.write (zeros, (int) (JOST_SESSION_CHUNK_ALIGNMENT - misalignment));
+}
+
+static void writeHeader (OutputStream& out,
+                         const int numChunks,
+                         const int64 tableOffset,
+                         const int64 documentOffset,
+                         const int64 documentSize)
+{
+    out.writeInt (SESSION_MAGIC);
+    out.writeInt (SESSION_VERSION);
+    out.writeInt (SESSION_HEADER_SIZE);
+    out.writeInt (numChunks);
+    out.writeInt64 (tableOffset);
+    out.writeInt64 (documentOffset);
+    out.writeInt64 (documentSize);
+}
+
+static XmlElement* findDeferredData (XmlElement* track, const String& marker)
+{
+    forEachXmlChildElementWithTagName (*track, plugin, JOST_PRESET_PLUGINTAG)
+    {
+        XmlElement* state = plugin->getChildByName (T("state"));
+        XmlElement* data = state ? state->getChildByName (T("data")) : 0;
+
+        if (data && data->getAllSubText () == marker)
+            return data;
+    }
+
+    return 0;
+}
+
+//==============================================================================
+bool SessionFile::isBinarySession (const File& file)
+{
+    FileInputStream* in = file.createInputStream ();
+    if (in == 0)
+        return false;
+
+    const bool isBinary = in->readInt () == SESSION_MAGIC;
+
+    delete in;
+
+    return isBinary;
+}
+
+//==============================================================================
+bool SessionFile::writeToStream (OutputStream& out,
+                                 XmlElement& document,
+                                 Host* host,
+                                 const bool compressChunks)
+{
+    DBG ("SessionFile::writeToStream");
+
+    XmlElement* track = document.getChildByName (JOST_PRESET_TRACKTAG);
+    if (track == 0)
+        return false;
+
+    const int64 start = out.getPosition ();
+
+    // the header is written again at the end, when we know where things are
+    writeHeader (out, 0, 0, 0, 0);
+
+    Array<int64> offsets, storedSizes, sizes;
+    Array<int> flags;
+
+    for (int i = 0; i < host->getPluginsCount (); i++)
+    {
+        BasePlugin* plugin = host->getPluginByIndex (i);
+
+        XmlElement* data = findDeferredData (track, plugin->getDeferredStateMarker ());
+        if (data == 0)
+            continue;
+
+        // states are captured one at a time, like in xml sessions
+        MemoryBlock state;
+        plugin->captureState (state);
+
+        const char* stored = (const char*) state.getData ();
+        int storedSize = state.getSize ();
+        int chunkFlags = 0;
+
+        MemoryOutputStream compressed;
+        if (compressChunks && state.getSize () > 0)
+        {
+            GZIPCompressorOutputStream gzip (&compressed);
+            gzip.write (state.getData (), state.getSize ());
+            gzip.flush ();
+
+            if (compressed.getDataSize () < state.getSize ())
+            {
+                stored = compressed.getData ();
+                storedSize = compressed.getDataSize ();
+                chunkFlags |= SESSION_CHUNK_COMPRESSED;
+            }
+        }
+
+        if (! writePadding (out, start))
+            return false;
+
+        data->deleteAllTextElements ();
+        data->setAttribute (T("chunk"), offsets.size ());
+
+        offsets.add (out.getPosition () - start);
+        storedSizes.add (storedSize);
+        sizes.add (state.getSize ());
+        flags.add (chunkFlags);
+
+        if (storedSize > 0 && ! out.write (stored, storedSize))
+            return false;
+    }
+
+    // table of the chunks
+    if (! writePadding (out, start))
+        return false;
+
+    const int64 tableOffset = out.getPosition () - start;
+
+    for (int i = 0; i < offsets.size (); i++)
+    {
+        out.writeInt64 (offsets [i]);
+        out.writeInt64 (storedSizes [i]);
+        out.writeInt64 (sizes [i]);
+        out.writeInt (flags [i]);
+        out.writeInt (0);
+    }
+
+    // and the document, without the states
+    const int64 documentOffset = out.getPosition () - start;
+    const String text (document.createDocument (String::empty, true));
+
+    if (! out.write ((const char*) text, text.length ()))
+        return false;
+
+    const int64 end = out.getPosition ();
+
+    if (! out.setPosition (start))
+        return false;
+
+    writeHeader (out, offsets.size (), tableOffset, documentOffset, text.length ());
+
+    return out.setPosition (end);
+}
+
+//==============================================================================
+XmlElement* SessionFile::readFromFile (const File& file,
+                                       SessionChunksPtr& chunks)
+{
+    DBG ("SessionFile::readFromFile");
+
+    chunks = 0;
+
+    const int fd = open ((const char*) file.getFullPathName (), O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    struct stat info;
+    void* mapping = MAP_FAILED;
+
+    if (fstat (fd, &info) == 0 && info.st_size >= SESSION_HEADER_SIZE)
+        mapping = mmap (0, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+    // the mapping stays valid without the descriptor, and being private and
+    // writable, plugins scribbling on their chunk never touch the file
+    close (fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        printf ("Cannot map session %s \n", (const char*) file.getFullPathName ());
+        return 0;
+    }
+
+    const int64 mappingSize = info.st_size;
+    const SessionHeader* header = (const SessionHeader*) mapping;
+
+    const int numChunks = (int) swapIfBigEndian (header->numChunks);
+    const int64 tableOffset = (int64) swapIfBigEndian (header->tableOffset);
+    const int64 documentOffset = (int64) swapIfBigEndian (header->documentOffset);
+    const int64 documentSize = (int64) swapIfBigEndian (header->documentSize);
+
+    if (swapIfBigEndian (header->magic) != SESSION_MAGIC
+        || swapIfBigEndian (header->version) > SESSION_VERSION
+        || swapIfBigEndian (header->headerSize) < SESSION_HEADER_SIZE
+        || numChunks < 0
+        || tableOffset < SESSION_HEADER_SIZE
+        || tableOffset + (int64) numChunks * SESSION_CHUNK_ENTRY_SIZE > documentOffset
+        || documentSize < 0 || documentSize > 0x7fffffff
+        || documentOffset + documentSize > mappingSize)
+    {
+        printf ("Session %s is not a valid binary session \n", (const char*) file.getFullPathName ());
+
+        munmap (mapping, mappingSize);
+        return 0;
+    }
+
+    // from now on the chunks own the mapping
+    chunks = new SessionChunks (mapping, mappingSize, tableOffset, numChunks);
+
+    XmlDocument document (String ((const char*) mapping + documentOffset, (int) documentSize));
+    XmlElement* xml = document.getDocumentElement ();
+
+    if (xml == 0)
+    {
+        printf ("Error parsing session %s \n", (const char*) file.getFullPathName ());
+        chunks = 0;
+    }
+
+    return xml;
+}
@@ -0,0 +1,144 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#ifndef __JUCETICE_JOSTSESSIONFILE_HEADER__
+#define __JUCETICE_JOSTSESSIONFILE_HEADER__
+
+#include "../Config.h"
+
+class Host;
+
+
+//==============================================================================
+/**
+    The plugin states of a binary session, mapped in memory.
+
+    Plain chunks are handed to the plugins straight from the mapping, without
+    copying them. The mapping is released when the last reference to it goes,
+    so plugins still loading or placeholders can keep it around.
+
+    @see SessionFile
+*/
+class SessionChunks : public ReferenceCountedObject
+{
+public:
+
+    //==============================================================================
+    /** Destructor, it will unmap the session file */
+    ~SessionChunks ();
+
+    //==============================================================================
+    /** Returns the number of plugin states in the session */
+    int getNumChunks () const                           { return numChunks; }
+
+    /** Get a plugin state
+
+        @param index        the index of the chunk, as found in the session
+        @param data         set to the start of the state
+        @param size         set to the size of the state
+        @param inflated     compressed chunks are inflated here, and data will
+                            point to it, so keep it until the state is used
+        @returns            false if the chunk is missing or broken
+    */
+    bool getChunk (const int index,
+                   const void*& data,
+                   int& size,
+                   MemoryBlock& inflated) const;
+
+private:
+
+    friend class SessionFile;
+
+    SessionChunks (void* mapping, const int64 mappingSize,
+                   const int64 tableOffset, const int numChunks);
+
+    void* mapping;
+    int64 mappingSize;
+    int64 tableOffset;
+    int numChunks;
+};
+
+typedef ReferenceCountedObjectPtr<SessionChunks> SessionChunksPtr;
+
+
+//==============================================================================
+/**
+    Binary session files.
+
+    A binary session starts with a header, followed by the plugin states as
+    raw blobs aligned to JOST_SESSION_CHUNK_ALIGNMENT, optionally compressed
+    one by one, then the table of the blobs and the session document. The
+    document holds the transport, scenes, plugins and wires as the xml
+    sessions do, but the data element of every plugin state refers to a
+    blob instead of holding it base64 encoded.
+
+    Xml sessions are still read and written, they are the format used to
+    exchange sessions.
+
+    @see SessionChunks, HostFilterBase::saveSessionToFile
+*/
+class SessionFile
+{
+public:
+
+    //==============================================================================
+    /** Returns true if the file is a binary session */
+    static bool isBinarySession (const File& file);
+
+    //==============================================================================
+    /** Write a binary session to a stream
+
+        The document should come from Host::saveToXml with deferred plugin
+        states: the state of each plugin is captured when it is written.
+
+        @param out              a stream that can be positioned, like a file
+        @param document         the session document, its data elements are
+                                changed to refer to the blobs
+        @param host             the host holding the plugins of the document
+        @param compressChunks   compress the states, when it makes them smaller
+        @returns                true if everything has been written
+    */
+    static bool writeToStream (OutputStream& out,
+                               XmlElement& document,
+                               Host* host,
+                               const bool compressChunks);
+
+    /** Map a binary session file and read its document
+
+        @param file             the session file
+        @param chunks           set to the plugin states of the session
+        @returns                the session document, or 0 if the file is not
+                                a valid binary session. The caller will have
+                                to delete it
+    */
+    static XmlElement* readFromFile (const File& file,
+                                     SessionChunksPtr& chunks);
+};
+
+
+#endif // __JUCETICE_JOSTSESSIONFILE_HEADER__
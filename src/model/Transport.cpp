@@ -27,6 +27,7 @@
 */
 
 #include "Transport.h"
+#include "ExternalTimeSignature.h"
 #include "../HostFilterBase.h"
 
 
@@ -48,19 +49,45 @@ Transport::Transport (HostFilterBase* owner_)
     doStopRecord (false),
     doRewind (false),
     doAllNotesOff (false),
+    followPlayHead (false),
+    playHeadChanged (false),
+    preRollBars (0),
+    punchInFrame (0),
+    punchArmed (false),
+    metronome (false),
+    sendMidiClock (false),
+    sendMidiTimecode (false),
+    midiTimecodeType (MidiMessage::fps25),
+    midiClockWasPlaying (false),
+    nextMidiClockPosition (0),
+    midiBeatPosition (0),
+    nextMidiClockFrame (0.0),
+    nextQuarterFrameFrame (0.0),
+    quarterFrameIndex (0),
+    timecodeHours (0),
+    timecodeMinutes (0),
+    timecodeSeconds (0),
+    timecodeFrames (0),
     externalTransport (0)
 {
     DBG ("Transport::Transport");
 
 #if JOST_USE_VST
     // zero time info
-    zerostruct (timeInfo);
+    zerostruct (timeInfoSnapshots [0]);
+    zerostruct (timeInfoSnapshots [1]);
+    currentTimeInfo = 0;
+    nextTimeInfoPosition = 0;
 #endif
+
+    startTimer (JOST_TRANSPORT_NOTIFY_INTERVAL);
 }
 
 Transport::~Transport ()
 {
     DBG ("Transport::~Transport");
+
+    stopTimer ();
 }
 
 //==============================================================================
@@ -85,7 +112,7 @@ void Transport::play ()
 
     if (! playing)
     {
-        playing = true;
+        startPlaying ();
 
         sendChangeMessage (this);
 
@@ -107,12 +134,9 @@ void Transport::stop ()
 
     if (playing)
     {
-        doAllNotesOff = true;
-        playing = false;
+        stopPlaying ();
 
-        if (recording)
-            doStopRecord = true;
-        else
+        if (! recording)
             sendChangeMessage (this);
 
         // TODO - we should make this as change listener !
@@ -127,6 +151,35 @@ void Transport::stop ()
     }
 }
 
+void Transport::startPlaying ()
+{
+    if (recording)
+    {
+        // punch in where we are, after playing the pre-roll
+        punchInFrame = sequencePositionCounter;
+
+        if (preRollBars > 0)
+        {
+            recording = false;
+            punchArmed = true;
+
+            sequencePositionCounter = punchInFrame - preRollBars * divDenominator * framesPerBeat;
+        }
+    }
+
+    playing = true;
+}
+
+void Transport::stopPlaying ()
+{
+    doAllNotesOff = true;
+    playing = false;
+    punchArmed = false;
+
+    if (recording)
+        doStopRecord = true;
+}
+
 void Transport::record ()
 {
     DBG ("Transport::record");
@@ -160,6 +213,7 @@ void Transport::rewind ()
         if (recording)
             doStopRecord = true;
 
+        punchArmed = false;
         doAllNotesOff = true;
         doRewind = true;
     }
@@ -195,8 +249,11 @@ void Transport::prepareToPlay (double sampleRate_, int samplesPerBlock_)
 {
     DBG ("Transport::prepareToPlay");
 
+    Config* config = Config::getInstance ();
+    followPlayHead = config->externalTempoSync && ! config->externalTempoMaster;
+
     // TODO - we should make this as change listener !
-    if (externalTransport)
+    if (externalTransport && ! followPlayHead)
     {
         externalTransport->grabTransport (false);
         externalTransport->seekTransportToFrame (0);
@@ -213,29 +270,10 @@ void Transport::prepareToPlay (double sampleRate_, int samplesPerBlock_)
 
 #if JOST_USE_VST
     // prepare vsttimeinfo
-    timeInfo.samplePos = 0.0;
-    timeInfo.sampleRate = sampleRate;
-    timeInfo.nanoSeconds = 0.0;
-    timeInfo.ppqPos = 0.0;
-    timeInfo.tempo = bpmTempo;                        // in bpm
-    timeInfo.barStartPos = 0;                         // last bar start, in 1 ppq
-    timeInfo.cycleStartPos = 0;                       // 1 ppq
-    timeInfo.cycleEndPos = 0;                         // 1 ppq
-    timeInfo.barStartPos = 0;                         // last bar start, in 1 ppq
-    timeInfo.barStartPos = 0;                         // last bar start, in 1 ppq
-    timeInfo.timeSigNumerator = divDenominator;       // time signature numerator
-    timeInfo.timeSigDenominator = divDenominator;     // time signature denominator
-    timeInfo.smpteOffset = 0;
-    timeInfo.smpteFrameRate = 1;
-    timeInfo.samplesToNextClock = 0;
-    timeInfo.flags = 0 | kVstTransportPlaying
-                       | kVstNanosValid
-                       | kVstTransportChanged
-                       | kVstPpqPosValid
-                       | kVstTempoValid
-                       | kVstTimeSigValid
-                       | kVstClockValid;
-                       // kVstBarsValid | kVstCyclePosValid | kVstTimeSigValid | kVstSmpteValid | kVstClockValid
+    zerostruct (timeInfoSnapshots [0]);
+    zerostruct (timeInfoSnapshots [1]);
+    nextTimeInfoPosition = -1;
+    updateTimeInfo (samplesPerBlock_);
 #endif
 }
 
@@ -253,24 +291,8 @@ void Transport::releaseResources()
 
 void Transport::processBlock (const int blockSize)
 {
-#if JOST_USE_VST
-    timeInfo.tempo = bpmTempo;
-    timeInfo.nanoSeconds = (double) Time::getMillisecondCounterHiRes () * 1000000.0;
-#endif
-
     if (playing)
     {
-#if JOST_USE_VST
-        static double smpteDiv[] = { 24.f, 25.f, 24.f, 30.f, 29.97f, 30.f };
-
-        const double ppqPos = sequencePositionCounter / timeInfo.sampleRate;
-        timeInfo.ppqPos = ppqPos * timeInfo.tempo / 60.0;
-        timeInfo.smpteOffset = (long) ((ppqPos - floor (ppqPos))
-                                       * smpteDiv [timeInfo.smpteFrameRate] * 80.0);
-        timeInfo.flags |= kVstTransportPlaying;
-        timeInfo.flags &= ~kVstTransportChanged;
-#endif
-
         // we should update rewind button
         if (sequencePositionCounter == leftLocator)
             sendChangeMessage (this);
@@ -284,16 +306,14 @@ void Transport::processBlock (const int blockSize)
             if (looping)
             {
                 sequencePositionCounter = leftLocator;
+
+                // record the whole loop in the next passes
+                punchInFrame = jmin (punchInFrame, leftLocator);
             }
             else
             {
                 playing = false;
                 sendChangeMessage (this);
-
-#if JOST_USE_VST
-                timeInfo.flags &= ~kVstTransportPlaying;
-                timeInfo.flags |= kVstTransportChanged;
-#endif
             }
         }
     }
@@ -309,17 +329,426 @@ void Transport::processBlock (const int blockSize)
         doRewind = false;
     }
 
+    // arm recording at the start of the block containing the punch in
+    if (punchArmed
+        && playing
+        && sequencePositionCounter + blockSize > punchInFrame)
+    {
+        punchArmed = false;
+        recording = true;
+        sendChangeMessage (this);
+    }
+
+#if JOST_USE_VST
+    updateTimeInfo (blockSize);
+#endif
+}
+
 #if JOST_USE_VST
-    timeInfo.samplePos = (float) sequencePositionCounter;
+//==============================================================================
+void Transport::updateTimeInfo (const int blockSize)
+{
+    const VstTimeInfo& last = timeInfoSnapshots [currentTimeInfo];
+    VstTimeInfo& info = timeInfoSnapshots [1 - currentTimeInfo];
+
+    const double beatFrames = jmax (1, framesPerBeat);
+    const double beatsPerBar = divDenominator;
+
+    info.samplePos = sequencePositionCounter;
+    info.sampleRate = sampleRate;
+    info.nanoSeconds = (double) Time::getMillisecondCounterHiRes () * 1000000.0;
+    info.tempo = bpmTempo;
+
+    // musical position, in quarter notes
+    info.ppqPos = sequencePositionCounter / beatFrames;
+    info.barStartPos = floor (info.ppqPos / beatsPerBar) * beatsPerBar;
+    info.cycleStartPos = leftLocator / beatFrames;
+    info.cycleEndPos = sequenceDurationFrames / beatFrames;
+    info.timeSigNumerator = divDenominator;
+    info.timeSigDenominator = 4;
+
+    // smpte position, in 1/80 of frame
+    static const double smpteRates[] = { 24.0, 25.0, 29.97, 30.0 };
+    static const int smpteTypes[] = { kVstSmpte24fps, kVstSmpte25fps, kVstSmpte2997dfps, kVstSmpte30fps };
+    const int timecodeType = jlimit (0, 3, midiTimecodeType);
+
+    info.smpteFrameRate = smpteTypes [timecodeType];
+    info.smpteOffset = (VstInt32) (sequencePositionCounter / (double) sampleRate
+                                   * smpteRates [timecodeType] * 80.0);
+
+    // nearest midi clock, can be negative
+    const double framesPerClock = beatFrames / 24.0;
+    const double clockOffset = fmod ((double) sequencePositionCounter, framesPerClock);
+    info.samplesToNextClock = (VstInt32) ((clockOffset < framesPerClock * 0.5) ? -clockOffset
+                                                                                : framesPerClock - clockOffset);
+
+    info.flags = kVstNanosValid
+                 | kVstPpqPosValid
+                 | kVstTempoValid
+                 | kVstBarsValid
+                 | kVstCyclePosValid
+                 | kVstTimeSigValid
+                 | kVstSmpteValid
+                 | kVstClockValid;
+
+    if (playing)    info.flags |= kVstTransportPlaying;
+    if (looping)    info.flags |= kVstTransportCycleActive;
+    if (recording)  info.flags |= kVstTransportRecording;
+
+    // flag state changes and locates
+    const int stateFlags = kVstTransportPlaying | kVstTransportCycleActive | kVstTransportRecording;
+    if ((info.flags & stateFlags) != (last.flags & stateFlags)
+        || sequencePositionCounter != nextTimeInfoPosition)
+    {
+        info.flags |= kVstTransportChanged;
+    }
+
+    nextTimeInfoPosition = sequencePositionCounter + (playing ? blockSize : 0);
+
+    // publish the new snapshot
+    currentTimeInfo = 1 - currentTimeInfo;
+}
+
+void Transport::getTimeInfo (VstTimeInfo& destination, const int requestedFlags) const
+{
+    const VstTimeInfo& info = timeInfoSnapshots [currentTimeInfo];
+
+    // these are always valid
+    destination.samplePos = info.samplePos;
+    destination.sampleRate = info.sampleRate;
+
+    int validFlags = 0;
+
+    if (requestedFlags & kVstNanosValid)
+    {
+        destination.nanoSeconds = info.nanoSeconds;
+        validFlags |= kVstNanosValid;
+    }
+
+    if (requestedFlags & (kVstPpqPosValid | kVstBarsValid))
+    {
+        destination.ppqPos = info.ppqPos;
+        validFlags |= kVstPpqPosValid;
+    }
+
+    if (requestedFlags & kVstTempoValid)
+    {
+        destination.tempo = info.tempo;
+        validFlags |= kVstTempoValid;
+    }
+
+    if (requestedFlags & kVstBarsValid)
+    {
+        destination.barStartPos = info.barStartPos;
+        validFlags |= kVstBarsValid;
+    }
+
+    if (requestedFlags & kVstCyclePosValid)
+    {
+        destination.cycleStartPos = info.cycleStartPos;
+        destination.cycleEndPos = info.cycleEndPos;
+        validFlags |= kVstCyclePosValid;
+    }
+
+    if (requestedFlags & (kVstTimeSigValid | kVstBarsValid))
+    {
+        destination.timeSigNumerator = info.timeSigNumerator;
+        destination.timeSigDenominator = info.timeSigDenominator;
+        validFlags |= kVstTimeSigValid;
+    }
+
+    if (requestedFlags & kVstSmpteValid)
+    {
+        destination.smpteOffset = info.smpteOffset;
+        destination.smpteFrameRate = info.smpteFrameRate;
+        validFlags |= kVstSmpteValid;
+    }
+
+    if (requestedFlags & kVstClockValid)
+    {
+        destination.samplesToNextClock = info.samplesToNextClock;
+        validFlags |= kVstClockValid;
+    }
+
+    destination.flags = (info.flags & (kVstTransportChanged
+                                       | kVstTransportPlaying
+                                       | kVstTransportCycleActive
+                                       | kVstTransportRecording))
+                        | validFlags;
+}
 #endif
+
+//==============================================================================
+static double getTimecodeFramesPerSecond (const int timecodeType)
+{
+    switch (timecodeType)
+    {
+    case MidiMessage::fps24:        return 24.0;
+    case MidiMessage::fps25:        return 25.0;
+    case MidiMessage::fps30drop:    return 29.97;
+    default:                        return 30.0;
+    }
+}
+
+void Transport::processMidiClock (const int blockSize)
+{
+    midiClockBuffer.clear ();
+
+    if (! (sendMidiClock || sendMidiTimecode) || framesPerBeat <= 0)
+    {
+        midiClockWasPlaying = playing;
+        nextMidiClockPosition = sequencePositionCounter;
+        return;
+    }
+
+    // a locate happened if we are not where we left at the last block
+    // (rewind, loop wrap or position change from the gui)
+    const bool hasLocated = (sequencePositionCounter != nextMidiClockPosition);
+
+    if (playing)
+    {
+        if (! midiClockWasPlaying || hasLocated)
+        {
+            resetMidiClockCounters ();
+
+            if (sendMidiClock)
+            {
+                if (! midiClockWasPlaying && sequencePositionCounter == 0)
+                {
+                    midiClockBuffer.addEvent (MidiMessage::midiStart (), 0);
+                }
+                else
+                {
+                    midiClockBuffer.addEvent (MidiMessage::songPositionPointer (midiBeatPosition), 0);
+
+                    if (! midiClockWasPlaying)
+                        midiClockBuffer.addEvent (MidiMessage::midiContinue (), 0);
+                }
+            }
+        }
+
+        const double blockStart = sequencePositionCounter;
+        const double blockEnd = blockStart + blockSize;
+
+        // 24 clocks per quarter note
+        if (sendMidiClock)
+        {
+            const double framesPerClock = framesPerBeat / 24.0;
+
+            while (nextMidiClockFrame < blockEnd)
+            {
+                const int offset = jlimit (0, blockSize - 1, (int) (nextMidiClockFrame - blockStart));
+
+                midiClockBuffer.addEvent (MidiMessage::midiClock (), offset);
+
+                nextMidiClockFrame += framesPerClock;
+            }
+        }
+
+        // 4 quarter frames per timecode frame, a full time every 8 pieces
+        if (sendMidiTimecode)
+        {
+            const double framesPerQuarterFrame =
+                sampleRate / (getTimecodeFramesPerSecond (midiTimecodeType) * 4.0);
+
+            while (nextQuarterFrameFrame < blockEnd)
+            {
+                // there is no timecode before the start, while in pre-roll
+                if (quarterFrameIndex == 0 && nextQuarterFrameFrame < -0.5)
+                {
+                    nextQuarterFrameFrame += framesPerQuarterFrame * 8.0;
+                    continue;
+                }
+
+                const int offset = jlimit (0, blockSize - 1, (int) (nextQuarterFrameFrame - blockStart));
+
+                if (quarterFrameIndex == 0)
+                    updateMidiTimecode (nextQuarterFrameFrame);
+
+                int value = 0;
+                switch (quarterFrameIndex)
+                {
+                case 0: value = timecodeFrames & 0x0f; break;
+                case 1: value = (timecodeFrames >> 4) & 0x01; break;
+                case 2: value = timecodeSeconds & 0x0f; break;
+                case 3: value = (timecodeSeconds >> 4) & 0x03; break;
+                case 4: value = timecodeMinutes & 0x0f; break;
+                case 5: value = (timecodeMinutes >> 4) & 0x03; break;
+                case 6: value = timecodeHours & 0x0f; break;
+                case 7: value = ((timecodeHours >> 4) & 0x01) | (midiTimecodeType << 1); break;
+                }
+
+                midiClockBuffer.addEvent (MidiMessage::quarterFrame (quarterFrameIndex, value), offset);
+
+                quarterFrameIndex = (quarterFrameIndex + 1) & 7;
+                nextQuarterFrameFrame += framesPerQuarterFrame;
+            }
+        }
+
+        nextMidiClockPosition = sequencePositionCounter + blockSize;
+    }
+    else
+    {
+        if (sendMidiClock)
+        {
+            if (midiClockWasPlaying)
+            {
+                midiClockBuffer.addEvent (MidiMessage::midiStop (), 0);
+            }
+            else if (hasLocated)
+            {
+                resetMidiClockCounters ();
+                midiClockBuffer.addEvent (MidiMessage::songPositionPointer (midiBeatPosition), 0);
+            }
+        }
+
+        nextMidiClockPosition = sequencePositionCounter;
+    }
+
+    midiClockWasPlaying = playing;
+}
+
+void Transport::resetMidiClockCounters ()
+{
+    // song position pointer counts in sixteenths (6 clocks), and the slave
+    // will play that position at the next clock it receives: so we round up
+    // to the next sixteenth and restart clocking from there
+    const double framesPerSixteenth = framesPerBeat / 4.0;
+
+    midiBeatPosition = jlimit (0, 16383, (int) ceil (sequencePositionCounter / framesPerSixteenth));
+    nextMidiClockFrame = midiBeatPosition * framesPerSixteenth;
+
+    // restart timecode at the next even frame boundary
+    const double framesPerTwoFrames =
+        sampleRate * 2.0 / getTimecodeFramesPerSecond (midiTimecodeType);
+
+    nextQuarterFrameFrame = ceil (sequencePositionCounter / framesPerTwoFrames) * framesPerTwoFrames;
+    quarterFrameIndex = 0;
+}
+
+void Transport::updateMidiTimecode (const double framePosition)
+{
+    const double seconds = jmax (0.0, framePosition / sampleRate);
+
+    // frames really elapsed, and the frames counted in a timecode second
+    int frameNumber = (int) (seconds * getTimecodeFramesPerSecond (midiTimecodeType) + 0.0001);
+    const int framesPerSecond = (midiTimecodeType == MidiMessage::fps24) ? 24
+                              : (midiTimecodeType == MidiMessage::fps25) ? 25 : 30;
+
+    // drop frame skips frames 0 and 1 every minute, but every tenth one
+    if (midiTimecodeType == MidiMessage::fps30drop)
+    {
+        const int framesPerTenMinutes = 17982;
+        const int framesPerMinute = 1798;
+
+        const int tenMinutes = frameNumber / framesPerTenMinutes;
+        const int remainder = frameNumber % framesPerTenMinutes;
+
+        frameNumber += 18 * tenMinutes;
+        if (remainder > 1)
+            frameNumber += 2 * ((remainder - 2) / framesPerMinute);
+    }
+
+    timecodeFrames = frameNumber % framesPerSecond;
+    timecodeSeconds = (frameNumber / framesPerSecond) % 60;
+    timecodeMinutes = (frameNumber / (framesPerSecond * 60)) % 60;
+    timecodeHours = (frameNumber / (framesPerSecond * 3600)) % 24;
+}
+
+//==============================================================================
+void Transport::setPreRollBars (const int numBars)
+{
+    preRollBars = jmax (0, numBars);
+
+    sendChangeMessage (this);
+}
+
+void Transport::setMetronome (const bool shouldClick)
+{
+    metronome = shouldClick;
+
+    sendChangeMessage (this);
+}
+
+//==============================================================================
+void Transport::setMidiClockMaster (const bool shouldSendClock)
+{
+    sendMidiClock = shouldSendClock;
+
+    sendChangeMessage (this);
+}
+
+void Transport::setMidiTimecodeMaster (const bool shouldSendTimecode)
+{
+    sendMidiTimecode = shouldSendTimecode;
+
+    sendChangeMessage (this);
+}
+
+void Transport::setMidiTimecodeType (const int newTimecodeType)
+{
+    midiTimecodeType = jlimit ((int) MidiMessage::fps24, (int) MidiMessage::fps30, newTimecodeType);
+
+    sendChangeMessage (this);
 }
 
 //==============================================================================
 void Transport::processAudioPlayHead (AudioPlayHead* head)
 {
     AudioPlayHead::CurrentPositionInfo info;
-    if (head->getCurrentPosition (info))
+    if (head && followPlayHead && head->getCurrentPosition (info))
     {
+        // follow tempo and time signature
+        const int newTempo = roundDoubleToInt (info.bpm);
+        const int newBeatsPerBar = info.timeSigNumerator;
+
+        if ((newTempo > 0 && newTempo != bpmTempo)
+            || (newBeatsPerBar > 0 && newBeatsPerBar != divDenominator))
+        {
+            // this is the audio thread, listeners will know from the timer
+            updateTimeSignature (newTempo > 0 ? newTempo : bpmTempo,
+                                 numBars,
+                                 newBeatsPerBar > 0 ? newBeatsPerBar : divDenominator);
+
+            playHeadChanged = true;
+        }
+
+        // follow frame position, wrapping it inside our loop
+        int framePosition = roundDoubleToInt (info.timeInSeconds * sampleRate);
+
+        if (looping
+            && framePosition >= sequenceDurationFrames
+            && sequenceDurationFrames > leftLocator)
+        {
+            framePosition = leftLocator + (framePosition - leftLocator) % (sequenceDurationFrames - leftLocator);
+        }
+
+        if (framePosition != sequencePositionCounter)
+        {
+            // a locate happened, not the usual block advance
+            if (playing)
+                doAllNotesOff = true;
+
+            sequencePositionCounter = framePosition;
+            doRewind = false;
+        }
+
+        // follow play state, this is the audio thread too: the external
+        // transport is where it comes from, and listeners know from the timer
+        if (info.isPlaying && ! playing)
+        {
+            if (looping || sequencePositionCounter < sequenceDurationFrames)
+            {
+                startPlaying ();
+                playHeadChanged = true;
+            }
+        }
+        else if (! info.isPlaying && playing)
+        {
+            stopPlaying ();
+            playHeadChanged = true;
+        }
+
 /*
         std::cout << "bpm " << info.bpm << std::endl;
         std::cout << "timeSigNumerator " << info.timeSigNumerator << std::endl;
@@ -399,6 +828,25 @@ void Transport::processIncomingMidi (MidiBuffer& midiMessages)
 void Transport::setTimeSignature (const int bpmTempo_,
                                   const int barsCount_,
                                   const int timeDenominator_)
+{
+    updateTimeSignature (bpmTempo_, barsCount_, timeDenominator_);
+
+    sendChangeMessage (this);
+
+    // TODO - we should make this as change listener !
+    if (externalTransport)
+    {
+        externalTransport->setTempo (bpmTempo);
+
+        ExternalTimeSignature* timeSignature = dynamic_cast <ExternalTimeSignature*> (externalTransport);
+        if (timeSignature)
+            timeSignature->setTimeSignature (divDenominator, 4);
+    }
+}
+
+void Transport::updateTimeSignature (const int bpmTempo_,
+                                     const int barsCount_,
+                                     const int timeDenominator_)
 {
     bpmTempo = bpmTempo_;
     numBars = barsCount_;
@@ -414,12 +862,16 @@ void Transport::setTimeSignature (const int bpmTempo_,
 
     if (sequencePositionCounter >= sequenceDurationFrames)
         doRewind = true;
+}
 
-    sendChangeMessage (this);
+void Transport::timerCallback ()
+{
+    if (playHeadChanged)
+    {
+        playHeadChanged = false;
 
-    // TODO - we should make this as change listener !
-    if (externalTransport)
-        externalTransport->setTempo (bpmTempo);
+        sendChangeMessage (this);
+    }
 }
 
 void Transport::setLeftLocator (const float beatNumber)
@@ -470,6 +922,11 @@ void Transport::saveToXml (XmlElement* xml)
     xml->setAttribute (T("llocator"), getLeftLocator());
     xml->setAttribute (T("rlocator"), getRightLocator());
     xml->setAttribute (T("looping"), looping);
+    xml->setAttribute (T("preroll"), preRollBars);
+    xml->setAttribute (T("metronome"), metronome);
+    xml->setAttribute (T("midiclock"), sendMidiClock);
+    xml->setAttribute (T("mtc"), sendMidiTimecode);
+    xml->setAttribute (T("mtctype"), midiTimecodeType);
 }
 
 void Transport::loadFromXml (XmlElement* xml)
@@ -486,6 +943,12 @@ void Transport::loadFromXml (XmlElement* xml)
     setRightLocator (xml->getDoubleAttribute (T("rlocator"), 1.0));
     looping = xml->getIntAttribute (T("looping"), 1) == 1;
 
+    preRollBars = jmax (0, xml->getIntAttribute (T("preroll"), 0));
+    metronome = xml->getIntAttribute (T("metronome"), 0) == 1;
+    sendMidiClock = xml->getIntAttribute (T("midiclock"), 0) == 1;
+    sendMidiTimecode = xml->getIntAttribute (T("mtc"), 0) == 1;
+    setMidiTimecodeType (xml->getIntAttribute (T("mtctype"), MidiMessage::fps25));
+
     sendChangeMessage (this);
 }
 
@@ -48,7 +48,8 @@
     Also, it is used in the HostCallback to provide VstTimeInfo to vst plugins
     that ask for it.
 */
-class Transport : public ChangeBroadcaster
+class Transport : public ChangeBroadcaster,
+                  public Timer
 {
 public:
 
@@ -61,13 +62,21 @@ public:
 
     //==============================================================================
 #if JOST_USE_VST
-    /** Returns the global time info for the whole host
+    /** Returns the time info snapshot for the current block
 
-        This is shared for all plugins calling it: but if one plugin mess it up
-        due to the lack of "constness", the next plugins will receive a messed
-        up structure (so it is dangerous to a have only one instance).
+        This is rebuilt once per block at the end of processBlock, into the
+        back buffer of a pair, so it never changes while plugins process.
+        Don't hand this pointer to plugins directly, they could mess it up
+        for everyone else: use the copying version instead.
     */
-    const VstTimeInfo* getTimeInfo ()       { return &timeInfo; }
+    const VstTimeInfo* getTimeInfo () const  { return &timeInfoSnapshots [currentTimeInfo]; }
+
+    /** Copy the current time info snapshot into a plugin owned structure
+
+        Only the fields requested by the kVst*Valid bits of the mask are
+        copied, and the flags are updated to tell which are valid.
+    */
+    void getTimeInfo (VstTimeInfo& destination, const int requestedFlags) const;
 
 #endif
 
@@ -81,12 +90,30 @@ public:
     /** Useful for external synchronization */
     void processIncomingMidi (MidiBuffer& midiMessages);
     
-    /** Useful for VST synchronization */ 
+    /** Useful for VST synchronization
+
+        When external tempo sync is enabled and we are not the master, this
+        will follow the host play head: tempo, time signature, play state and
+        frame position (so locates are followed sample accurately).
+    */
     void processAudioPlayHead (AudioPlayHead* head);
 
     /** This will update the current block */
     void processBlock (const int blockSize);
 
+    /** This will render midi clock and timecode for the current block
+
+        It must be called before any plugin is processed, as the messages are
+        placed at exact sample offsets relative to the current position, which
+        is advanced later in processBlock.
+
+        @see getMidiClockBuffer
+    */
+    void processMidiClock (const int blockSize);
+
+    /** Returns the midi sync messages rendered for the current block */
+    const MidiBuffer& getMidiClockBuffer () const    { return midiClockBuffer; }
+
     //==============================================================================
     /** Set an external transport */
     void setExternalTransport (ExternalTransport* externalTransport);
@@ -161,6 +188,31 @@ public:
     bool willSendAllNotesOff () const                { return doAllNotesOff; }
     bool willRewind () const                         { return doRewind; }
 
+    //==============================================================================
+    /** Set how many bars we play before punching in
+
+        When recording is armed and play is pressed, the transport starts this
+        number of bars before the current position (possibly going negative,
+        as a count-in) and starts recording exactly at the punch in frame.
+    */
+    void setPreRollBars (const int numBars);
+    int getPreRollBars () const                      { return preRollBars; }
+
+    /** Returns true while we are playing the pre-roll before punching in */
+    bool isPreRolling () const                       { return punchArmed; }
+
+    /** Returns the frame at which the current recording started
+
+        Recorders should discard events before this frame, as the transport
+        goes in recording state at the start of the block containing it.
+    */
+    int getPunchInFrame () const                     { return punchInFrame; }
+
+    //==============================================================================
+    /** Enable the metronome click, it will always click during pre-roll */
+    void setMetronome (const bool shouldClick);
+    bool isMetronomeEnabled () const                 { return metronome; }
+
     //==============================================================================
     void setTimeSignature (const int bpmTempo,
                            const int barsCount,
@@ -194,12 +246,45 @@ public:
     void setPositionAbsolute (const float newPos);
     float getPositionAbsolute () const               { return sequencePositionCounter / (float) sequenceDurationFrames; }
 
+    //==============================================================================
+    /** Act as midi clock master
+
+        When enabled, the transport will generate 24 PPQN midi clock while
+        playing, start/stop/continue on transport changes and song position
+        pointer messages on every locate.
+    */
+    void setMidiClockMaster (const bool shouldSendClock);
+    bool isMidiClockMaster () const                  { return sendMidiClock; }
+
+    /** Act as midi timecode master
+
+        When enabled, the transport will generate MTC quarter frames while
+        playing, using the frame rate set with setMidiTimecodeType.
+    */
+    void setMidiTimecodeMaster (const bool shouldSendTimecode);
+    bool isMidiTimecodeMaster () const               { return sendMidiTimecode; }
+
+    /** Set the MTC frame rate, one of the MidiMessage::SmpteTimecodeType */
+    void setMidiTimecodeType (const int newTimecodeType);
+    int getMidiTimecodeType () const                 { return midiTimecodeType; }
+
     //==============================================================================
     void loadFromXml (XmlElement* xml);
     void saveToXml (XmlElement* xml);
 
+    //==============================================================================
+    /** @internal */
+    void timerCallback ();
+
 private:
 
+    //==============================================================================
+    void startPlaying ();
+    void stopPlaying ();
+    void updateTimeSignature (const int bpmTempo,
+                              const int barsCount,
+                              const int timeDenominator);
+
     HostFilterBase* owner;
 
     int sequencePositionCounter;
@@ -223,10 +308,45 @@ private:
          doAllNotesOff  : 1;
 
 #if JOST_USE_VST
-    // vst internal timeinfo
-    VstTimeInfo timeInfo;
+    void updateTimeInfo (const int blockSize);
+
+    // vst internal timeinfo, double buffered
+    VstTimeInfo timeInfoSnapshots [2];
+    volatile int currentTimeInfo;
+    int nextTimeInfoPosition;
 #endif
 
+    //==============================================================================
+    void resetMidiClockCounters ();
+    void updateMidiTimecode (const double framePosition);
+
+    // follow the external play head as slave
+    bool followPlayHead;
+
+    // the play head changed something, listeners are told from the timer
+    volatile bool playHeadChanged;
+
+    // pre-roll and punch in state
+    int preRollBars;
+    int punchInFrame;
+    bool punchArmed;
+    bool metronome;
+
+    // midi sync master state (touched by the gui thread, so no bitfields)
+    bool sendMidiClock;
+    bool sendMidiTimecode;
+    int midiTimecodeType;
+
+    // midi sync rendering state (only touched by the audio thread)
+    MidiBuffer midiClockBuffer;
+    bool midiClockWasPlaying;
+    int nextMidiClockPosition;
+    int midiBeatPosition;
+    double nextMidiClockFrame;
+    double nextQuarterFrameFrame;
+    int quarterFrameIndex;
+    int timecodeHours, timecodeMinutes, timecodeSeconds, timecodeFrames;
+
     // if we get passed an external transport, we will try to control it
     // TODO - this could be done in a better way, at least we could try to
     //        make all these classes a single interface
@@ -0,0 +1,910 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#include "BridgePlugin.h"
+#include "../../HostFilterBase.h"
+
+#if JOST_USE_BRIDGE
+
+#include <elf.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+
+//==============================================================================
+BridgePlugin::BridgePlugin (const int pluginType_, const int descriptorIndex_)
+  : pluginType (pluginType_),
+    descriptorIndex (descriptorIndex_),
+    shared (0),
+    childPid (0),
+    failed (false),
+    processRequest (0),
+    missedPeriods (0),
+    totalMissedPeriods (0),
+    reportedMissedPeriods (0),
+    parameterQueue (JOST_PARAMETER_QUEUE_SIZE),
+    parameterValues (0),
+    audioThreadId (0),
+    sampleRate (44100.0),
+    blockSize (512)
+{
+}
+
+BridgePlugin::~BridgePlugin ()
+{
+    stopTimer ();
+    stopBridge ();
+
+    delete[] parameterValues;
+}
+
+//==============================================================================
+bool BridgePlugin::isForeignLibrary (const File& file)
+{
+    FileInputStream* in = file.createInputStream ();
+    if (in == 0)
+        return false;
+
+    unsigned char ident [EI_NIDENT];
+    const int bytesRead = in->read (ident, EI_NIDENT);
+    delete in;
+
+    if (bytesRead != EI_NIDENT
+        || ident [EI_MAG0] != ELFMAG0 || ident [EI_MAG1] != ELFMAG1
+        || ident [EI_MAG2] != ELFMAG2 || ident [EI_MAG3] != ELFMAG3)
+        return false;
+
+    const int ourClass = (sizeof (void*) == 8) ? ELFCLASS64 : ELFCLASS32;
+
+    return ident [EI_CLASS] != ourClass;
+}
+
+void BridgePlugin::probeFile (const File& file, OwnedArray<PluginCacheEntry>& results)
+{
+    const File executable (findBridgeExecutable ());
+    if (! executable.existsAsFile ())
+    {
+        printf ("Cannot find %s to probe %s \n",
+                (const char*) JOST_BRIDGE_EXECUTABLE, (const char*) file.getFullPathName ());
+        return;
+    }
+
+    // take the strings before forking, the child will only exec
+    const String executablePath (executable.getFullPathName ());
+    const String filePath (file.getFullPathName ());
+
+    int fds [2];
+    if (pipe (fds) != 0)
+        return;
+
+    const int pid = fork ();
+    if (pid == 0)
+    {
+        dup2 (fds [1], STDOUT_FILENO);
+        close (fds [0]);
+        close (fds [1]);
+
+        // the alarm outlives the exec, so a stuck library can't keep it around
+        alarm (JOST_PLUGIN_SCAN_TIMEOUT / 1000 + 1);
+
+        execl ((const char*) executablePath, (const char*) executablePath,
+               "--probe", (const char*) filePath, (char*) 0);
+        _exit (1);
+    }
+
+    close (fds [1]);
+    if (pid < 0)
+    {
+        close (fds [0]);
+        return;
+    }
+
+    String output;
+    char buffer [4096];
+    int bytesRead;
+    while ((bytesRead = read (fds [0], buffer, sizeof (buffer) - 1)) > 0)
+    {
+        buffer [bytesRead] = 0;
+        output += String (buffer);
+    }
+
+    close (fds [0]);
+
+    int status = 0;
+    waitpid (pid, &status, 0);
+
+    // same lines our scan workers write
+    StringArray lines;
+    lines.addLines (output);
+
+    for (int i = 0; i < lines.size (); i++)
+    {
+        StringArray tokens;
+        tokens.addTokens (lines [i], T("\t"), T(""));
+
+        if (tokens [0] != T("E"))
+            continue;
+
+        PluginCacheEntry* entry = new PluginCacheEntry ();
+        entry->type = (tokens [1].getIntValue () == BridgePluginVst) ? JOST_PLUGINTYPE_VST
+                                                                     : JOST_PLUGINTYPE_LADSPA;
+        entry->descriptorIndex = tokens [2].getIntValue ();
+        entry->uniqueID = tokens [3].getIntValue ();
+        entry->numInputs = tokens [4].getIntValue ();
+        entry->numOutputs = tokens [5].getIntValue ();
+        entry->numMidiInputs = tokens [6].getIntValue ();
+        entry->numMidiOutputs = tokens [7].getIntValue ();
+        entry->numParameters = tokens [8].getIntValue ();
+        entry->name = tokens [9];
+        results.add (entry);
+    }
+}
+
+const File BridgePlugin::findBridgeExecutable ()
+{
+    // next to us first, then in the path
+    const File sibling (File::getSpecialLocation (File::currentExecutableFile)
+                            .getSiblingFile (JOST_BRIDGE_EXECUTABLE));
+    if (sibling.existsAsFile ())
+        return sibling;
+
+    const char* path = getenv ("PATH");
+
+    StringArray paths;
+    if (path != 0)
+        paths.addTokens (String (path), T(":"), T(""));
+
+    for (int i = 0; i < paths.size (); i++)
+    {
+        if (paths [i].isEmpty ())
+            continue;
+
+        const File candidate (File (paths [i]).getChildFile (JOST_BRIDGE_EXECUTABLE));
+        if (candidate.existsAsFile ())
+            return candidate;
+    }
+
+    return File::nonexistent;
+}
+
+//==============================================================================
+bool BridgePlugin::startBridge ()
+{
+    static int bridgeCounter = 0;
+
+    const File executable (findBridgeExecutable ());
+    if (! executable.existsAsFile ())
+    {
+        printf ("Cannot find %s to run %s \n",
+                (const char*) JOST_BRIDGE_EXECUTABLE, (const char*) pluginFile.getFullPathName ());
+        return false;
+    }
+
+    sharedName = T("/jost-bridge-") + String (getpid ()) + T("-") + String (++bridgeCounter);
+
+    const int fd = shm_open ((const char*) sharedName, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+    {
+        printf ("Cannot create shared memory %s \n", (const char*) sharedName);
+        return false;
+    }
+
+    void* memory = MAP_FAILED;
+    if (ftruncate (fd, sizeof (BridgeShared)) == 0)
+        memory = mmap (0, sizeof (BridgeShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    close (fd);
+
+    if (memory == MAP_FAILED)
+    {
+        printf ("Cannot map shared memory %s \n", (const char*) sharedName);
+        shm_unlink ((const char*) sharedName);
+        return false;
+    }
+
+    // it comes zeroed, and we don't want the audio pages to be swapped out
+    shared = (BridgeShared*) memory;
+    mlock (shared, sizeof (BridgeShared));
+
+    shared->magic = JOST_BRIDGE_MAGIC;
+    shared->version = JOST_BRIDGE_VERSION;
+    shared->structSize = sizeof (BridgeShared);
+    shared->pluginType = (pluginType == JOST_PLUGINTYPE_VST) ? BridgePluginVst : BridgePluginLadspa;
+    shared->descriptorIndex = descriptorIndex;
+    strncpy (shared->filePath, (const char*) pluginFile.getFullPathName (), JOST_BRIDGE_PATH_SIZE - 1);
+
+    // take the strings before forking, the child will only exec
+    const String executablePath (executable.getFullPathName ());
+
+    childPid = fork ();
+    if (childPid == 0)
+    {
+        execl ((const char*) executablePath, (const char*) executablePath,
+               (const char*) sharedName, (char*) 0);
+        _exit (1);
+    }
+
+    if (childPid < 0)
+    {
+        printf ("Cannot fork the bridge for %s \n", (const char*) pluginFile.getFullPathName ());
+        childPid = 0;
+        return false;
+    }
+
+    const bool started = bridgeFutexWait (&shared->ready, 0, JOST_BRIDGE_START_TIMEOUT);
+
+    // both sides have it mapped now, or the bridge is not coming
+    shm_unlink ((const char*) sharedName);
+
+    if (! started || shared->ready != 1)
+    {
+        printf ("Bridge for %s didn't start \n", (const char*) pluginFile.getFullPathName ());
+        failed = true;
+        return false;
+    }
+
+    return true;
+}
+
+void BridgePlugin::stopBridge ()
+{
+    if (childPid > 0)
+    {
+        if (! failed)
+            sendCommand (BridgeCommandQuit);
+
+        // give it some time to close the plugin, then make sure it's gone
+        int status = 0;
+        int result = 0;
+        for (int i = 0; i < 50 && (result = waitpid (childPid, &status, WNOHANG)) == 0; i++)
+            Thread::sleep (10);
+
+        if (result == 0)
+        {
+            kill (childPid, SIGKILL);
+            waitpid (childPid, &status, 0);
+        }
+
+        childPid = 0;
+    }
+
+    if (shared != 0)
+    {
+        munmap (shared, sizeof (BridgeShared));
+        shared = 0;
+    }
+}
+
+//==============================================================================
+int BridgePlugin::sendCommand (const int command,
+                               const int index,
+                               const int value,
+                               const float floatValue,
+                               const double doubleValue)
+{
+    const ScopedLock sl (commandLock);
+
+    if (shared == 0 || failed)
+        return 0;
+
+    shared->command = command;
+    shared->commandIndex = index;
+    shared->commandValue = value;
+    shared->commandFloat = floatValue;
+    shared->commandDouble = doubleValue;
+    shared->commandResult = 0;
+
+    const int32 request = shared->commandRequest + 1;
+    bridgeFutexSet (&shared->commandRequest, request);
+
+    if (! bridgeFutexWait (&shared->commandDone, request - 1, JOST_BRIDGE_COMMAND_TIMEOUT))
+    {
+        printf ("Bridge for %s doesn't answer, plugin disabled \n",
+                (const char*) pluginFile.getFullPathName ());
+        failed = true;
+        return 0;
+    }
+
+    return shared->commandResult;
+}
+
+const String BridgePlugin::getCommandText (const int command, const int index, const float value)
+{
+    const ScopedLock sl (commandLock);
+
+    sendCommand (command, index, 0, value);
+
+    if (shared == 0 || failed)
+        return String::empty;
+
+    shared->data [JOST_BRIDGE_DATA_SIZE - 1] = 0;
+    return String (shared->data);
+}
+
+//==============================================================================
+bool BridgePlugin::loadPluginFromFile (const File& filePath)
+{
+    pluginFile = filePath;
+
+    if (! startBridge ())
+        return false;
+
+    const int numParams = jlimit (0, JOST_BRIDGE_MAX_PARAMETERS, (int) shared->numParameters);
+
+    // create parameters, all of them are normalized by the bridge
+    setNumParameters (numParams);
+
+    parameterQueue.setNumParameters (numParams);
+    parameterValues = new float [jmax (1, numParams)];
+
+    for (int i = 0; i < numParams; i++)
+    {
+        AudioParameter* parameter = new AudioParameter ();
+
+        parameterValues [i] = shared->parameterValues [i];
+
+        parameter->part (i);
+        parameter->name (getCommandText (BridgeCommandGetParameterName, i));
+        parameter->range (0.0f, 1.0f);
+        parameter->get (MakeDelegate (this, &BridgePlugin::getParameterReal));
+        parameter->set (MakeDelegate (this, &BridgePlugin::setParameterReal));
+        parameter->text (MakeDelegate (this, &BridgePlugin::getParameterTextReal));
+
+        registerParameter (i, parameter);
+    }
+
+    startTimer (JOST_BRIDGE_AUTOMATION_INTERVAL);
+
+    return true;
+}
+
+//==============================================================================
+const String BridgePlugin::getName () const
+{
+    if (shared != 0 && shared->name [0] != 0)
+        return String (shared->name);
+    else
+        return pluginFile.getFileNameWithoutExtension ();
+}
+
+int BridgePlugin::getID () const
+{
+    return shared != 0 ? shared->uniqueID : 0;
+}
+
+int BridgePlugin::getNumInputs () const
+{
+    return shared != 0 ? shared->numInputs : 0;
+}
+
+int BridgePlugin::getNumOutputs () const
+{
+    return shared != 0 ? shared->numOutputs : 0;
+}
+
+int BridgePlugin::getNumMidiInputs () const
+{
+    return 1;
+}
+
+int BridgePlugin::getNumMidiOutputs () const
+{
+    return producesMidi () ? 1 : 0;
+}
+
+bool BridgePlugin::producesMidi () const
+{
+    return shared != 0 && (shared->flags & BridgeFlagProducesMidi) != 0;
+}
+
+bool BridgePlugin::acceptsMidi () const
+{
+    return shared != 0 && (shared->flags & (BridgeFlagAcceptsMidi | BridgeFlagIsSynth)) != 0;
+}
+
+//==============================================================================
+void BridgePlugin::prepareToPlay (double sampleRate_, int samplesPerBlock_)
+{
+    keyboardState.reset();
+
+    sampleRate = sampleRate_;
+    blockSize = samplesPerBlock_;
+
+    sendCommand (BridgeCommandActivate, 0,
+                 jlimit (16, JOST_BRIDGE_MAX_BLOCK, blockSize), 0.0f, sampleRate);
+}
+
+void BridgePlugin::releaseResources()
+{
+    sendCommand (BridgeCommandDeactivate);
+}
+
+void BridgePlugin::processBlock (AudioSampleBuffer& buffer,
+                                 MidiBuffer& midiMessages)
+{
+    const int numSamples = buffer.getNumSamples ();
+
+    audioThreadId = Thread::getCurrentThreadId ();
+
+    // internal buffer coming from other plugins
+    MidiBuffer* midiBuffer = midiBuffers.getUnchecked (0);
+
+    keyboardState.processNextMidiBuffer (*midiBuffer, 0, numSamples, true);
+    midiAutomatorManager.handleMidiMessageBuffer (*midiBuffer);
+
+    if (! failed)
+    {
+        // the transport is the same for the whole period, take our own copy
+        // of this block snapshot, the bridge asks for what its plugin needs
+        VstTimeInfo info;
+        getParentHost ()->getTransport ()->getTimeInfo (info, kVstNanosValid
+                                                              | kVstPpqPosValid
+                                                              | kVstTempoValid
+                                                              | kVstBarsValid
+                                                              | kVstCyclePosValid
+                                                              | kVstTimeSigValid
+                                                              | kVstSmpteValid
+                                                              | kVstClockValid);
+
+        BridgeTimeInfo timeInfo;
+        timeInfo.samplePos = info.samplePos;
+        timeInfo.sampleRate = info.sampleRate;
+        timeInfo.nanoSeconds = info.nanoSeconds;
+        timeInfo.ppqPos = info.ppqPos;
+        timeInfo.tempo = info.tempo;
+        timeInfo.barStartPos = info.barStartPos;
+        timeInfo.cycleStartPos = info.cycleStartPos;
+        timeInfo.cycleEndPos = info.cycleEndPos;
+        timeInfo.timeSigNumerator = info.timeSigNumerator;
+        timeInfo.timeSigDenominator = info.timeSigDenominator;
+        timeInfo.smpteOffset = info.smpteOffset;
+        timeInfo.smpteFrameRate = info.smpteFrameRate;
+        timeInfo.samplesToNextClock = info.samplesToNextClock;
+        timeInfo.flags = info.flags;
+
+        outputEvents.clear ();
+
+        // bigger periods than the shared buffers go in pieces
+        for (int offset = 0; offset < numSamples && ! failed; offset += JOST_BRIDGE_MAX_BLOCK)
+        {
+            const int chunkSamples = jmin (JOST_BRIDGE_MAX_BLOCK, numSamples - offset);
+
+            processChunk (*midiBuffer, timeInfo, offset, chunkSamples);
+        }
+    }
+
+    if (failed)
+    {
+        if (outputBuffer)
+            outputBuffer->clear ();
+
+        outputEvents.clear ();
+    }
+
+    // send midi, straight into the buffer the host will route
+    if (producesMidi ())
+    {
+        midiBuffer->clear ();
+        midiBuffer->addEvents (outputEvents, 0, -1, 0);
+    }
+}
+
+void BridgePlugin::processChunk (const MidiBuffer& midiBuffer,
+                                 const BridgeTimeInfo& timeInfo,
+                                 const int offset,
+                                 const int numSamples)
+{
+    int i;
+
+    // the last request got no answer in time: the shared buffers are not ours
+    // until the bridge is done with it, then its stale answer is dropped
+    if (isBridgeBusy ())
+    {
+        missPeriod (offset, numSamples);
+        return;
+    }
+
+    shared->timeInfo = timeInfo;
+    shared->timeInfo.samplePos += offset;
+
+    if (inputBuffer)
+    {
+        const int numInputs = jmin ((int) shared->numInputs, JOST_BRIDGE_MAX_CHANNELS);
+        for (i = 0; i < numInputs; i++)
+            memcpy (shared->audioIn [i], inputBuffer->getSampleData (i, offset), numSamples * sizeof (float));
+    }
+
+    // short messages only, sysex doesn't go through the bridge
+    int numEvents = 0;
+    const uint8* midiData;
+    int midiSize, samplePosition;
+
+    MidiBuffer::Iterator it (midiBuffer);
+    it.setNextSamplePosition (offset);
+
+    while (it.getNextEvent (midiData, midiSize, samplePosition)
+           && samplePosition < offset + numSamples)
+    {
+        if (midiSize > 4 || numEvents >= JOST_BRIDGE_MAX_MIDI_EVENTS)
+            continue;
+
+        BridgeMidiEvent& event = shared->midiIn [numEvents++];
+        event.sampleOffset = samplePosition - offset;
+        event.size = midiSize;
+        memcpy (event.data, midiData, midiSize);
+    }
+
+    shared->numMidiIn = numEvents;
+    shared->numMidiOut = 0;
+    shared->numSamples = numSamples;
+
+    // run the bridge and wait for it, leaving the rest of the period to the others
+    const int timeoutMicros = jmax (1, (int) (numSamples * JOST_BRIDGE_PROCESS_PERIOD_RATIO
+                                              * 1000000.0 / jmax (1.0, sampleRate)));
+
+    // requests are numbered, so only the answer to this one will do
+    bridgeFutexSet (&shared->processRequest, ++processRequest);
+
+    if (! bridgeFutexWaitForMicros (&shared->processDone, processRequest, timeoutMicros))
+    {
+        missPeriod (offset, numSamples);
+        return;
+    }
+
+    missedPeriods = 0;
+    shared->numParameterChanges = 0;
+
+    if (outputBuffer)
+    {
+        const int numOutputs = jmin ((int) shared->numOutputs, JOST_BRIDGE_MAX_CHANNELS);
+        for (i = 0; i < numOutputs; i++)
+            memcpy (outputBuffer->getSampleData (i, offset), shared->audioOut [i], numSamples * sizeof (float));
+    }
+
+    const int numOutputEvents = jmin ((int) shared->numMidiOut, JOST_BRIDGE_MAX_MIDI_EVENTS);
+    for (i = 0; i < numOutputEvents; i++)
+    {
+        const BridgeMidiEvent& event = shared->midiOut [i];
+        outputEvents.addEvent (event.data, jlimit (1, 4, (int) event.size), offset + event.sampleOffset);
+    }
+}
+
+void BridgePlugin::missPeriod (const int offset, const int numSamples)
+{
+    // reported by the timer, we can't print from here
+    ++totalMissedPeriods;
+
+    if (outputBuffer)
+        outputBuffer->clear (offset, numSamples);
+
+    // a bridge that keeps missing is stuck, stop asking it
+    if (++missedPeriods >= JOST_BRIDGE_MAX_MISSED_PERIODS)
+        failed = true;
+}
+
+bool BridgePlugin::isBridgeBusy ()
+{
+    return __sync_fetch_and_add (&shared->processDone, 0) != processRequest;
+}
+
+void BridgePlugin::timerCallback ()
+{
+    if (! failed && childPid > 0)
+    {
+        int status = 0;
+        if (waitpid (childPid, &status, WNOHANG) == childPid)
+        {
+            childPid = 0;
+            failed = true;
+        }
+    }
+
+    const int missed = totalMissedPeriods;
+    if (missed != reportedMissedPeriods)
+    {
+        printf ("Bridge for %s missed %d periods \n",
+                (const char*) pluginFile.getFullPathName (), missed - reportedMissedPeriods);
+        reportedMissedPeriods = missed;
+    }
+
+    if (failed)
+    {
+        printf ("Bridge for %s stopped, plugin disabled \n", (const char*) pluginFile.getFullPathName ());
+        stopTimer ();
+        return;
+    }
+
+    // parameters moved by the plugin itself
+    while (shared->automationRead != shared->automationWrite)
+    {
+        __sync_synchronize ();
+
+        const BridgeParameterChange& change = shared->automation [shared->automationRead];
+
+        if (change.index >= 0 && change.index < getNumParameters ())
+        {
+            parameterValues [change.index] = change.value;
+            sendParamChangeMessageToListeners (change.index, change.value);
+        }
+
+        shared->automationRead = (shared->automationRead + 1) % JOST_BRIDGE_AUTOMATION_SIZE;
+    }
+}
+
+//==============================================================================
+void BridgePlugin::processParameterChanges ()
+{
+    // still busy with a late period, the changes wait in the queue
+    if (failed || isBridgeBusy ())
+        return;
+
+    const int numChanges = parameterQueue.collectChanges ();
+
+    if (numChanges < 0)
+    {
+        // we lost some changes, send everything from the last values
+        for (int i = 0; i < getNumParameters (); i++)
+            addParameterChange (i, parameterValues [i]);
+    }
+    else
+    {
+        for (int i = 0; i < numChanges; i++)
+            addParameterChange (parameterQueue.getChangedIndex (i),
+                                parameterQueue.getChangedValue (i));
+    }
+}
+
+void BridgePlugin::addParameterChange (const int index, const float value)
+{
+    // we can't have more than one change per parameter pending
+    int i;
+    for (i = shared->numParameterChanges; --i >= 0;)
+    {
+        if (shared->parameterChanges [i].index == index)
+        {
+            shared->parameterChanges [i].value = value;
+            return;
+        }
+    }
+
+    i = shared->numParameterChanges;
+    if (i < JOST_BRIDGE_MAX_PARAMETER_CHANGES)
+    {
+        shared->parameterChanges [i].index = index;
+        shared->parameterChanges [i].value = value;
+        shared->numParameterChanges = i + 1;
+    }
+}
+
+void BridgePlugin::sendParameterChanges ()
+{
+    const ScopedLock sl (commandLock);
+
+    processParameterChanges ();
+
+    if (shared != 0 && shared->numParameterChanges > 0)
+    {
+        sendCommand (BridgeCommandApplyParameters);
+        shared->numParameterChanges = 0;
+    }
+}
+
+void BridgePlugin::setParameterReal (int paramNumber, float value)
+{
+    jassert (paramNumber >= 0 && paramNumber < getNumParameters ());
+
+    parameterValues [paramNumber] = value;
+
+    if (failed)
+        return;
+
+    if (audioThreadId != 0
+        && Thread::getCurrentThreadId () == audioThreadId)
+    {
+        // midi automation inside the block, it goes with this period
+        addParameterChange (paramNumber, value);
+    }
+    else if (parentHost == 0)
+    {
+        // we are not in a host yet, nobody is processing
+        parameterQueue.put (paramNumber, value);
+        sendParameterChanges ();
+    }
+    else if (parentHost->isSuspended ())
+    {
+        // nobody is processing, send what is pending along with this one
+        const ScopedLock sl (parentHost->getCallbackLock ());
+
+        parameterQueue.put (paramNumber, value);
+        sendParameterChanges ();
+    }
+    else
+    {
+        // the bridge could be running right now, send it with the next period
+        parameterQueue.put (paramNumber, value);
+    }
+}
+
+float BridgePlugin::getParameterReal (int paramNumber)
+{
+    return parameterValues [paramNumber];
+}
+
+const String BridgePlugin::getParameterTextReal (int paramNumber, float value)
+{
+    return getCommandText (BridgeCommandGetParameterText, paramNumber, value);
+}
+
+void BridgePlugin::refreshParameterValues ()
+{
+    if (shared == 0 || failed)
+        return;
+
+    for (int i = 0; i < getNumParameters (); i++)
+        parameterValues [i] = shared->parameterValues [i];
+}
+
+//==============================================================================
+int BridgePlugin::getNumPrograms ()
+{
+    return shared != 0 ? shared->numPrograms : 0;
+}
+
+void BridgePlugin::setCurrentProgram (int programNumber)
+{
+    sendCommand (BridgeCommandSetProgram, programNumber);
+    refreshParameterValues ();
+}
+
+int BridgePlugin::getCurrentProgram ()
+{
+    return sendCommand (BridgeCommandGetProgram);
+}
+
+const String BridgePlugin::getProgramName (int programNumber)
+{
+    return getCommandText (BridgeCommandGetProgramName, programNumber);
+}
+
+const String BridgePlugin::getCurrentProgramName ()
+{
+    return getProgramName (getCurrentProgram ());
+}
+
+void BridgePlugin::getStateInformation (MemoryBlock& destData)
+{
+    if (shared != 0 && (shared->flags & BridgeFlagProgramChunks))
+    {
+        const ScopedLock sl (commandLock);
+
+        // the bridge keeps the chunk, we take it one piece at a time
+        const int totalSize = sendCommand (BridgeCommandGetChunk);
+        destData.setSize (jmax (0, totalSize));
+
+        int offset = 0;
+        while (offset < totalSize)
+        {
+            sendCommand (BridgeCommandGetChunkData, offset);
+
+            const int pieceSize = jmin ((int) shared->dataSize, totalSize - offset);
+            if (failed || pieceSize <= 0)
+                break;
+
+            destData.copyFrom (shared->data, offset, pieceSize);
+            offset += pieceSize;
+        }
+    }
+    else
+    {
+        MemoryOutputStream out (getNumParameters () * sizeof (float),
+                                256,
+                                & destData);
+
+        for (int j = 0; j < getNumParameters (); j++)
+        {
+            out.writeFloat (getParameter (j));
+        }
+    }
+}
+
+void BridgePlugin::setStateInformation (const void* data, int sizeInBytes)
+{
+    if (shared != 0 && (shared->flags & BridgeFlagProgramChunks))
+    {
+        const ScopedLock sl (commandLock);
+
+        // the bridge sets the chunk when the last piece arrives
+        int offset = 0;
+        while (offset < sizeInBytes && ! failed)
+        {
+            const int pieceSize = jmin (JOST_BRIDGE_DATA_SIZE, sizeInBytes - offset);
+
+            memcpy (shared->data, (const char*) data + offset, pieceSize);
+            shared->dataSize = pieceSize;
+
+            sendCommand (BridgeCommandSetChunkData, offset, sizeInBytes);
+            offset += pieceSize;
+        }
+
+        refreshParameterValues ();
+    }
+    else
+    {
+        MemoryInputStream is (data, sizeInBytes, false);
+
+        for (int j = 0; j < getNumParameters (); j++)
+        {
+            if (is.isExhausted ())
+                break;
+
+            setParameter (j, is.readFloat ());
+        }
+    }
+}
+
+//==============================================================================
+bool BridgePlugin::hasEditor () const
+{
+    return shared != 0 && (shared->flags & BridgeFlagHasEditor) != 0;
+}
+
+bool BridgePlugin::wantsEditor () const
+{
+    return true;
+}
+
+void BridgePlugin::getEditorSize (int& width, int& height)
+{
+    const ScopedLock sl (commandLock);
+
+    sendCommand (BridgeCommandGetEditorSize);
+
+    if (shared != 0 && ! failed)
+    {
+        width = shared->commandIndex;
+        height = shared->commandValue;
+    }
+}
+
+void BridgePlugin::openEditor (void* handle, void* display)
+{
+    // the bridge opens the editor as a child of our window, on its own
+    // display connection, and runs its events and idle from there
+    sendCommand (BridgeCommandOpenEditor, 0, (int) (pointer_sized_int) handle);
+}
+
+void BridgePlugin::closeEditor ()
+{
+    sendCommand (BridgeCommandCloseEditor);
+}
+
+
+#endif // JOST_USE_BRIDGE
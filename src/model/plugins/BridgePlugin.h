@@ -0,0 +1,185 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#ifndef __JUCETICE_JOSTBRIDGEPLUGIN_HEADER__
+#define __JUCETICE_JOSTBRIDGEPLUGIN_HEADER__
+
+#include "../BasePlugin.h"
+#include "../ParameterQueue.h"
+#include "../PluginScanner.h"
+
+#if JOST_USE_BRIDGE
+
+#include "BridgeShared.h"
+
+
+//==============================================================================
+/**
+    A plugin built for another architecture, running in a jost-bridge process.
+
+    The bridge loads the VST or LADSPA library and we talk to it through a
+    single block of shared memory: audio, midi, parameter changes and the
+    transport go in there at every period, and we wait for the bridge to fill
+    the outputs before returning, so it adds no latency. Everything else is a
+    command answered by the bridge main thread, that also runs the plugin
+    editor inside our editor window.
+
+    If the bridge doesn't answer within half a period, that period goes out
+    silent instead of stalling the whole graph, and so do the next ones until
+    the bridge is done with it. The plugin is only disabled, until it is
+    loaded again, when the bridge process exits or keeps missing periods.
+
+    @see BridgeShared
+*/
+class BridgePlugin : public BasePlugin,
+                     public Timer
+{
+public:
+
+    //==============================================================================
+    BridgePlugin (const int pluginType, const int descriptorIndex = 0);
+    ~BridgePlugin ();
+
+    //==============================================================================
+    /** We are the plugin technology we are bridging */
+    int getType () const                                   { return pluginType; }
+
+    //==============================================================================
+    /** Returns true if the library is built for an architecture we can't load */
+    static bool isForeignLibrary (const File& file);
+
+    /** Ask a bridge process for the plugins a foreign library holds */
+    static void probeFile (const File& file, OwnedArray<PluginCacheEntry>& results);
+
+    //==============================================================================
+    bool loadPluginFromFile (const File& filePath);
+    File getFile () const                                  { return pluginFile; }
+
+    //==============================================================================
+    const String getName () const;
+    int getID () const;
+    int getNumInputs () const;
+    int getNumOutputs () const;
+    int getNumMidiInputs () const;
+    int getNumMidiOutputs () const;
+    bool producesMidi () const;
+    bool acceptsMidi () const;
+
+    /** Returns true if the bridge stopped answering */
+    bool hasFailed () const                                { return failed; }
+
+    //==============================================================================
+    void processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMessages);
+    void processParameterChanges ();
+    void prepareToPlay (double sampleRate, int samplesPerBlock);
+    void releaseResources();
+    void timerCallback ();
+
+    //==============================================================================
+    void setParameterReal (int paramNumber, float value);
+    float getParameterReal (int paramNumber);
+    const String getParameterTextReal (int partNumber, float value);
+
+    //==============================================================================
+    int getNumPrograms ();
+    void setCurrentProgram (int programNumber);
+    int getCurrentProgram ();
+    const String getProgramName (int programNumber);
+    const String getCurrentProgramName ();
+    void getStateInformation (MemoryBlock& destData);
+    void setStateInformation (const void* data, int sizeInBytes);
+    bool canCaptureStateWhileProcessing () const           { return false; }
+
+    //==============================================================================
+    bool hasEditor () const;
+    bool wantsEditor () const;
+
+    void getEditorSize (int& width, int& height);
+    void openEditor (void* handle, void* display);
+    void closeEditor ();
+
+private:
+
+    //==============================================================================
+    static const File findBridgeExecutable ();
+
+    bool startBridge ();
+    void stopBridge ();
+
+    int sendCommand (const int command,
+                     const int index = 0,
+                     const int value = 0,
+                     const float floatValue = 0.0f,
+                     const double doubleValue = 0.0);
+    const String getCommandText (const int command, const int index, const float value = 0.0f);
+
+    void processChunk (const MidiBuffer& midiBuffer,
+                       const BridgeTimeInfo& timeInfo,
+                       const int offset,
+                       const int numSamples);
+    void missPeriod (const int offset, const int numSamples);
+    bool isBridgeBusy ();
+
+    void addParameterChange (const int index, const float value);
+    void sendParameterChanges ();
+    void refreshParameterValues ();
+
+    //==============================================================================
+    int pluginType;
+    int descriptorIndex;
+    File pluginFile;
+
+    String sharedName;
+    BridgeShared* shared;
+    int childPid;
+    volatile bool failed;
+
+    // the last period sent, and how many in a row got no answer in time
+    int32 processRequest;
+    int missedPeriods;
+    volatile int totalMissedPeriods;
+    int reportedMissedPeriods;
+
+    // commands come from any thread but the audio one, one at a time
+    CriticalSection commandLock;
+
+    // parameters set outside the audio thread, sent with the next period
+    ParameterQueue parameterQueue;
+    float* parameterValues;
+    int64 audioThreadId;
+
+    // midi sent by the plugin, gathered over the pieces of a period
+    MidiBuffer outputEvents;
+
+    double sampleRate;
+    int blockSize;
+};
+
+#endif // JOST_USE_BRIDGE
+
+#endif // __JUCETICE_JOSTBRIDGEPLUGIN_HEADER__
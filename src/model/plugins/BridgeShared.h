@@ -0,0 +1,297 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#ifndef __JUCETICE_JOSTBRIDGESHARED_HEADER__
+#define __JUCETICE_JOSTBRIDGESHARED_HEADER__
+
+/*
+    This is the protocol between Jost and the jost-bridge process, that runs
+    plugins built for another architecture (a 32bit plugin in a 64bit Jost).
+
+    It is included by both sides, so don't put any juce in here: everything
+    lives in a single block of shared memory, and the two processes wake each
+    other with futexes on the words of that block. The layout must be the same
+    whatever the architecture, so we only use fixed size types and we force
+    the alignment of the 8 bytes ones (i386 would align them to 4).
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+
+//==============================================================================
+#define JOST_BRIDGE_MAGIC                   0x4A425247
+#define JOST_BRIDGE_VERSION                 1
+
+#define JOST_BRIDGE_MAX_CHANNELS            32
+#define JOST_BRIDGE_MAX_BLOCK               4096
+#define JOST_BRIDGE_MAX_PARAMETERS          512
+#define JOST_BRIDGE_MAX_PARAMETER_CHANGES   JOST_BRIDGE_MAX_PARAMETERS
+#define JOST_BRIDGE_MAX_MIDI_EVENTS         512
+#define JOST_BRIDGE_AUTOMATION_SIZE         256
+#define JOST_BRIDGE_DATA_SIZE               65536
+#define JOST_BRIDGE_PATH_SIZE               1024
+#define JOST_BRIDGE_NAME_SIZE               256
+
+typedef double  bridge_double __attribute__ ((aligned (8)));
+typedef int64_t bridge_int64  __attribute__ ((aligned (8)));
+
+//==============================================================================
+/** The plugin technologies the bridge can run */
+enum BridgePluginType
+{
+    BridgePluginVst = 0,
+    BridgePluginLadspa = 1
+};
+
+/** What the bridged plugin is able to do, set when it's ready */
+enum BridgePluginFlags
+{
+    BridgeFlagHasEditor = 1 << 0,
+    BridgeFlagIsSynth = 1 << 1,
+    BridgeFlagAcceptsMidi = 1 << 2,
+    BridgeFlagProducesMidi = 1 << 3,
+    BridgeFlagProgramChunks = 1 << 4
+};
+
+/** Commands sent from the host message thread */
+enum BridgeCommand
+{
+    BridgeCommandNone = 0,
+    BridgeCommandActivate,              // double: sample rate, value: block size
+    BridgeCommandDeactivate,
+    BridgeCommandApplyParameters,       // the parameter changes in the block
+    BridgeCommandGetParameterName,      // index -> data
+    BridgeCommandGetParameterText,      // index, float: value -> data
+    BridgeCommandGetProgram,            // -> result
+    BridgeCommandSetProgram,            // index
+    BridgeCommandGetProgramName,        // index -> data
+    BridgeCommandGetChunk,              // -> result: size, kept in the bridge
+    BridgeCommandGetChunkData,          // index: offset -> data
+    BridgeCommandSetChunkData,          // index: offset, value: total, data
+    BridgeCommandGetEditorSize,         // -> index: width, value: height
+    BridgeCommandOpenEditor,            // value: parent window
+    BridgeCommandCloseEditor,
+    BridgeCommandQuit
+};
+
+//==============================================================================
+struct BridgeMidiEvent
+{
+    int32_t sampleOffset;
+    int32_t size;
+    uint8_t data [4];
+};
+
+struct BridgeParameterChange
+{
+    int32_t index;
+    float value;
+};
+
+/** The transport state for the current block, with the VstTimeInfo fields */
+struct BridgeTimeInfo
+{
+    bridge_double samplePos;
+    bridge_double sampleRate;
+    bridge_double nanoSeconds;
+    bridge_double ppqPos;
+    bridge_double tempo;
+    bridge_double barStartPos;
+    bridge_double cycleStartPos;
+    bridge_double cycleEndPos;
+    int32_t timeSigNumerator;
+    int32_t timeSigDenominator;
+    int32_t smpteOffset;
+    int32_t smpteFrameRate;
+    int32_t samplesToNextClock;
+    int32_t flags;
+};
+
+//==============================================================================
+struct BridgeShared
+{
+    // written by the host before starting the bridge
+    int32_t magic;
+    int32_t version;
+    int32_t structSize;
+    int32_t pluginType;
+    int32_t descriptorIndex;
+    char filePath [JOST_BRIDGE_PATH_SIZE];
+
+    // written by the bridge, then ready is set to 1 (or -1 if it failed)
+    int32_t ready;
+    int32_t uniqueID;
+    int32_t numInputs;
+    int32_t numOutputs;
+    int32_t numParameters;
+    int32_t numPrograms;
+    int32_t flags;
+    char name [JOST_BRIDGE_NAME_SIZE];
+
+    // a period: the host bumps processRequest, the bridge copies it in
+    // processDone when the outputs are ready. The host never writes the
+    // period data before processDone holds its last request
+    int32_t processRequest;
+    int32_t processDone;
+    int32_t numSamples;
+    BridgeTimeInfo timeInfo;
+
+    int32_t numParameterChanges;
+    BridgeParameterChange parameterChanges [JOST_BRIDGE_MAX_PARAMETER_CHANGES];
+
+    int32_t numMidiIn;
+    BridgeMidiEvent midiIn [JOST_BRIDGE_MAX_MIDI_EVENTS];
+    int32_t numMidiOut;
+    BridgeMidiEvent midiOut [JOST_BRIDGE_MAX_MIDI_EVENTS];
+
+    float audioIn [JOST_BRIDGE_MAX_CHANNELS][JOST_BRIDGE_MAX_BLOCK];
+    float audioOut [JOST_BRIDGE_MAX_CHANNELS][JOST_BRIDGE_MAX_BLOCK];
+
+    // parameters moved by the plugin itself, a ring read by the host
+    int32_t automationWrite;
+    int32_t automationRead;
+    BridgeParameterChange automation [JOST_BRIDGE_AUTOMATION_SIZE];
+
+    // the values of every parameter, refreshed when loaded and after
+    // a program or a chunk is set
+    float parameterValues [JOST_BRIDGE_MAX_PARAMETERS];
+
+    // a command: the host bumps commandRequest, the bridge copies it in
+    // commandDone when the result is there
+    int32_t commandRequest;
+    int32_t commandDone;
+    int32_t command;
+    int32_t commandIndex;
+    int32_t commandValue;
+    int32_t commandResult;
+    float commandFloat;
+    bridge_double commandDouble;
+    int32_t dataSize;
+    char data [JOST_BRIDGE_DATA_SIZE];
+};
+
+//==============================================================================
+/** Wake whoever waits on a word of the shared block */
+inline void bridgeFutexWake (int32_t* word)
+{
+    syscall (SYS_futex, word, FUTEX_WAKE, 1, 0, 0, 0);
+}
+
+/** Fill the deadline some microseconds from now */
+inline void bridgeDeadline (struct timespec& deadline, const int timeoutMicros)
+{
+    clock_gettime (CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeoutMicros / 1000000;
+    deadline.tv_nsec += (timeoutMicros % 1000000) * 1000;
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+}
+
+/** Fill the time left until the deadline, returns false if it has passed */
+inline bool bridgeTimeLeft (const struct timespec& deadline, struct timespec& timeout)
+{
+    struct timespec now;
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    timeout.tv_sec = deadline.tv_sec - now.tv_sec;
+    timeout.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+    if (timeout.tv_nsec < 0)
+    {
+        timeout.tv_sec--;
+        timeout.tv_nsec += 1000000000;
+    }
+
+    return timeout.tv_sec >= 0;
+}
+
+/** Wait until a word of the shared block is not the value we have seen
+
+    Returns false if it timed out, so the other side is stuck or dead.
+*/
+inline bool bridgeFutexWaitMicros (int32_t* word, const int32_t seenValue, const int timeoutMicros)
+{
+    struct timespec deadline, timeout;
+    bridgeDeadline (deadline, timeoutMicros);
+
+    while (__sync_fetch_and_add (word, 0) == seenValue)
+    {
+        if (! bridgeTimeLeft (deadline, timeout))
+            return false;
+
+        // it returns straight away if the word has already changed
+        syscall (SYS_futex, word, FUTEX_WAIT, seenValue, &timeout, 0, 0);
+    }
+
+    return true;
+}
+
+/** Wait until a word of the shared block holds the value we expect
+
+    Other values are skipped, so a late answer to an older request is never
+    taken for the one we wait for. Returns false if it timed out.
+*/
+inline bool bridgeFutexWaitForMicros (int32_t* word, const int32_t expectedValue, const int timeoutMicros)
+{
+    struct timespec deadline, timeout;
+    bridgeDeadline (deadline, timeoutMicros);
+
+    int32_t value;
+    while ((value = __sync_fetch_and_add (word, 0)) != expectedValue)
+    {
+        if (! bridgeTimeLeft (deadline, timeout))
+            return false;
+
+        syscall (SYS_futex, word, FUTEX_WAIT, value, &timeout, 0, 0);
+    }
+
+    return true;
+}
+
+/** Same as bridgeFutexWaitMicros, with the timeout in milliseconds */
+inline bool bridgeFutexWait (int32_t* word, const int32_t seenValue, const int timeoutMs)
+{
+    return bridgeFutexWaitMicros (word, seenValue, timeoutMs * 1000);
+}
+
+/** Store a word of the shared block and wake the other side */
+inline void bridgeFutexSet (int32_t* word, const int32_t newValue)
+{
+    __sync_lock_test_and_set (word, newValue);
+    bridgeFutexWake (word);
+}
+
+
+#endif // __JUCETICE_JOSTBRIDGESHARED_HEADER__
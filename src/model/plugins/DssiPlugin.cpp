@@ -30,25 +30,122 @@
 
 #if JUCE_ALSA && JOST_USE_DSSI
 
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+//==============================================================================
+DssiPluginMidiManager::EventStorage::EventStorage (const int maxEvents_)
+  : maxEvents (maxEvents_)
+{
+    events = new snd_seq_event_t [maxEvents];
+}
+
+DssiPluginMidiManager::EventStorage::~EventStorage ()
+{
+    delete[] events;
+}
+
 //==============================================================================
 DssiPluginMidiManager::DssiPluginMidiManager ()
-  : maxEventSize (16 * 1024),
-    currentMidiCount (0)
+  : pending (0),
+    retired (0),
+    maxEventSize (16 * 1024),
+    currentMidiCount (0),
+    highWaterMark (0),
+    droppedEvents (0)
 {
+    current = new EventStorage (JOST_DSSI_MIN_MIDI_EVENTS);
+
     snd_midi_event_new (maxEventSize, &midiParser);
 }
 
 DssiPluginMidiManager::~DssiPluginMidiManager ()
 {
+    stopTimer ();
+
     snd_midi_event_free (midiParser);
+
+    delete current;
+    if (pending) delete pending;
+    if (retired) delete retired;
+}
+
+void DssiPluginMidiManager::prepare (const int samplesPerBlock,
+                                     const String& ownerName)
+{
+    const ScopedLock sl (storageLock);
+
+    name = ownerName;
+
+    if (pending) delete pending;
+    if (retired) delete retired;
+    pending = 0;
+    retired = 0;
+
+    // enough for the period, and for the busiest block we have seen so far
+    const int maxEvents = jmax (JOST_DSSI_MIN_MIDI_EVENTS,
+                                samplesPerBlock * JOST_DSSI_MIDI_EVENTS_PER_SAMPLE,
+                                highWaterMark * 2);
+
+    if (maxEvents != current->maxEvents)
+    {
+        delete current;
+        current = new EventStorage (maxEvents);
+    }
+
+    currentMidiCount = 0;
+
+    startTimer (JOST_DSSI_MIDI_RESIZE_INTERVAL);
+}
+
+void DssiPluginMidiManager::timerCallback ()
+{
+    const int dropped = getAndClearDroppedEvents ();
+
+    if (dropped > 0)
+        printf ("DSSI plugin %s dropped %d midi events, the event buffer was too small \n",
+                (const char*) name, dropped);
+
+    const ScopedLock sl (storageLock);
+
+    // the audio thread has switched to the new storage, the old one is free
+    if (pending == 0 && retired != 0)
+    {
+        delete retired;
+        retired = 0;
+    }
+
+    // getting close to the limit, prepare a bigger one
+    if (pending == 0 && retired == 0
+        && highWaterMark > (current->maxEvents * 3) / 4)
+    {
+        pending = new EventStorage (jmax (current->maxEvents * 2, highWaterMark * 2));
+    }
+}
+
+int DssiPluginMidiManager::getAndClearDroppedEvents ()
+{
+    const int dropped = droppedEvents;
+    droppedEvents = 0;
+    return dropped;
 }
 
 void DssiPluginMidiManager::convertMidiMessages (MidiBuffer& midiMessages,
                                                  const int blockSamples)
 {
+    // pick up the bigger storage, if any is ready
+    if (pending != 0)
+    {
+        retired = current;
+        current = pending;
+        pending = 0;
+    }
+
     const uint8* data;
     int numBytesOfMidiData,
-        samplePosition;
+        samplePosition,
+        numEvents = 0;
     MidiBuffer::Iterator it (midiMessages);
 
     currentMidiCount = 0;
@@ -57,6 +154,14 @@ void DssiPluginMidiManager::convertMidiMessages (MidiBuffer& midiMessages,
                             numBytesOfMidiData,
                             samplePosition))
     {
+        ++numEvents;
+
+        if (currentMidiCount >= current->maxEvents)
+        {
+            ++droppedEvents;
+            continue;
+        }
+
         if (numBytesOfMidiData > maxEventSize)
         {
             maxEventSize = numBytesOfMidiData;
@@ -64,7 +169,7 @@ void DssiPluginMidiManager::convertMidiMessages (MidiBuffer& midiMessages,
             snd_midi_event_new (maxEventSize, &midiParser);
         }
 
-        snd_seq_event_t* event = & midiEventsBuffer [currentMidiCount];
+        snd_seq_event_t* event = & current->events [currentMidiCount];
         snd_seq_ev_clear (event);
 
         snd_midi_event_encode (midiParser,
@@ -72,69 +177,99 @@ void DssiPluginMidiManager::convertMidiMessages (MidiBuffer& midiMessages,
                                numBytesOfMidiData,
                                event);
 
-        if (++currentMidiCount >= 2048)
-            break;
+        // incomplete or unknown messages
+        if (event->type == SND_SEQ_EVENT_NONE)
+            continue;
+
+        // dssi wants the frame offset in the block here
+        event->time.tick = jlimit (0, jmax (0, blockSamples - 1), samplePosition);
+
+        ++currentMidiCount;
     }
 
     snd_midi_event_reset_encode (midiParser);
+
+    if (numEvents > highWaterMark)
+        highWaterMark = numEvents;
 }
 
 //==============================================================================
-DssiPlugin::DssiPlugin ()
-  : ptrLibrary (0),
+DssiPlugin::DssiPlugin (const int descriptorIndex_)
+  : descriptorIndex (descriptorIndex_),
+    module (0),
     ptrPlug (0),
     ladspa (0),
     plugin (0),
     params (0),
     normalized (0),
+    mappings (0),
+    parameterQueue (JOST_PARAMETER_QUEUE_SIZE),
+    audioThreadId (0),
     currentPreset (0),
+    programSelected (false),
     numPrograms (0),
     samplingRate (44100.0f),
-    emptyBuffer (1,32)
+    instantiatedRate (0.0f),
+    activated (false),
+    processedInGroup (false),
+    groupLeader (0),
+    emptyBuffer (1,32),
+    guiPort (0),
+    controlsChanged (0),
+    controlsPending (false),
+    programChanged (false),
+    showPending (false)
 {
 }
 
 DssiPlugin::~DssiPlugin ()
 {
-    osc.stopListening ();
+    if (oscPath.isNotEmpty ())
+    {
+        DssiPluginOscManager* manager = DssiPluginOscManager::getInstance ();
+
+        // close our gui, if any
+        if (guiHost.isNotEmpty ())
+        {
+            OpenSoundMessage quit;
+            quit.setAddress (guiPath + T("/quit"));
+            manager->sendData (guiHost, guiPort, quit);
+        }
+
+        manager->unregisterPlugin (this);
+    }
 
-    if (ptrPlug && ladspa && ladspa->cleanup)
-        ladspa->cleanup (plugin);
+    cleanupPlugin ();
     ptrPlug = 0;
 
     removeAllParameters (true);
 
-    if (ptrLibrary)
-        PlatformUtilities::freeDynamicLibrary (ptrLibrary);
-    ptrLibrary = 0;
+    if (module)
+        PluginModuleManager::getInstance ()->releaseModule (module);
+    module = 0;
 
     if (params) delete[] params;
     if (normalized) delete[] normalized;
+    if (mappings) delete[] mappings;
+    if (controlsChanged) delete[] controlsChanged;
 }
 
 //==============================================================================
 bool DssiPlugin::loadPluginFromFile (const File& filePath)
 {
-    ptrLibrary = PlatformUtilities::loadDynamicLibrary (filePath.getFullPathName());
+    // the library is shared with the other instances
+    module = PluginModuleManager::getInstance ()->openModule (filePath);
 
-    if (ptrLibrary != 0)
+    if (module != 0)
     {
-        DSSI_Descriptor_Function pfDescriptorFunction
-                = (DSSI_Descriptor_Function)
-                        PlatformUtilities::getProcedureEntryPoint (ptrLibrary, T("dssi_descriptor"));
-
-        if (pfDescriptorFunction != 0)
+        if (module->getEntryPoint (T("dssi_descriptor")) != 0)
         {
-            for (uint32 iPluginIndex = 0;; iPluginIndex++)
-            {
-                ptrPlug = pfDescriptorFunction (iPluginIndex);
-                if (ptrPlug != NULL)
-                    break;
-            }
+            // libraries can hold more than one plugin, pick the requested one
+            ptrPlug = (const DSSI_Descriptor*) module->getDescriptor (T("dssi_descriptor"), descriptorIndex);
 
             if (ptrPlug == 0)
             {
-                printf ("Cannot find any valid descriptor in shared library \n");
+                printf ("Cannot find descriptor %d in shared library \n", descriptorIndex);
                 return false;
             }
         }
@@ -157,7 +292,7 @@ bool DssiPlugin::loadPluginFromFile (const File& filePath)
     ladspa = ptrPlug->LADSPA_Plugin;
     // version = ptrPlug->DSSI_API_Version;
 
-    plugin = ladspa->instantiate (ladspa, (unsigned int) samplingRate);
+    // instantiation is deferred until we know the real sample rate
 
 /*
     if (ptrPlug->configure)
@@ -192,30 +327,21 @@ bool DssiPlugin::loadPluginFromFile (const File& filePath)
     memset (params, 0, numParams * sizeof (float));
     memset (normalized, 0, numParams * sizeof (float));
 
-    // connect ports
-    if (ladspa->connect_port)
-    {
-        for (int i = 0; i < pars.size (); i++)
-            ladspa->connect_port (plugin, pars [i], &normalized[i]);
-        for (int i = 0; i < ins.size (); i++)
-            ladspa->connect_port (plugin, ins [i], emptyBuffer.getSampleData (0));
-        for (int i = 0; i < outs.size (); i++)
-            ladspa->connect_port (plugin, outs [i], emptyBuffer.getSampleData (0));
-    }
-
-    // count programs
-    if (ptrPlug->get_program)
-        for (numPrograms = 0; ptrPlug->get_program (plugin, numPrograms); ++numPrograms);
+    mappings = new LadspaPortMapping [numParams];
+    for (int i = 0; i < numParams; i++)
+        mappings [i].prepare (ladspa->PortRangeHints [pars [i]], samplingRate);
+
+    parameterQueue.setNumParameters (numParams);
 
+    controlsChanged = new bool [numParams];
+    memset (controlsChanged, 0, numParams * sizeof (bool));
+
     // set default to 0
 //    setCurrentProgram (0);
     setDefaultProgram ();
 
-    // start osc listener to itself
-    osc.setPort (18910);
-    osc.setRootAddress ("dssi");
-    osc.addListener (this);
-    osc.startListening ();
+    // our own path on the shared osc channel
+    oscPath = DssiPluginOscManager::getInstance ()->registerPlugin (this);
 
     DBG ("DssiPlugin::loadPluginFromFile");
 
@@ -294,16 +420,157 @@ void DssiPlugin::prepareToPlay (double sampleRate, int samplesPerBlock)
 
     keyboardState.reset();
 
-    if (ladspa && ladspa->activate)
-        ladspa->activate (plugin);
+    midiManager.prepare (samplesPerBlock, getName ());
+
+    if (! instantiatePlugin (sampleRate))
+        return;
+
+    if (! activated)
+    {
+        if (ladspa->activate)
+            ladspa->activate (plugin);
+        activated = true;
+    }
 }
 
 void DssiPlugin::releaseResources()
 {
     DBG ("DssiPlugin::releaseResources");
 
-    if (ladspa && ladspa->deactivate)
+    if (plugin && activated)
+    {
+        if (ladspa->deactivate)
+            ladspa->deactivate (plugin);
+        activated = false;
+    }
+}
+
+//==============================================================================
+bool DssiPlugin::instantiatePlugin (const double sampleRate)
+{
+    if (ptrPlug == 0 || ladspa == 0)
+        return false;
+
+    if (plugin && instantiatedRate == (float) sampleRate)
+        return true;
+
+    // the plugin state was computed for another rate, start again
+    cleanupPlugin ();
+
+    // what the instance had will be put back once the new one is ready
+    Array<float> savedValues;
+    for (int i = 0; i < pars.size (); i++)
+        savedValues.add (normalized [i]);
+
+    plugin = ladspa->instantiate (ladspa, (unsigned long) sampleRate);
+    if (plugin == 0)
+    {
+        printf ("Cannot instantiate plugin at %d Hz \n", (int) sampleRate);
+        return false;
+    }
+
+    instantiatedRate = (float) sampleRate;
+
+    // control ports will point to our values for all the instance life,
+    // audio ones to a dummy buffer until the first block
+    connectedPorts.clear ();
+
+    for (int i = 0; i < pars.size (); i++)
+        ladspa->connect_port (plugin, pars [i], &normalized [i]);
+
+    for (int i = 0; i < ins.size (); i++)
+    {
+        ladspa->connect_port (plugin, ins [i], emptyBuffer.getSampleData (0));
+        connectedPorts.add (emptyBuffer.getSampleData (0));
+    }
+
+    for (int i = 0; i < outs.size (); i++)
+    {
+        ladspa->connect_port (plugin, outs [i], emptyBuffer.getSampleData (0));
+        connectedPorts.add (emptyBuffer.getSampleData (0));
+    }
+
+    // the dssi order is configure, then program, then parameters
+    const StringArray& configureKeys = configureValues.getAllKeys ();
+    for (int i = 0; i < configureKeys.size (); i++)
+        configurePlugin (configureKeys [i], configureValues [configureKeys [i]]);
+
+    // count programs
+    if (ptrPlug->get_program)
+        for (numPrograms = 0; ptrPlug->get_program (plugin, numPrograms); ++numPrograms);
+
+    if (programSelected)
+    {
+        setCurrentProgram (currentPreset);
+        programChanged = false;
+    }
+
+    for (int i = 0; i < pars.size (); i++)
+        normalized [i] = savedValues.getUnchecked (i);
+
+    // bounds relative to the sample rate have changed
+    for (int i = 0; i < pars.size (); i++)
+    {
+        const LADSPA_PortRangeHint& hint = ladspa->PortRangeHints [pars [i]];
+
+        mappings [i].prepare (hint, (float) sampleRate);
+
+        if (LADSPA_IS_HINT_SAMPLE_RATE (hint.HintDescriptor))
+            normalized [i] = mappings [i].toPortValue (params [i]);
+    }
+
+    return true;
+}
+
+void DssiPlugin::cleanupPlugin ()
+{
+    if (plugin == 0)
+        return;
+
+    if (activated && ladspa->deactivate)
         ladspa->deactivate (plugin);
+    activated = false;
+
+    if (ladspa->cleanup)
+        ladspa->cleanup (plugin);
+    plugin = 0;
+}
+
+void DssiPlugin::configurePlugin (const String& key, const String& value)
+{
+    if (ptrPlug->configure == 0 || plugin == 0)
+        return;
+
+    char* result = ptrPlug->configure (plugin, (const char*) key, (const char*) value);
+    if (result)
+    {
+        printf ("DSSI configure: %s \n", result);
+        free (result);
+    }
+}
+
+void DssiPlugin::connectAudioPorts ()
+{
+    // connect only if the host moved its buffers
+    for (int i = 0; i < ins.size (); i++)
+    {
+        float* data = inputBuffer->getSampleData (i);
+        if (connectedPorts.getUnchecked (i) != data)
+        {
+            ladspa->connect_port (plugin, ins [i], data);
+            connectedPorts.set (i, data);
+        }
+    }
+
+    for (int i = 0; i < outs.size (); i++)
+    {
+        float* data = outputBuffer->getSampleData (i);
+        if (connectedPorts.getUnchecked (ins.size () + i) != data)
+        {
+            ladspa->connect_port (plugin, outs [i], data);
+            connectedPorts.set (ins.size () + i, data);
+        }
+    }
 }
 
 //==============================================================================
@@ -312,48 +579,25 @@ void DssiPlugin::processBlock (AudioSampleBuffer& buffer,
 {
     const int blockSize = buffer.getNumSamples ();
 
-    MidiBuffer* midiBuffer = midiBuffers.getUnchecked (0);
+    // another instance already run us in this block
+    if (processedInGroup)
+    {
+        processedInGroup = false;
+        return;
+    }
 
-    // add events from keyboards
-    keyboardState.processNextMidiBuffer (*midiBuffer,
-                                         0, blockSize,
-                                         true);
-
-    // process midi automation
-    midiAutomatorManager.handleMidiMessageBuffer (*midiBuffer);
+    // not grouped in this block, on its own run_synth is what the spec prefers
+    if (runsMultipleSynths () && ! ptrPlug->run_synth && ! ptrPlug->run_synth_adding)
+    {
+        DssiPlugin* self = this;
+        processSynthGroup (&self, 1, blockSize);
 
-    if (ptrPlug && ladspa)
+        processedInGroup = false;
+        return;
+    }
+
+    if (prepareBlock (blockSize))
     {
-        // convert midi messages internally
-        midiManager.convertMidiMessages (*midiBuffer, blockSize);
-
-        // connect ports
-        for (int i = 0; i < ins.size (); i++)
-            ladspa->connect_port (plugin, ins [i], inputBuffer->getSampleData (i));
-        for (int i = 0; i < outs.size (); i++)
-            ladspa->connect_port (plugin, outs [i], outputBuffer->getSampleData (i));
-
-#if 0
-        if (ptrPlug->run_multiple_synths)
-        {
-            ptrPlug->run_multiple_synths (1,
-                                          &plugin,
-                                          blockSize,
-                                          & (midiManager.getMidiEvents ()[0]),
-                                          midiManager.getMidiEventsCount ());
-            return;
-        }
-        else if (ptrPlug->run_multiple_synths_adding)
-        {
-            outputBuffer->clear ();
-            ptrPlug->run_multiple_synths_adding (1,
-                                                 &plugin,
-                                                 blockSize,
-                                                 & (midiManager.getMidiEvents ()[0]) ,
-                                                 midiManager.getMidiEventsCount ());
-            return;
-        }
-#endif
         if (ptrPlug->run_synth)
         {
             ptrPlug->run_synth (plugin,
@@ -390,46 +634,144 @@ void DssiPlugin::processBlock (AudioSampleBuffer& buffer,
 }
 
 //==============================================================================
-void DssiPlugin::setParameterReal (int index, float value)
-{
-    jassert (index >= 0 && index < pars.size ());
-
-    const LADSPA_PortRangeHint* hint = & ladspa->PortRangeHints [pars [index]];
-
-    float lower = hint->LowerBound *
-                  (LADSPA_IS_HINT_SAMPLE_RATE (hint->HintDescriptor) ? samplingRate : 1.0f);
-    float upper = hint->UpperBound *
-                  (LADSPA_IS_HINT_SAMPLE_RATE (hint->HintDescriptor) ? samplingRate : 1.0f);
+bool DssiPlugin::prepareBlock (const int blockSize)
+{
+    MidiBuffer* midiBuffer = midiBuffers.getUnchecked (0);
+
+    // add events from keyboards
+    keyboardState.processNextMidiBuffer (*midiBuffer,
+                                         0, blockSize,
+                                         true);
 
-    // @TODO - Handle better lower/upper bound. this is ok for most cases
-    //         but in some others it don't
+    // process midi automation
+    midiAutomatorManager.handleMidiMessageBuffer (*midiBuffer);
 
-    if (LADSPA_IS_HINT_TOGGLED (hint->HintDescriptor))
+    if (ptrPlug && ladspa && plugin)
     {
-        if (value < 0.5f)   normalized [index] = 0.0f;
-        else                normalized [index] = 1.0f;
+        // convert midi messages internally
+        midiManager.convertMidiMessages (*midiBuffer, blockSize);
+
+        // connect ports
+        connectAudioPorts ();
+
+        return true;
     }
-    else if (LADSPA_IS_HINT_BOUNDED_BELOW (hint->HintDescriptor)
-             && LADSPA_IS_HINT_BOUNDED_ABOVE (hint->HintDescriptor))
+
+    return false;
+}
+
+bool DssiPlugin::runsMultipleSynths () const
+{
+    return ptrPlug && (ptrPlug->run_multiple_synths
+                       || ptrPlug->run_multiple_synths_adding);
+}
+
+void DssiPlugin::processSynthGroup (DssiPlugin** instances,
+                                    const int numInstances,
+                                    const int blockSize)
+{
+    LADSPA_Handle handles [JOST_DSSI_MAX_SYNTHS];
+    snd_seq_event_t* events [JOST_DSSI_MAX_SYNTHS];
+    unsigned long eventCounts [JOST_DSSI_MAX_SYNTHS];
+    int numReady = 0;
+
+    jassert (numInstances > 0 && numInstances <= JOST_DSSI_MAX_SYNTHS);
+
+    const DSSI_Descriptor* descriptor = instances [0]->ptrPlug;
+
+    for (int i = 0; i < numInstances; i++)
     {
-        if (LADSPA_IS_HINT_LOGARITHMIC(hint->HintDescriptor) && (lower >= 1.0f && upper >= 1.0f))
-            normalized [index] = expf(logf(lower) * value + logf(upper) * (1.0f - value));
-        else
-            normalized [index] = lower + (upper - lower) * value;
+        DssiPlugin* instance = instances [i];
+
+        jassert (instance->ptrPlug == descriptor);
+
+        instance->processedInGroup = true;
+
+        if (! instance->prepareBlock (blockSize))
+            continue;
+
+        if (! descriptor->run_multiple_synths)
+            instance->outputBuffer->clear ();
+
+        handles [numReady] = instance->plugin;
+        events [numReady] = instance->midiManager.getMidiEvents ();
+        eventCounts [numReady] = instance->midiManager.getMidiEventsCount ();
+        ++numReady;
     }
-    else if (LADSPA_IS_HINT_BOUNDED_BELOW (hint->HintDescriptor))
+
+    if (numReady == 0)
+        return;
+
+    if (descriptor->run_multiple_synths)
     {
-        normalized [index] = value;
+        descriptor->run_multiple_synths (numReady,
+                                         handles,
+                                         blockSize,
+                                         events,
+                                         eventCounts);
     }
-    else if (LADSPA_IS_HINT_BOUNDED_ABOVE (hint->HintDescriptor))
+    else if (descriptor->run_multiple_synths_adding)
     {
-        normalized [index] = value * upper;
+        descriptor->run_multiple_synths_adding (numReady,
+                                                handles,
+                                                blockSize,
+                                                events,
+                                                eventCounts);
     }
+}
+
+//==============================================================================
+void DssiPlugin::processParameterChanges ()
+{
+    // values set from now on can go straight to the ports
+    audioThreadId = Thread::getCurrentThreadId ();
+
+    // apply controls changed from the gui and other threads
+    applyParameterChanges ();
+}
+
+void DssiPlugin::applyParameterChanges ()
+{
+    const int numChanges = parameterQueue.collectChanges ();
 
-    if (LADSPA_IS_HINT_INTEGER (hint->HintDescriptor))
-        normalized [index] = (float) ((int) normalized [index]);
+    if (numChanges < 0)
+    {
+        // we lost some changes, take everything from the current values
+        for (int i = 0; i < pars.size (); i++)
+            normalized [i] = mappings [i].toPortValue (params [i]);
+    }
+    else
+    {
+        // only touched ports, to not override what select_program did
+        for (int i = 0; i < numChanges; i++)
+        {
+            const int index = parameterQueue.getChangedIndex (i);
+            normalized [index] = mappings [index].toPortValue (parameterQueue.getChangedValue (i));
+        }
+    }
+}
 
+//==============================================================================
+void DssiPlugin::setParameterReal (int index, float value)
+{
+    jassert (index >= 0 && index < pars.size ());
+
     params [index] = value;
+
+    // let the gui know at the next update
+    controlsChanged [index] = true;
+    controlsPending = true;
+
+    if (Thread::getCurrentThreadId () == audioThreadId)
+    {
+        // midi automation, we are already inside the block
+        normalized [index] = mappings [index].toPortValue (value);
+    }
+    else
+    {
+        // the plugin could be running right now, let the audio thread do it
+        parameterQueue.put (index, value);
+    }
 }
 
 float DssiPlugin::getParameterReal (int index)
@@ -443,10 +785,13 @@ const String DssiPlugin::getParameterTextReal (int index, float value)
     {
         const LADSPA_PortRangeHint* hint = & ladspa->PortRangeHints [pars [index]];
 
+        // the port itself could still be waiting for the value
+        const float portValue = mappings [index].toPortValue (params [index]);
+
         if (LADSPA_IS_HINT_INTEGER (hint->HintDescriptor))
-            return String ((int) normalized [index]);
+            return String ((int) portValue);
         else
-            return String (normalized [index], 4);
+            return String (portValue, 4);
     }
     else
     {
@@ -462,7 +807,11 @@ int DssiPlugin::getNumPrograms ()
 
 void DssiPlugin::setCurrentProgram (int programNumber)
 {
-    if (ptrPlug && ptrPlug->select_program)
+    // selected again when the plugin is instantiated
+    currentPreset = programNumber;
+    programSelected = true;
+
+    if (ptrPlug && ptrPlug->select_program && plugin)
     {
         DBG ("DssiPlugin::setCurrentPreset");
     
@@ -473,6 +822,7 @@ void DssiPlugin::setCurrentProgram (int programNumber)
             ptrPlug->select_program (plugin, preset->Bank, preset->Program);
 
             currentPreset = programNumber;
+            programChanged = true;
         }
     }
 }
@@ -484,7 +834,7 @@ int DssiPlugin::getCurrentProgram ()
 
 const String DssiPlugin::getProgramName (const int programNumber)
 {
-    if (ptrPlug && ptrPlug->get_program)
+    if (ptrPlug && ptrPlug->get_program && plugin)
     {
         const DSSI_Program_Descriptor* preset = ptrPlug->get_program (plugin, programNumber);
 
@@ -568,13 +918,13 @@ void DssiPlugin::setDefaultProgram ()
                 {
                     if (LADSPA_IS_HINT_DEFAULT_LOW(hint->HintDescriptor)) {
                         normalized [i] = expf(logf(lower) * 0.75f + logf(upper) * 0.25f);
-                        params [i] = 0.25f;
+                        params [i] = mappings [i].fromPortValue (normalized [i]);
                     } else if (LADSPA_IS_HINT_DEFAULT_MIDDLE(hint->HintDescriptor)) {
                         normalized [i] = expf(logf(lower) * 0.5f + logf(upper) * 0.5f);
-                        params [i] = 0.5f;
+                        params [i] = mappings [i].fromPortValue (normalized [i]);
                     } else if (LADSPA_IS_HINT_DEFAULT_HIGH(hint->HintDescriptor)) {
                         normalized [i] = expf(logf(lower) * 0.25f + logf(upper) * 0.75f);
-                        params [i] = 0.75f;
+                        params [i] = mappings [i].fromPortValue (normalized [i]);
                     }
                 }
                 else
@@ -592,7 +942,8 @@ void DssiPlugin::setDefaultProgram ()
                 }
             }
         }
-        else        {
+        else
+        {
             normalized [i] = 0.0f;
             params [i] = 0.0f;
         }
@@ -610,181 +961,342 @@ bool DssiPlugin::wantsEditor () const
     return true;
 }
 
-#if 0
+//==============================================================================
+bool DssiPlugin::hasGui () const
+{
+    return findGuiExecutable ().existsAsFile ();
+}
 
-#include <stdlib.h>
-#include <stdio.h>
-#include <string.h>
-#include <assert.h>
-#include <dlfcn.h>
-#include <unistd.h>
-#include <math.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <sys/time.h>
-#include <sys/wait.h>
-#include <signal.h>
-#include <dirent.h>
-#include <time.h>
-#include <libgen.h>
-
-static void startGUI(const char *directory, const char *dllName, const char *label,
-	                 const char *oscUrl, const char *instanceTag)
-{
-    DBG (oscUrl);
-
-    struct dirent *entry;
-    char *dllBase = strdup(dllName);
-    char *subpath;
-    DIR *subdir;
-    char *filename;
-    struct stat buf;
-    int fuzzy;
-
-    if (strlen(dllBase) > 3 &&
-        !strcasecmp(dllBase + strlen(dllBase) - 3, ".so"))
+const File DssiPlugin::findGuiExecutable () const
+{
+    // guis live in a directory named after the library, and are named
+    // after the plugin label (or the library) followed by the toolkit
+    const File guiDirectory = pluginFile.getParentDirectory ()
+                                        .getChildFile (pluginFile.getFileNameWithoutExtension ());
+
+    if (! guiDirectory.isDirectory () || ladspa == 0)
+        return File::nonexistent;
+
+    OwnedArray<File> candidates;
+    guiDirectory.findChildFiles (candidates, File::findFiles, false, T("*_*"));
+
+    const String prefixes [2] = { String (ladspa->Label) + T("_"),
+                                  pluginFile.getFileNameWithoutExtension () + T("_") };
+
+    for (int p = 0; p < 2; p++)
     {
-        dllBase[strlen(dllBase) - 3] = '\0';
+        for (int i = 0; i < candidates.size (); i++)
+        {
+            const File& candidate = *candidates.getUnchecked (i);
+
+            if (candidate.getFileName ().startsWith (prefixes [p])
+                && access ((const char*) candidate.getFullPathName (), X_OK) == 0)
+                return candidate;
+        }
     }
 
-    if (*dllBase == '/') {
-        subpath = dllBase;
-        dllBase = strdup(strrchr(subpath, '/') + 1);
-    } else {
-    	subpath = (char *)malloc(strlen(directory) + strlen(dllBase) + 2);
-	    sprintf(subpath, "%s/%s", directory, dllBase);
+    return File::nonexistent;
+}
+
+void DssiPlugin::showGui ()
+{
+    // already running, just ask it to show up
+    if (guiHost.isNotEmpty ())
+    {
+        showPending = true;
+        return;
     }
 
-    for (fuzzy = 0; fuzzy <= 1; ++fuzzy) {
-
-	if (!(subdir = opendir(subpath))) {
-		fprintf(stderr, "%s: can't open plugin GUI directory \"%s\"\n", label, subpath);
-	    free(subpath);
-	    free(dllBase);
-	    return;
-	}
-
-	while ((entry = readdir(subdir))) {
-	    
-	    if (entry->d_name[0] == '.') continue;
-	    if (!strchr(entry->d_name, '_')) continue;
-
-	    if (fuzzy) {
-		    fprintf(stderr, "checking %s against %s\n", entry->d_name, dllBase);
-            if (strlen(entry->d_name) <= strlen(dllBase) ||
-                strncmp(entry->d_name, dllBase, strlen(dllBase)) ||
-                entry->d_name[strlen(dllBase)] != '_')
-                continue;
-	    } else {
-		    fprintf(stderr, "checking %s against %s\n", entry->d_name, label);
-            if (strlen(entry->d_name) <= strlen(label) ||
-                strncmp(entry->d_name, label, strlen(label)) ||
-                entry->d_name[strlen(label)] != '_')
-                continue;
-	    }
-	    
-	    filename = (char *)malloc(strlen(subpath) + strlen(entry->d_name) + 2);
-	    sprintf(filename, "%s/%s", subpath, entry->d_name);
-	    
-	    if (stat(filename, &buf)) {
-		    perror("stat failed");
-		    free(filename);
-		    continue;
-	    }
-	    
-	    if ((S_ISREG(buf.st_mode) || S_ISLNK(buf.st_mode)) &&
-    		(buf.st_mode & (S_IXUSR | S_IXGRP | S_IXOTH)))
- 		{
-		    fprintf(stderr, "%s: trying to execute GUI at \"%s\"\n", label, filename);
-		
-		    if (fork() == 0) {
-		        execlp(filename, filename, oscUrl, dllName, label, instanceTag, NULL);
-		        perror("exec failed");
-		        exit(1);
-		    }
-		
-		    free(filename);
-		    free(subpath);
-		    free(dllBase);
-		    return;
-	    }
-	    
-	    free(filename);
-	}
+    const File gui = findGuiExecutable ();
+    if (! gui.existsAsFile ())
+    {
+        printf ("No GUI found for plugin %s \n", (const char*) getName ());
+        return;
     }
 
-	fprintf(stderr, "no GUI found for plugin \"%s\" in \"%s/\"\n", label, subpath);
-    free(subpath);
-    free(dllBase);
+    const String url = DssiPluginOscManager::getInstance ()->getUrl (oscPath);
+    const String guiPath = gui.getFullPathName ();
+    const String libraryPath = pluginFile.getFullPathName ();
+    const String label = ladspa->Label;
+    const String instanceTag = getName ();
+
+    // fork twice, so the gui is not left as our zombie when it exits
+    const pid_t child = fork ();
+    if (child == 0)
+    {
+        if (fork () == 0)
+        {
+            execl ((const char*) guiPath,
+                   (const char*) guiPath,
+                   (const char*) url,
+                   (const char*) libraryPath,
+                   (const char*) label,
+                   (const char*) instanceTag,
+                   (char*) 0);
+            _exit (1);
+        }
+        _exit (0);
+    }
+    else if (child > 0)
+    {
+        waitpid (child, 0, 0);
+    }
+    else
+    {
+        printf ("Cannot launch GUI %s \n", (const char*) guiPath);
+    }
 }
 
-void DssiPlugin::getEditorSize (int& width, int& height)
+//==============================================================================
+void DssiPlugin::handleGuiMessage (const String& method, OpenSoundMessage* message)
 {
-    width = 600;
-    height = 400;
+    if (method == T("update"))
+    {
+        // the gui tells where it is listening: osc.udp://host:port/path
+        const String url = message->getNumStrings () > 0 ? message->getString (0) : String::empty;
+        const String address = url.fromFirstOccurrenceOf (T("://"), false, false);
+
+        guiHost = address.upToFirstOccurrenceOf (T(":"), false, false);
+        guiPort = address.fromFirstOccurrenceOf (T(":"), false, false)
+                         .upToFirstOccurrenceOf (T("/"), false, false).getIntValue ();
+        guiPath = T("/") + address.fromFirstOccurrenceOf (T("/"), false, false);
+
+        if (guiPath.endsWithChar (T('/')))
+            guiPath = guiPath.dropLastCharacters (1);
+
+        // send everything we have, then show it
+        queueAllGuiUpdates ();
+        showPending = true;
+    }
+    else if (method == T("control"))
+    {
+        if (message->getNumInts () > 0 && message->getNumFloats () > 0)
+        {
+            const int index = pars.indexOf (message->getInt (0));
+
+            if (index >= 0)
+            {
+                setParameter (index, mappings [index].fromPortValue (message->getFloat (0)));
+
+                // the gui already knows
+                controlsChanged [index] = false;
+            }
+        }
+    }
+    else if (method == T("program"))
+    {
+        if (message->getNumInts () > 1 && ptrPlug->get_program && plugin)
+        {
+            for (int i = 0; i < numPrograms; i++)
+            {
+                const DSSI_Program_Descriptor* preset = ptrPlug->get_program (plugin, i);
+
+                if (preset
+                    && preset->Bank == (unsigned long) message->getInt (0)
+                    && preset->Program == (unsigned long) message->getInt (1))
+                {
+                    setCurrentProgram (i);
+
+                    // the gui already knows
+                    programChanged = false;
+                    break;
+                }
+            }
+        }
+    }
+    else if (method == T("configure"))
+    {
+        if (message->getNumStrings () > 1 && ptrPlug->configure && plugin)
+        {
+            // a new instance will need it again
+            configureValues.set (message->getString (0), message->getString (1));
+
+            configurePlugin (message->getString (0), message->getString (1));
+        }
+    }
+    else if (method == T("exiting"))
+    {
+        guiHost = String::empty;
+        guiPort = 0;
+        guiPath = String::empty;
+    }
 }
 
-void DssiPlugin::openEditor (void* handle, void* display)
+void DssiPlugin::queueAllGuiUpdates ()
 {
-    startGUI (pluginFile.getParentDirectory().getFullPathName(),
-              pluginFile.getFullPathName(),
-              getName (),
-              "osc.udp://localhost:" + String(osc.getPort ()) + "/dssi/" + getName () + "/chan00",
-              "chan00");
+    for (int i = 0; i < pars.size (); i++)
+        controlsChanged [i] = true;
+
+    controlsPending = true;
+    programChanged = (numPrograms > 0);
 }
 
-void DssiPlugin::idleEditor ()
+void DssiPlugin::sendGuiUpdates (DssiPluginOscManager* manager)
 {
+    if (guiHost.isEmpty ())
+        return;
+
+    if (! (controlsPending || programChanged || showPending))
+        return;
+
+    OpenSoundBundle bundle;
+
+    if (programChanged)
+    {
+        programChanged = false;
+
+        const DSSI_Program_Descriptor* preset = (ptrPlug->get_program && plugin)
+                                                    ? ptrPlug->get_program (plugin, currentPreset) : 0;
+        if (preset)
+        {
+            OpenSoundMessage* message = new OpenSoundMessage ();
+            message->setAddress (guiPath + T("/program"));
+            message->addInt32 ((int32) preset->Bank);
+            message->addInt32 ((int32) preset->Program);
+            bundle.addMessage (message, true);
+        }
+    }
+
+    if (controlsPending)
+    {
+        controlsPending = false;
+
+        for (int i = 0; i < pars.size (); i++)
+        {
+            if (! controlsChanged [i])
+                continue;
+
+            controlsChanged [i] = false;
+
+            OpenSoundMessage* message = new OpenSoundMessage ();
+            message->setAddress (guiPath + T("/control"));
+            message->addInt32 (pars [i]);
+            message->addFloat32 (mappings [i].toPortValue (params [i]));
+            bundle.addMessage (message, true);
+        }
+    }
+
+    if (showPending)
+    {
+        showPending = false;
+
+        OpenSoundMessage* message = new OpenSoundMessage ();
+        message->setAddress (guiPath + T("/show"));
+        bundle.addMessage (message, true);
+    }
+
+    if (bundle.getNumElements () > 0)
+        manager->sendData (guiHost, guiPort, bundle);
 }
 
-void DssiPlugin::closeEditor ()
+
+//==============================================================================
+DssiPluginOscManager::DssiPluginOscManager ()
+  : nextInstance (0)
 {
+    osc.setPort (JOST_DSSI_OSC_PORT);
+    osc.setRootAddress (T("dssi"));
+    osc.addListener (this);
+    osc.startListening ();
 }
-
-#endif
-
-bool DssiPlugin::handleOSCMessage (OpenSoundController* controller,
-                                   OpenSoundMessage *message)
-{
-    String msgString = message->getAddress();
 
-    DBG ("handleOSCMessage >> " + msgString);
-
-/*
-    if (controller->isCorrectAddress (msgString))
+DssiPluginOscManager::~DssiPluginOscManager ()
+{
+    stopTimer ();
+
+    osc.removeListener (this);
+    osc.stopListening ();
+
+    clearSingletonInstance ();
+}
+
+//==============================================================================
+const String DssiPluginOscManager::registerPlugin (DssiPlugin* plugin)
+{
+    const ScopedLock sl (lock);
+
+    const String path = plugin->getName ().replaceCharacter (T(' '), T('_'))
+                        + T("/chan") + String (nextInstance++);
+
+    plugins.add (plugin);
+    paths.add (path);
+
+    if (! isTimerRunning ())
+        startTimer (JOST_DSSI_GUI_INTERVAL);
+
+    return path;
+}
+
+void DssiPluginOscManager::unregisterPlugin (DssiPlugin* plugin)
+{
+    const ScopedLock sl (lock);
+
+    const int index = plugins.indexOf (plugin);
+    if (index >= 0)
     {
-        String msgPlugin = controller->getPathIndexed (msgString, 1);
-        String msgInstance = controller->getPathIndexed (msgString, 2);
-        String msgWhat = controller->getPathIndexed (msgString, 3);
+        plugins.remove (index);
+        paths.remove (index);
+    }
 
-        DBG (msgPlugin
-             + "/" + msgInstance
-             + "/" + msgWhat);
-
-        if (msgWhat == T("update")) {
-
-//            OpenSoundMessage message;
-//            message.setAddress ("/show");
-
-//            sock.setAddress ("localhost");
-//        	sock.setPort (osc.getPort ());
-
-//        	sock.sendData (message.getData(), message.getSize());
-        	
-//        	DBG (" << ziuken !");
-        
-        } else if (msgWhat == T("control")) {
-        } else if (msgWhat == T("configure")) {
-        } else if (msgWhat == T("midi")) {
-        } else if (msgWhat == T("program")) {
-        } else if (msgWhat == T("exiting")) {
-        }
+    if (plugins.size () == 0)
+        stopTimer ();
+}
 
-        return true;
+const String DssiPluginOscManager::getUrl (const String& path) const
+{
+    return T("osc.udp://localhost:") + String (osc.getPort ()) + T("/dssi/") + path;
+}
+
+void DssiPluginOscManager::sendData (const String& host, const int port, OpenSoundBase& data)
+{
+    const int size = data.getSize ();
+
+    sock.setAddress (host);
+    sock.setPort (port);
+    sock.sendData (data.getData (), size);
+}
+
+//==============================================================================
+bool DssiPluginOscManager::handleOSCMessage (OpenSoundController* controller,
+                                             OpenSoundMessage *message)
+{
+    if (! controller->isCorrectAddress (message->getAddress ()))
+        return false;
+
+    // keep a copy, the message thread will dispatch it
+    const int size = message->getSize ();
+    OpenSoundMessage* copy = new OpenSoundMessage (message->getData (), size);
+
+    const ScopedLock sl (lock);
+    pendingMessages.add (copy);
+
+    return true;
+}
+
+void DssiPluginOscManager::timerCallback ()
+{
+    const ScopedLock sl (lock);
+
+    // address is /dssi/<path>/<method>
+    for (int i = 0; i < pendingMessages.size (); i++)
+    {
+        OpenSoundMessage* message = pendingMessages.getUnchecked (i);
+
+        const String address = message->getAddress ().fromFirstOccurrenceOf (T("/dssi/"), false, false);
+        const String path = address.upToLastOccurrenceOf (T("/"), false, false);
+        const String method = address.fromLastOccurrenceOf (T("/"), false, false);
+
+        const int index = paths.indexOf (path);
+        if (index >= 0)
+            plugins.getUnchecked (index)->handleGuiMessage (method, message);
     }
-*/
 
-    return false;
-}
+    pendingMessages.clear (true);
+
+    for (int i = 0; i < plugins.size (); i++)
+        plugins.getUnchecked (i)->sendGuiUpdates (this);
+}
 
-#endif
+juce_ImplementSingleton (DssiPluginOscManager)
+
+#endif
@@ -30,6 +30,9 @@
 #define __JUCETICE_JOSTDSSIPLUGIN_HEADER__
 
 #include "../BasePlugin.h"
+#include "../PluginModule.h"
+#include "../ParameterQueue.h"
+#include "LadspaPortMapping.h"
 
 
 #if JUCE_ALSA && JOST_USE_DSSI
@@ -40,10 +43,14 @@
 
 //==============================================================================
 /**
-    This is a helper class, that will help our poor vst plugin understand
-    its wacky vst event structure.
+    This is a helper class, that will help our poor dssi plugin understand
+    its wacky alsa sequencer event structure.
+
+    The audio thread only records how many events it has seen in a block,
+    the timer prepares a bigger buffer when it gets close to the limit and
+    reports what didn't fit.
 */
-class DssiPluginMidiManager
+class DssiPluginMidiManager : public Timer
 {
 public:
 
@@ -52,19 +59,111 @@ public:
     ~DssiPluginMidiManager ();
 
     //==============================================================================
+    /** Size the event buffer for the current period, call it outside the callback
+
+        The name is only used to report dropped events.
+    */
+    void prepare (const int samplesPerBlock, const String& ownerName);
+
+    /** Convert messages, stamping every event with its offset in the block */
     void convertMidiMessages (MidiBuffer& midiMessages, const int blockSamples);
 
     //==============================================================================
-    snd_seq_event_t* getMidiEvents () { return (snd_seq_event_t*) &midiEventsBuffer[0]; }
+    snd_seq_event_t* getMidiEvents () { return current->events; }
     int getMidiEventsCount () const   { return currentMidiCount; }
 
+    /** Returns how many events didn't fit in the buffer since the last call */
+    int getAndClearDroppedEvents ();
+
+    //==============================================================================
+    /** @internal */
+    void timerCallback ();
+
 protected:
 
     // internal midi event buffer
-    snd_seq_event_t midiEventsBuffer [2048];
+    struct EventStorage
+    {
+        EventStorage (const int maxEvents);
+        ~EventStorage ();
+
+        int maxEvents;
+        snd_seq_event_t* events;
+    };
+
+    // the one in use by the audio thread, a bigger one waiting to be taken
+    // and the previous one, freed by the timer once the audio thread left it
+    EventStorage* current;
+    EventStorage* volatile pending;
+    EventStorage* volatile retired;
+    CriticalSection storageLock;
+
     snd_midi_event_t* midiParser;
     int maxEventSize;
     int currentMidiCount;
+    String name;
+
+    volatile int highWaterMark;
+    volatile int droppedEvents;
+};
+
+
+class DssiPlugin;
+
+//==============================================================================
+/**
+    Shared OSC channel between the host and the dssi plugin guis.
+
+    A single listener thread receives on JOST_DSSI_OSC_PORT, and every
+    plugin instance gets its own path below /dssi. Messages coming from
+    the guis are handled in the message thread, while updates going to
+    them are collected and sent as a single bundle per gui every
+    JOST_DSSI_GUI_INTERVAL milliseconds.
+*/
+class DssiPluginOscManager : public OpenSoundControllerListener,
+                             public Timer
+{
+public:
+
+    //==============================================================================
+    DssiPluginOscManager ();
+    ~DssiPluginOscManager ();
+
+    //==============================================================================
+    /** Register an instance, returning the path its gui will talk to */
+    const String registerPlugin (DssiPlugin* plugin);
+
+    /** Unregister a previously registered instance */
+    void unregisterPlugin (DssiPlugin* plugin);
+
+    /** Returns the url to pass to a gui for the given path */
+    const String getUrl (const String& path) const;
+
+    /** Send data to a gui listening at host and port */
+    void sendData (const String& host, const int port, OpenSoundBase& data);
+
+    //==============================================================================
+    /** @internal */
+    bool handleOSCMessage (OpenSoundController* controller,
+                           OpenSoundMessage *message);
+    /** @internal */
+    void timerCallback ();
+
+    //==============================================================================
+    juce_DeclareSingleton (DssiPluginOscManager, true)
+
+private:
+
+    CriticalSection lock;
+    OpenSoundController osc;
+    UDPSocket sock;
+
+    Array<DssiPlugin*> plugins;
+    StringArray paths;
+    int nextInstance;
+
+    // received by the listener thread, waiting for the message thread
+    OwnedArray<OpenSoundMessage> pendingMessages;
 };
 
 
@@ -72,13 +171,12 @@ protected:
 /**
     Dssi wrapper class.
 */
-class DssiPlugin : public BasePlugin,
-                   public OpenSoundControllerListener
+class DssiPlugin : public BasePlugin
 {
 public:
 
     //==============================================================================
-    DssiPlugin ();
+    DssiPlugin (const int descriptorIndex = 0);
     ~DssiPlugin ();
 
     //==============================================================================
@@ -87,6 +185,9 @@ public:
     //==============================================================================
     bool loadPluginFromFile (const File& filePath);
     File getFile () const                              { return pluginFile; }
+
+    /** Returns which of the plugins in the library we are */
+    int getDescriptorIndex () const                    { return descriptorIndex; }
 
     //==============================================================================
     const String getName () const;
@@ -103,6 +204,40 @@ public:
     void prepareToPlay (double sampleRate, int samplesPerBlock);
     void releaseResources();
 
+    //==============================================================================
+    /** Returns true if the synth wants all its instances run in a single call */
+    bool runsMultipleSynths () const;
+
+    /** Apply the controls changed from the gui and other threads */
+    void processParameterChanges ();
+
+    //==============================================================================
+    /** Returns true if this block has already been run along with other instances */
+    bool isProcessedInGroup () const                   { return processedInGroup; }
+
+    /** Called by the host when the instance is left out of a block after all */
+    void clearProcessedInGroup ()                      { processedInGroup = false; }
+
+    /** The instance running this one in its group, if any */
+    DssiPlugin* getGroupLeader () const                { return groupLeader; }
+
+    /** Set by the host every time the graph changes, with the callback lock held
+
+        Instances bypassed or being captured are left out of the group in
+        the blocks they are, and run on their own when they come back.
+    */
+    void setGroupLeader (DssiPlugin* leader)           { groupLeader = leader; }
+
+    /** Run several instances of the same synth in a single call
+
+        The host will call this from the audio callback with all the instances
+        of a descriptor, once per block. Their processBlock will then do
+        nothing for this block.
+    */
+    static void processSynthGroup (DssiPlugin** instances,
+                                   const int numInstances,
+                                   const int blockSize);
+
     //==============================================================================
     void setParameterReal (int paramNumber, float value);
     float getParameterReal (int paramNumber);
@@ -119,26 +254,37 @@ public:
     bool hasEditor () const;
     bool wantsEditor () const;
 
-#if 0
-    void getEditorSize (int& width, int& height);
-    void openEditor (void* handle, void* display);
-    void idleEditor ();
-    void closeEditor ();
-#endif
-
     //==============================================================================
-    bool handleOSCMessage (OpenSoundController* controller,
-                           OpenSoundMessage *message);
+    /** Returns true if the plugin ships an external gui */
+    bool hasGui () const;
+
+    /** Launch the plugin external gui, or raise it if it is already running */
+    void showGui ();
+
+    /** Handle a message sent by our gui, in the message thread */
+    void handleGuiMessage (const String& method, OpenSoundMessage* message);
+
+    /** Send what changed since the last call to the gui, in the message thread */
+    void sendGuiUpdates (DssiPluginOscManager* manager);
 
 private:
 
     //==============================================================================
     void setDefaultProgram ();
+    bool instantiatePlugin (const double sampleRate);
+    void cleanupPlugin ();
+    void configurePlugin (const String& key, const String& value);
+    void connectAudioPorts ();
+    void applyParameterChanges ();
+    bool prepareBlock (const int blockSize);
+    const File findGuiExecutable () const;
+    void queueAllGuiUpdates ();
 
     //==============================================================================
     File pluginFile;
+    int descriptorIndex;
 
-    void* ptrLibrary;
+    PluginModule* module;
     const DSSI_Descriptor* ptrPlug;
     const LADSPA_Descriptor* ladspa;
     LADSPA_Handle plugin;
@@ -147,17 +293,41 @@ private:
 
     float* params;
     float* normalized;
+    LadspaPortMapping* mappings;
+
+    // control values set outside the audio thread, applied at block start
+    ParameterQueue parameterQueue;
+    int64 audioThreadId;
 
     int currentPreset;
+    bool programSelected;
     int numPrograms;
     float samplingRate;
+    float instantiatedRate;
+    bool activated;
+    bool processedInGroup;
+    DssiPlugin* groupLeader;
+
+    // audio buffers connected to the ins, then outs ports
+    Array<float*> connectedPorts;
+
+    // configure calls received, replayed on every new instance
+    StringPairArray configureValues;
 
     DssiPluginMidiManager midiManager;
     AudioSampleBuffer emptyBuffer;
 
-    // an osc controller
-    UDPSocket sock;
-    OpenSoundController osc;
+    // our path on the shared osc channel and where our gui is listening
+    String oscPath;
+    String guiHost;
+    int guiPort;
+    String guiPath;
+
+    // what the gui needs to know at the next update
+    bool* controlsChanged;
+    volatile bool controlsPending;
+    volatile bool programChanged;
+    bool showPending;
 };
 
 #endif
@@ -40,6 +40,9 @@
     as the main jack client.
 
     There will be only one of this in every Host !
+
+    The last midi output port carries the midi clock and timecode generated
+    by the Transport, so it can be routed to any midi output.
 */
 class InputPlugin : public BasePlugin
 {
@@ -55,10 +58,13 @@ public:
     //==============================================================================
     const  String getName () const        { return T("In"); }
     int getNumOutputs () const            { return numChannels; }
-    int getNumMidiOutputs () const        { return (JucePlugin_WantsMidiInput) ? 1 : 0; }
-    bool producesMidi() const             { return JucePlugin_WantsMidiInput; }
+    int getNumMidiOutputs () const        { return (JucePlugin_WantsMidiInput) ? 2 : 1; }
+    bool producesMidi() const             { return true; }
     bool isMidiInput () const             { return JucePlugin_WantsMidiInput; }
 
+    /** Returns the midi output port carrying transport sync messages */
+    int getMidiClockPort () const         { return getNumMidiOutputs () - 1; }
+
     //==============================================================================
     bool hasEditor () const               { return false; }
     bool wantsEditor () const             { return false; }
@@ -31,55 +31,61 @@
 #ifdef JOST_USE_LADSPA
 
 //==============================================================================
-LadspaPlugin::LadspaPlugin ()
-  : ptrLibrary (0),
+LadspaPlugin::LadspaPlugin (const int descriptorIndex_)
+  : descriptorIndex (descriptorIndex_),
+    module (0),
     ptrPlug (0),
     plugin (0),
     params (0),
     normalized (0),
-    samplingRate (44100.0f)
+    mappings (0),
+    parameterQueue (JOST_PARAMETER_QUEUE_SIZE),
+    audioThreadId (0),
+    rampStarts (0),
+    rampTargets (0),
+    ramping (0),
+    numRamping (0),
+    samplingRate (44100.0f),
+    instantiatedRate (0.0f),
+    activated (false)
 {
 }
 
 LadspaPlugin::~LadspaPlugin ()
 {
-    if (ptrPlug && ptrPlug->cleanup)
-        ptrPlug->cleanup (plugin);
+    cleanupPlugin ();
     ptrPlug = 0;
 
     removeAllParameters (true);
 
-    if (ptrLibrary)
-        PlatformUtilities::freeDynamicLibrary (ptrLibrary);
-    ptrLibrary = 0;
+    if (module)
+        PluginModuleManager::getInstance ()->releaseModule (module);
+    module = 0;
 
     if (params) delete[] params;
     if (normalized) delete[] normalized;
+    if (mappings) delete[] mappings;
+    if (rampStarts) delete[] rampStarts;
+    if (rampTargets) delete[] rampTargets;
+    if (ramping) delete[] ramping;
 }
 
 //==============================================================================
 bool LadspaPlugin::loadPluginFromFile (const File& filePath)
 {
-    ptrLibrary = PlatformUtilities::loadDynamicLibrary (filePath.getFullPathName());
+    // the library is shared with the other instances
+    module = PluginModuleManager::getInstance ()->openModule (filePath);
 
-    if (ptrLibrary != 0)
+    if (module != 0)
     {
-        LADSPA_Descriptor_Function pfDescriptorFunction
-                = (LADSPA_Descriptor_Function)
-                        PlatformUtilities::getProcedureEntryPoint (ptrLibrary, T("ladspa_descriptor"));
-
-        if (pfDescriptorFunction != 0)
+        if (module->getEntryPoint (T("ladspa_descriptor")) != 0)
         {
-            for (uint32 iPluginIndex = 0;; iPluginIndex++)
-            {
-                ptrPlug = pfDescriptorFunction (iPluginIndex);
-                if (ptrPlug != NULL)
-                    break;
-            }
+            // libraries can hold more than one plugin, pick the requested one
+            ptrPlug = (const LADSPA_Descriptor*) module->getDescriptor (T("ladspa_descriptor"), descriptorIndex);
 
             if (ptrPlug == 0)
             {
-                printf ("Cannot find any valid descriptor in shared library \n");
+                printf ("Cannot find descriptor %d in shared library \n", descriptorIndex);
                 return false;
             }
         }
@@ -99,8 +105,8 @@ bool LadspaPlugin::loadPluginFromFile (const File& filePath)
     jassert (ptrPlug);
 
     pluginFile = filePath;
-    plugin = ptrPlug->instantiate (ptrPlug, (unsigned int) samplingRate);
 
+    // instantiation is deferred until we know the real sample rate
     ins.clear ();
     outs.clear ();
     pars.clear ();
@@ -121,8 +127,17 @@ bool LadspaPlugin::loadPluginFromFile (const File& filePath)
     memset (params, 0, numParams * sizeof (float));
     memset (normalized, 0, numParams * sizeof (float));
 
+    mappings = new LadspaPortMapping [numParams];
     for (int i = 0; i < numParams; i++)
-        ptrPlug->connect_port (plugin, pars [i], &normalized[i]);
+        mappings [i].prepare (ptrPlug->PortRangeHints [pars [i]], samplingRate);
+
+    parameterQueue.setNumParameters (numParams);
+
+    rampStarts = new float [numParams];
+    rampTargets = new float [numParams];
+    ramping = new bool [numParams];
+    memset (ramping, 0, numParams * sizeof (bool));
+    numRamping = 0;
 
     // create params
     setNumParameters (numParams);
@@ -187,14 +202,109 @@ void LadspaPlugin::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     samplingRate = sampleRate;
 
-    if (ptrPlug && ptrPlug->activate)
-        ptrPlug->activate (plugin);
+    if (! instantiatePlugin (sampleRate))
+        return;
+
+    if (! activated)
+    {
+        if (ptrPlug->activate)
+            ptrPlug->activate (plugin);
+        activated = true;
+    }
 }
 
 void LadspaPlugin::releaseResources()
 {
-    if (ptrPlug && ptrPlug->deactivate)
+    if (plugin && activated)
+    {
+        if (ptrPlug->deactivate)
+            ptrPlug->deactivate (plugin);
+        activated = false;
+    }
+}
+
+//==============================================================================
+bool LadspaPlugin::instantiatePlugin (const double sampleRate)
+{
+    if (ptrPlug == 0)
+        return false;
+
+    if (plugin && instantiatedRate == (float) sampleRate)
+        return true;
+
+    // the plugin state was computed for another rate, start again
+    cleanupPlugin ();
+
+    plugin = ptrPlug->instantiate (ptrPlug, (unsigned long) sampleRate);
+    if (plugin == 0)
+    {
+        printf ("Cannot instantiate plugin at %d Hz \n", (int) sampleRate);
+        return false;
+    }
+
+    instantiatedRate = (float) sampleRate;
+
+    // control ports will point to our values for all the instance life
+    for (int i = 0; i < pars.size (); i++)
+        ptrPlug->connect_port (plugin, pars [i], &normalized [i]);
+
+    // audio ports are connected at the first block
+    connectedPorts.clear ();
+    for (int i = 0; i < ins.size () + outs.size (); i++)
+        connectedPorts.add (0);
+
+    // bounds relative to the sample rate have changed
+    for (int i = 0; i < pars.size (); i++)
+    {
+        const LADSPA_PortRangeHint& hint = ptrPlug->PortRangeHints [pars [i]];
+
+        mappings [i].prepare (hint, (float) sampleRate);
+        ramping [i] = false;
+
+        if (LADSPA_IS_HINT_SAMPLE_RATE (hint.HintDescriptor))
+            normalized [i] = mappings [i].toPortValue (params [i]);
+    }
+    numRamping = 0;
+
+    return true;
+}
+
+void LadspaPlugin::cleanupPlugin ()
+{
+    if (plugin == 0)
+        return;
+
+    if (activated && ptrPlug->deactivate)
         ptrPlug->deactivate (plugin);
+    activated = false;
+
+    if (ptrPlug->cleanup)
+        ptrPlug->cleanup (plugin);
+    plugin = 0;
+}
+
+void LadspaPlugin::connectAudioPorts (const int offset)
+{
+    // connect only if the host moved its buffers
+    for (int i = 0; i < ins.size (); i++)
+    {
+        float* data = inputBuffer->getSampleData (i, offset);
+        if (connectedPorts.getUnchecked (i) != data)
+        {
+            ptrPlug->connect_port (plugin, ins [i], data);
+            connectedPorts.set (i, data);
+        }
+    }
+
+    for (int i = 0; i < outs.size (); i++)
+    {
+        float* data = outputBuffer->getSampleData (i, offset);
+        if (connectedPorts.getUnchecked (ins.size () + i) != data)
+        {
+            ptrPlug->connect_port (plugin, outs [i], data);
+            connectedPorts.set (ins.size () + i, data);
+        }
+    }
 }
 
 //==============================================================================
@@ -205,6 +315,12 @@ void LadspaPlugin::processBlock (AudioSampleBuffer& buffer,
     
     MidiBuffer* midiBuffer = midiBuffers.getUnchecked (0);
 
+    // values set from now on can go straight to the ports
+    audioThreadId = Thread::getCurrentThreadId ();
+
+    // apply controls changed from the gui and other threads
+    applyParameterChanges ();
+
     // add events from keyboards
     keyboardState.processNextMidiBuffer (*midiBuffer,
                                          0, blockSize,
@@ -213,70 +329,129 @@ void LadspaPlugin::processBlock (AudioSampleBuffer& buffer,
     // process midi automation
     midiAutomatorManager.handleMidiMessageBuffer (*midiBuffer);
 
-    if (ptrPlug)
+    if (ptrPlug && plugin)
     {
-        // connect ports
-        for (int i = 0; i < ins.size (); i++)
-            ptrPlug->connect_port (plugin, ins [i], inputBuffer->getSampleData (i));
-        for (int i = 0; i < outs.size (); i++)
-            ptrPlug->connect_port (plugin, outs [i], outputBuffer->getSampleData (i));
-
-        // run ladspa
-        if (ptrPlug->run)
+        if (numRamping == 0)
         {
-            ptrPlug->run (plugin, blockSize);
-        }
-        else if (ptrPlug->run_adding)
-        {
-            outputBuffer->clear ();
-            
-            ptrPlug->run_adding (plugin, blockSize);
+            // connect ports
+            connectAudioPorts ();
+
+            // run ladspa
+            if (ptrPlug->run)
+            {
+                ptrPlug->run (plugin, blockSize);
+            }
+            else if (ptrPlug->run_adding)
+            {
+                outputBuffer->clear ();
+                
+                ptrPlug->run_adding (plugin, blockSize);
+            }
+        }
+        else
+        {
+            if (! ptrPlug->run)
+                outputBuffer->clear ();
+
+            // run in small slices, moving the ramped ports in between
+            for (int offset = 0; offset < blockSize; offset += JOST_PARAMETER_RAMP_SAMPLES)
+            {
+                const int numSamples = jmin (JOST_PARAMETER_RAMP_SAMPLES, blockSize - offset);
+
+                applyRampedParameters ((offset + numSamples) / (float) blockSize);
+
+                connectAudioPorts (offset);
+
+                if (ptrPlug->run)
+                    ptrPlug->run (plugin, numSamples);
+                else if (ptrPlug->run_adding)
+                    ptrPlug->run_adding (plugin, numSamples);
+            }
         }
     }
 }
 
 //==============================================================================
-void LadspaPlugin::setParameterReal (int index, float value)
-{
-    jassert (index >= 0 && index < pars.size ());
+void LadspaPlugin::applyParameterChanges ()
+{
+    const int numChanges = parameterQueue.collectChanges ();
 
-    const LADSPA_PortRangeHint* hint = & ptrPlug->PortRangeHints [pars [index]];
+    if (numChanges < 0)
+    {
+        // we lost some changes, take everything from the current values
+        for (int i = 0; i < pars.size (); i++)
+            changePortValue (i, params [i]);
+    }
+    else
+    {
+        for (int i = 0; i < numChanges; i++)
+            changePortValue (parameterQueue.getChangedIndex (i),
+                             parameterQueue.getChangedValue (i));
+    }
+}
 
-    float lower = hint->LowerBound *
-                  (LADSPA_IS_HINT_SAMPLE_RATE (hint->HintDescriptor) ? samplingRate : 1.0f);
-    float upper = hint->UpperBound *
-                  (LADSPA_IS_HINT_SAMPLE_RATE (hint->HintDescriptor) ? samplingRate : 1.0f);
+void LadspaPlugin::changePortValue (const int index, const float value)
+{
+    const float portValue = mappings [index].toPortValue (value);
 
-    // @TODO - Handle better lower/upper bound. this is ok for most cases
-    //         but in some others it don't
+    if (plugin != 0 && mappings [index].wantsRamp ())
+    {
+        if (! ramping [index])
+        {
+            ramping [index] = true;
+            ++numRamping;
+        }
 
-    if (LADSPA_IS_HINT_TOGGLED (hint->HintDescriptor))
+        rampStarts [index] = normalized [index];
+        rampTargets [index] = portValue;
+    }
+    else
     {
-        if (value < 0.5f)   normalized [index] = 0.0f;
-        else                normalized [index] = 1.0f;
+        normalized [index] = portValue;
     }
-    else if (LADSPA_IS_HINT_BOUNDED_BELOW (hint->HintDescriptor)
-             && LADSPA_IS_HINT_BOUNDED_ABOVE (hint->HintDescriptor))
+}
+
+void LadspaPlugin::applyRampedParameters (const float position)
+{
+    const bool finished = position >= 1.0f;
+
+    for (int i = 0; i < pars.size (); i++)
     {
-        if (LADSPA_IS_HINT_LOGARITHMIC(hint->HintDescriptor)
-            && lower > 0.0f && upper > 0.0f)
-            normalized [index] = expf(logf(lower) * value + logf(upper) * (1.0f - value));
+        if (! ramping [i])
+            continue;
+
+        if (finished)
+        {
+            normalized [i] = rampTargets [i];
+            ramping [i] = false;
+        }
         else
-            normalized [index] = lower + (upper - lower) * value;
+        {
+            normalized [i] = rampStarts [i] + (rampTargets [i] - rampStarts [i]) * position;
+        }
     }
-    else if (LADSPA_IS_HINT_BOUNDED_BELOW (hint->HintDescriptor))
+
+    if (finished)
+        numRamping = 0;
+}
+
+//==============================================================================
+void LadspaPlugin::setParameterReal (int index, float value)
+{
+    jassert (index >= 0 && index < pars.size ());
+
+    params [index] = value;
+
+    if (Thread::getCurrentThreadId () == audioThreadId)
     {
-        normalized [index] = value;
+        // midi automation, we are already inside the block
+        changePortValue (index, value);
     }
-    else if (LADSPA_IS_HINT_BOUNDED_ABOVE (hint->HintDescriptor))
+    else
     {
-        normalized [index] = value * upper;
+        // the plugin could be running right now, let the audio thread do it
+        parameterQueue.put (index, value);
     }
-
-    if (LADSPA_IS_HINT_INTEGER (hint->HintDescriptor))
-        normalized [index] = (float) ((int) normalized [index]);
-
-    params [index] = value;
 }
 
 float LadspaPlugin::getParameterReal (int index)
@@ -290,10 +465,13 @@ const String LadspaPlugin::getParameterTextReal (int index, float value)
     {
         const LADSPA_PortRangeHint* hint = & ptrPlug->PortRangeHints [pars [index]];
 
+        // the port itself could still be waiting for the value
+        const float portValue = mappings [index].toPortValue (params [index]);
+
         if (LADSPA_IS_HINT_INTEGER (hint->HintDescriptor))
-            return String ((int) normalized [index]);
+            return String ((int) portValue);
         else
-            return String (normalized [index], 4);
+            return String (portValue, 4);
     }
     else
     {
@@ -364,13 +542,13 @@ void LadspaPlugin::setCurrentProgram (int programNumber)
                 {
                     if (LADSPA_IS_HINT_DEFAULT_LOW(hint->HintDescriptor)) {
                         normalized [i] = expf(logf(lower) * 0.75f + logf(upper) * 0.25f);
-                        params [i] = 0.25f;
+                        params [i] = mappings [i].fromPortValue (normalized [i]);
                     } else if (LADSPA_IS_HINT_DEFAULT_MIDDLE(hint->HintDescriptor)) {
                         normalized [i] = expf(logf(lower) * 0.5f + logf(upper) * 0.5f);
-                        params [i] = 0.5f;
+                        params [i] = mappings [i].fromPortValue (normalized [i]);
                     } else if (LADSPA_IS_HINT_DEFAULT_HIGH(hint->HintDescriptor)) {
                         normalized [i] = expf(logf(lower) * 0.25f + logf(upper) * 0.75f);
-                        params [i] = 0.75f;
+                        params [i] = mappings [i].fromPortValue (normalized [i]);
                     }
                 }
                 else
@@ -30,6 +30,9 @@
 #define __JUCETICE_JOSTLADSPAPLUGIN_HEADER__
 
 #include "../BasePlugin.h"
+#include "../PluginModule.h"
+#include "../ParameterQueue.h"
+#include "LadspaPortMapping.h"
 
 
 #ifdef JOST_USE_LADSPA
@@ -43,7 +46,7 @@ class LadspaPlugin : public BasePlugin
 public:
 
     //==============================================================================
-    LadspaPlugin ();
+    LadspaPlugin (const int descriptorIndex = 0);
     ~LadspaPlugin ();
 
     //==============================================================================
@@ -53,6 +56,9 @@ public:
     bool loadPluginFromFile (const File& filePath);
     File getFile () const                              { return pluginFile; }
 
+    /** Returns which of the plugins in the library we are */
+    int getDescriptorIndex () const                    { return descriptorIndex; }
+
     //==============================================================================
     const String getName () const;
     int getID () const;
@@ -84,10 +90,19 @@ public:
 
 private:
 
+    //==============================================================================
+    bool instantiatePlugin (const double sampleRate);
+    void cleanupPlugin ();
+    void connectAudioPorts (const int offset = 0);
+    void applyParameterChanges ();
+    void changePortValue (const int index, const float value);
+    void applyRampedParameters (const float position);
+
     //==============================================================================
     File pluginFile;
+    int descriptorIndex;
 
-    void* ptrLibrary;
+    PluginModule* module;
     const LADSPA_Descriptor* ptrPlug;
     LADSPA_Handle plugin;
 
@@ -95,8 +110,24 @@ private:
 
     float* params;
     float* normalized;
+    LadspaPortMapping* mappings;
+
+    // control values set outside the audio thread, applied at block start
+    ParameterQueue parameterQueue;
+    int64 audioThreadId;
+
+    // control ports moving towards their new value during this block
+    float* rampStarts;
+    float* rampTargets;
+    bool* ramping;
+    int numRamping;
 
     float samplingRate;
+    float instantiatedRate;
+    bool activated;
+
+    // audio buffers connected to the ins, then outs ports
+    Array<float*> connectedPorts;
 };
 
 #endif
@@ -0,0 +1,149 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#include "LadspaPortMapping.h"
+
+
+//==============================================================================
+LadspaPortMapping::LadspaPortMapping ()
+  : type (unbounded),
+    integer (false),
+    ramped (false),
+    lower (0.0f),
+    range (1.0f),
+    logUpper (0.0f),
+    logRange (0.0f)
+{
+}
+
+//==============================================================================
+void LadspaPortMapping::prepare (const LADSPA_PortRangeHint& hint, const float sampleRate)
+{
+    const LADSPA_PortRangeHintDescriptor descriptor = hint.HintDescriptor;
+
+    const float scale = LADSPA_IS_HINT_SAMPLE_RATE (descriptor) ? sampleRate : 1.0f;
+    const float upper = hint.UpperBound * scale;
+
+    lower = hint.LowerBound * scale;
+    range = upper - lower;
+    integer = LADSPA_IS_HINT_INTEGER (descriptor) != 0;
+
+    // @TODO - Handle better lower/upper bound. this is ok for most cases
+    //         but in some others it don't
+
+    if (LADSPA_IS_HINT_TOGGLED (descriptor))
+    {
+        type = toggled;
+    }
+    else if (LADSPA_IS_HINT_BOUNDED_BELOW (descriptor)
+             && LADSPA_IS_HINT_BOUNDED_ABOVE (descriptor))
+    {
+        if (LADSPA_IS_HINT_LOGARITHMIC (descriptor) && lower > 0.0f && upper > 0.0f)
+        {
+            type = logarithmic;
+            logUpper = logf (upper);
+            logRange = logUpper - logf (lower);
+        }
+        else
+        {
+            type = linear;
+        }
+    }
+    else if (LADSPA_IS_HINT_BOUNDED_ABOVE (descriptor))
+    {
+        type = boundedAbove;
+        range = upper;
+    }
+    else
+    {
+        type = unbounded;
+    }
+
+    // frequencies and the like are the ones that zip when stepping
+    ramped = ! integer
+             && type != toggled
+             && (LADSPA_IS_HINT_SAMPLE_RATE (descriptor)
+                 || LADSPA_IS_HINT_LOGARITHMIC (descriptor));
+}
+
+float LadspaPortMapping::toPortValue (const float value) const
+{
+    float portValue;
+
+    switch (type)
+    {
+    case toggled:
+        portValue = (value < 0.5f) ? 0.0f : 1.0f;
+        break;
+    case linear:
+        portValue = lower + range * value;
+        break;
+    case logarithmic:
+        // jost always went from the upper bound down, sessions rely on it
+        portValue = expf (logUpper - logRange * value);
+        break;
+    case boundedAbove:
+        portValue = range * value;
+        break;
+    default:
+        portValue = value;
+        break;
+    }
+
+    if (integer)
+        portValue = (float) ((int) portValue);
+
+    return portValue;
+}
+
+float LadspaPortMapping::fromPortValue (const float portValue) const
+{
+    float value;
+
+    switch (type)
+    {
+    case toggled:
+        value = (portValue > 0.0f) ? 1.0f : 0.0f;
+        break;
+    case linear:
+        value = (range != 0.0f) ? (portValue - lower) / range : 0.0f;
+        break;
+    case logarithmic:
+        value = (logRange != 0.0f && portValue > 0.0f)
+                    ? (logUpper - logf (portValue)) / logRange : 0.0f;
+        break;
+    case boundedAbove:
+        value = (range != 0.0f) ? portValue / range : 0.0f;
+        break;
+    default:
+        value = portValue;
+        break;
+    }
+
+    return (type == unbounded) ? value : jlimit (0.0f, 1.0f, value);
+}
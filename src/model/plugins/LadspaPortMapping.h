@@ -0,0 +1,87 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#ifndef __JUCETICE_JOSTLADSPAPORTMAPPING_HEADER__
+#define __JUCETICE_JOSTLADSPAPORTMAPPING_HEADER__
+
+#include "../../Config.h"
+
+#include <ladspa.h>
+
+
+//==============================================================================
+/**
+    Precomputed mapping from a 0..1 parameter value to a LADSPA control port
+    value.
+
+    Range hints are decoded once, when the plugin is instantiated at a known
+    sample rate, so converting a value is a handful of multiplications (and a
+    single expf for logarithmic ports).
+*/
+class LadspaPortMapping
+{
+public:
+
+    //==============================================================================
+    LadspaPortMapping ();
+
+    //==============================================================================
+    /** Decode the port range hints for the current sample rate */
+    void prepare (const LADSPA_PortRangeHint& hint, const float sampleRate);
+
+    /** Convert a 0..1 parameter value to the port value */
+    float toPortValue (const float value) const;
+
+    /** Convert a port value back to a 0..1 parameter value */
+    float fromPortValue (const float portValue) const;
+
+    /** Returns true if value changes should be ramped, to avoid zipper noise */
+    bool wantsRamp () const                             { return ramped; }
+
+private:
+
+    enum MappingType
+    {
+        unbounded = 0,
+        toggled,
+        linear,
+        logarithmic,
+        boundedAbove
+    };
+
+    int type;
+    bool integer;
+    bool ramped;
+    float lower;
+    float range;
+    float logUpper;
+    float logRange;
+};
+
+
+#endif // __JUCETICE_JOSTLADSPAPORTMAPPING_HEADER__
@@ -0,0 +1,195 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#include "MetronomePlugin.h"
+#include "../../HostFilterBase.h"
+
+#define CLICK_LENGTH_SECONDS       0.03
+#define CLICK_ACCENT_FREQUENCY     1760.0
+#define CLICK_BEAT_FREQUENCY       880.0
+#define CLICK_BEAT_GAIN            0.6f
+
+
+//==============================================================================
+MetronomePlugin::MetronomePlugin ()
+  : transport (0),
+    accentClick (2, 32),
+    beatClick (2, 32),
+    currentClick (0),
+    clickPosition (0)
+{
+    accentClick.clear ();
+    beatClick.clear ();
+}
+
+MetronomePlugin::~MetronomePlugin ()
+{
+}
+
+//==============================================================================
+void MetronomePlugin::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    transport = getParentHost()->getTransport ();
+
+    loadClickSamples (sampleRate);
+
+    currentClick = 0;
+    clickPosition = 0;
+}
+
+void MetronomePlugin::releaseResources()
+{
+    currentClick = 0;
+    clickPosition = 0;
+}
+
+//==============================================================================
+void MetronomePlugin::loadClickSamples (const double sampleRate)
+{
+    File clickFile (JOST_METRONOME_CLICK_PATH);
+
+    if (clickFile.existsAsFile ())
+    {
+        WavAudioFormat wavFormat;
+        AudioFormatReader* reader = wavFormat.createReaderFor (clickFile.createInputStream (), true);
+
+        if (reader != 0)
+        {
+            const int numSamples = (int) reader->lengthInSamples;
+
+            accentClick.setSize (2, jmax (1, numSamples));
+            accentClick.readFromAudioReader (reader, 0, numSamples, 0, true, true);
+
+            // normal beats use the same sample, only softer
+            beatClick.setSize (2, jmax (1, numSamples));
+            for (int i = 0; i < 2; i++)
+            {
+                beatClick.copyFrom (i, 0, accentClick, i, 0, numSamples);
+                beatClick.applyGain (i, 0, numSamples, CLICK_BEAT_GAIN);
+            }
+
+            delete reader;
+            return;
+        }
+
+        printf ("Metronome click %s could not be loaded \n", (const char*) clickFile.getFullPathName());
+    }
+
+    // synthesize a short decaying sine burst
+    const int numSamples = jmax (1, roundDoubleToInt (sampleRate * CLICK_LENGTH_SECONDS));
+
+    accentClick.setSize (2, numSamples);
+    beatClick.setSize (2, numSamples);
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        const double envelope = exp (-6.0 * i / (double) numSamples);
+        const float accent = (float) (envelope * sin (double_Pi * 2.0 * CLICK_ACCENT_FREQUENCY * i / sampleRate));
+        const float beat = (float) (envelope * sin (double_Pi * 2.0 * CLICK_BEAT_FREQUENCY * i / sampleRate)) * CLICK_BEAT_GAIN;
+
+        for (int channel = 0; channel < 2; channel++)
+        {
+            *accentClick.getSampleData (channel, i) = accent;
+            *beatClick.getSampleData (channel, i) = beat;
+        }
+    }
+}
+
+//==============================================================================
+void MetronomePlugin::processBlock (AudioSampleBuffer& buffer,
+                                    MidiBuffer& midiMessages)
+{
+    const int blockSize = buffer.getNumSamples ();
+
+    outputBuffer->clear ();
+
+    int currentSample = 0;
+
+    if (transport->isPlaying ()
+        && (transport->isMetronomeEnabled () || transport->isPreRolling ()))
+    {
+        const int framesPerBeat = transport->getFramesPerBeat ();
+        const int beatsPerBar = jmax (1, transport->getTimeDenominator ());
+        const int frameCounter = transport->getPositionInFrames ();
+
+        if (framesPerBeat > 0)
+        {
+            // first beat at or after the block start, position can be negative
+            int beat = (int) ceil (frameCounter / (double) framesPerBeat);
+            int beatFrame = beat * framesPerBeat;
+
+            while (beatFrame < frameCounter + blockSize)
+            {
+                const int offset = beatFrame - frameCounter;
+
+                // finish the previous click up to this beat
+                renderClick (currentSample, offset - currentSample);
+                currentSample = offset;
+
+                const int beatInBar = ((beat % beatsPerBar) + beatsPerBar) % beatsPerBar;
+
+                currentClick = (beatInBar == 0) ? &accentClick : &beatClick;
+                clickPosition = 0;
+
+                ++beat;
+                beatFrame += framesPerBeat;
+            }
+        }
+    }
+
+    renderClick (currentSample, blockSize - currentSample);
+}
+
+void MetronomePlugin::renderClick (const int startSample, const int numSamples)
+{
+    if (currentClick == 0 || numSamples <= 0)
+        return;
+
+    const int samplesToCopy = jmin (numSamples, currentClick->getNumSamples () - clickPosition);
+
+    for (int i = 0; i < outputBuffer->getNumChannels (); i++)
+    {
+        outputBuffer->copyFrom (i,
+                                startSample,
+                                *currentClick,
+                                jmin (i, currentClick->getNumChannels () - 1),
+                                clickPosition,
+                                samplesToCopy);
+    }
+
+    clickPosition += samplesToCopy;
+
+    if (clickPosition >= currentClick->getNumSamples ())
+        currentClick = 0;
+}
+
+//==============================================================================
+AudioProcessorEditor* MetronomePlugin::createEditor ()
+{
+    return 0;
+}
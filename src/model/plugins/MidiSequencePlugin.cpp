@@ -88,12 +88,18 @@ void MidiSequencePlugin::processBlock (AudioSampleBuffer& buffer,
         // prepare record incoming midi messages
         if (transport->isRecording ())
         {
+            const int punchInFrame = transport->getPunchInFrame ();
+
             int samplePos = 0;
             MidiMessage msg (0xf4, 0.0);
 
             MidiBuffer::Iterator eventIterator (*midiBuffer);
             while (eventIterator.getNextEvent (msg, samplePos))
             {
+                // the punch in can fall in the middle of the block
+                if (frameCounter + samplePos < punchInFrame)
+                    continue;
+
                 msg.setTimeStamp ((frameCounter + samplePos) * framePerBeatDelta);
                 recordingSequence.addEvent (msg);
             }
@@ -0,0 +1,125 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#include "PlaceholderPlugin.h"
+
+
+//==============================================================================
+PlaceholderPlugin::PlaceholderPlugin (const PluginCacheEntry& entry_, const int program_)
+  : entry (entry_),
+    program (program_),
+    preset (0)
+{
+}
+
+PlaceholderPlugin::~PlaceholderPlugin ()
+{
+    deleteAndZero (preset);
+}
+
+//==============================================================================
+void PlaceholderPlugin::processBlock (AudioSampleBuffer& buffer,
+                                      MidiBuffer& midiMessages)
+{
+    if (outputBuffer == 0)
+        return;
+
+    const int blockSize = buffer.getNumSamples ();
+
+    // let the signal through like in bypass, or be silent without inputs
+    for (int i = 0; i < outputBuffer->getNumChannels (); i++)
+    {
+        if (inputBuffer != 0 && inputBuffer->getNumChannels () > 0)
+        {
+            outputBuffer->copyFrom (i,
+                                    0,
+                                    *inputBuffer,
+                                    jmin (i, inputBuffer->getNumChannels () - 1),
+                                    0,
+                                    blockSize);
+        }
+        else
+        {
+            outputBuffer->clear (i, 0, blockSize);
+        }
+    }
+}
+
+//==============================================================================
+void PlaceholderPlugin::savePresetToXml (XmlElement* xml, const bool deferData)
+{
+    // the data comes from getStateInformation, so it can be deferred too
+    BasePlugin::savePresetToXml (xml, deferData);
+
+    // while the parameters are still the ones of the session
+    XmlElement* params = preset ? preset->getChildByName (T("parameters")) : 0;
+    if (params != 0)
+    {
+        xml->removeChildElement (xml->getChildByName (T("parameters")), true);
+        xml->addChildElement (new XmlElement (*params));
+    }
+}
+
+void PlaceholderPlugin::loadPresetFromXml (XmlElement* xml,
+                                           SessionChunks* chunks,
+                                           const bool onlyChangedState)
+{
+    outputGain =  xml->getDoubleAttribute (T("gain"), 1.0);
+    mutedOutput = xml->getBoolAttribute (T("mute"), 0);
+    bypassOutput = xml->getBoolAttribute (T("bypass"), 0);
+
+    deleteAndZero (preset);
+    preset = new XmlElement (*xml);
+
+    // keep the session mapped until we are replaced
+    presetChunks = chunks;
+}
+
+//==============================================================================
+void PlaceholderPlugin::getStateInformation (MemoryBlock& destData)
+{
+    destData.setSize (0);
+
+    XmlElement* chunk = preset ? preset->getChildByName (T("data")) : 0;
+
+    const void* data = 0;
+    int size = 0;
+    MemoryBlock storage;
+
+    if (chunk != 0
+        && readPresetData (chunk, presetChunks, data, size, storage))
+    {
+        destData.append (data, size);
+    }
+}
+
+//==============================================================================
+AudioProcessorEditor* PlaceholderPlugin::createEditor ()
+{
+    return 0;
+}
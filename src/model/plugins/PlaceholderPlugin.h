@@ -0,0 +1,101 @@
+/*
+ ==============================================================================
+
+ This file is part of the JUCETICE project - Copyright 2007 by Lucio Asnaghi.
+
+ JUCETICE is based around the JUCE library - "Jules' Utility Class Extensions"
+ Copyright 2007 by Julian Storer.
+
+ ------------------------------------------------------------------------------
+
+ JUCE and JUCETICE can be redistributed and/or modified under the terms of
+ the GNU Lesser General Public License, as published by the Free Software
+ Foundation; either version 2 of the License, or (at your option) any later
+ version.
+
+ JUCE and JUCETICE are distributed in the hope that they will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with JUCE and JUCETICE; if not, visit www.gnu.org/licenses or write to
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+
+ ==============================================================================
+*/
+
+#ifndef __JUCETICE_JOSTPLACEHOLDERPLUGIN_HEADER__
+#define __JUCETICE_JOSTPLACEHOLDERPLUGIN_HEADER__
+
+#include "../BasePlugin.h"
+#include "../PluginScanner.h"
+#include "../SessionFile.h"
+
+
+//==============================================================================
+/**
+    Stands for a plugin of a session while the real one is being loaded
+
+    It takes the inputs, outputs and name of the plugin from the plugin cache,
+    so the session graph can be wired and played right away: effects let the
+    signal through, instruments stay silent. The state of the plugin is kept
+    as it was in the session, and is saved back untouched.
+
+    @see Host::loadFromXml
+*/
+class PlaceholderPlugin : public BasePlugin
+{
+public:
+
+    //==============================================================================
+    PlaceholderPlugin (const PluginCacheEntry& entry, const int program);
+    ~PlaceholderPlugin ();
+
+    //==============================================================================
+    int getType () const                  { return JOST_PLUGINTYPE_PLACEHOLDER; }
+    int getID () const                    { return entry.uniqueID; }
+    File getFile () const                 { return File (entry.filePath); }
+
+    /** Returns the type of the plugin this one stands for */
+    int getPluginType () const            { return entry.type; }
+
+    //==============================================================================
+    const String getName () const         { return entry.name; }
+    int getNumInputs () const             { return entry.numInputs; }
+    int getNumOutputs () const            { return entry.numOutputs; }
+    int getNumMidiInputs () const         { return entry.numMidiInputs; }
+    int getNumMidiOutputs () const        { return entry.numMidiOutputs; }
+
+    //==============================================================================
+    int getCurrentProgram ()              { return program; }
+
+    //==============================================================================
+    bool hasEditor () const               { return false; }
+    bool wantsEditor () const             { return false; }
+    bool isEditorInternal () const        { return false; }
+    AudioProcessorEditor* createEditor();
+
+    //==============================================================================
+    void processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMessages);
+
+    //==============================================================================
+    void savePresetToXml (XmlElement* element, const bool deferData = false);
+    void loadPresetFromXml (XmlElement* element,
+                            SessionChunks* chunks = 0,
+                            const bool onlyChangedState = false);
+
+    //==============================================================================
+    void getStateInformation (MemoryBlock& destData);
+
+private:
+
+    PluginCacheEntry entry;
+    int program;
+    XmlElement* preset;
+    SessionChunksPtr presetChunks;
+};
+
+
+#endif
@@ -52,34 +52,141 @@ static VstIntPtr VSTCALLBACK HostCallback (AEffect* effect,
 
 
 //==============================================================================
+VstPluginMidiManager::EventStorage::EventStorage (const int maxEvents_)
+  : maxEvents (maxEvents_)
+{
+    midiEvents = new VstMidiEvent [maxEvents];
+
+    // the VstEvents header already holds room for 2 pointers
+    const int pointerSize = sizeof (VstEvent*);
+    eventList = new char [sizeof (VstEvents) + pointerSize * (maxEvents + JOST_VST_MAX_SYSEX_EVENTS)];
+}
+
+VstPluginMidiManager::EventStorage::~EventStorage ()
+{
+    delete[] midiEvents;
+    delete[] eventList;
+}
+
+//==============================================================================
 VstPluginMidiManager::VstPluginMidiManager ()
+  : pending (0),
+    retired (0),
+    highWaterMark (0),
+    overflowCount (0)
 {
-    int pointersize = sizeof (VstEvent*);
-    int bufferSize = sizeof (VstEvents) - (pointersize * 2);
-    bufferSize += pointersize * 2048;
-    ptrEventBuffer = new char [bufferSize + 1];
+    current = new EventStorage (JOST_VST_MIN_MIDI_EVENTS);
 }
 
 VstPluginMidiManager::~VstPluginMidiManager ()
 {
+    stopTimer ();
+
     // delete midi buffers
-    delete[] ptrEventBuffer;
+    delete current;
+    if (pending) delete pending;
+    if (retired) delete retired;
+}
+
+void VstPluginMidiManager::prepare (const int samplesPerBlock)
+{
+    const ScopedLock sl (storageLock);
+
+    if (pending) delete pending;
+    if (retired) delete retired;
+    pending = 0;
+    retired = 0;
+
+    // enough for the period, and for the busiest block we have seen so far
+    const int maxEvents = jmax (JOST_VST_MIN_MIDI_EVENTS,
+                                samplesPerBlock / JOST_VST_SAMPLES_PER_MIDI_EVENT,
+                                highWaterMark * 2);
+
+    if (maxEvents != current->maxEvents)
+    {
+        delete current;
+        current = new EventStorage (maxEvents);
+    }
+
+    startTimer (JOST_VST_MIDI_RESIZE_INTERVAL);
+}
+
+void VstPluginMidiManager::timerCallback ()
+{
+    const ScopedLock sl (storageLock);
+
+    // the audio thread has switched to the new storage, the old one is free
+    if (pending == 0 && retired != 0)
+    {
+        delete retired;
+        retired = 0;
+    }
+
+    // getting close to the limit, prepare a bigger one
+    if (pending == 0 && retired == 0
+        && highWaterMark > (current->maxEvents * 3) / 4)
+    {
+        pending = new EventStorage (jmax (current->maxEvents * 2, highWaterMark * 2));
+    }
 }
 
 void VstPluginMidiManager::convertMidiMessages (MidiBuffer& midiMessages,
                                                 const int blockSamples)
 {
+    // pick up the bigger storage, if any is ready
+    if (pending != 0)
+    {
+        retired = current;
+        current = pending;
+        pending = 0;
+    }
+
     const uint8* data;
     int currentMidiCount = 0,
+        currentSysexCount = 0,
         numBytesOfMidiData,
-        samplePosition;
+        samplePosition,
+        numEvents = 0;
     MidiBuffer::Iterator it (midiMessages);
+
+    VstEvents* ev = (VstEvents*) current->eventList;
 
     while (it.getNextEvent (data,
                             numBytesOfMidiData,
                             samplePosition))
     {
-        VstMidiEvent* ptrWrite = &midiEventsBuffer [currentMidiCount];
+        ++numEvents;
+
+        if (data[0] == 0xf0)
+        {
+            if (currentSysexCount >= JOST_VST_MAX_SYSEX_EVENTS)
+            {
+                ++overflowCount;
+                continue;
+            }
+
+            // the dump stays valid in the midi buffer until the end of the block
+            VstMidiSysexEvent* ptrSysex = &sysexEventsBuffer [currentSysexCount++];
+
+            zerostruct (*ptrSysex);
+            ptrSysex->type = kVstSysExType;
+            ptrSysex->byteSize = sizeof (VstMidiSysexEvent);
+            ptrSysex->deltaFrames = (samplePosition >= blockSamples)
+                                     ? (blockSamples - 1) : (samplePosition);
+            ptrSysex->dumpBytes = numBytesOfMidiData;
+            ptrSysex->sysexDump = (char*) data;
+
+            ev->events[currentMidiCount + currentSysexCount - 1] = (VstEvent*) ptrSysex;
+            continue;
+        }
+
+        if (currentMidiCount >= current->maxEvents)
+        {
+            ++overflowCount;
+            continue;
+        }
+
+        VstMidiEvent* ptrWrite = &current->midiEvents [currentMidiCount];
 
         ptrWrite->type = kVstMidiType;
         ptrWrite->byteSize = sizeof (VstMidiEvent); // numBytesOfMidiData * 8; // 24
@@ -94,17 +201,137 @@ void VstPluginMidiManager::convertMidiMessages (MidiBuffer& midiMessages,
         ptrWrite->reserved1 = 0;
         ptrWrite->reserved2 = 0;
 
-        if (++currentMidiCount >= 2048)
-            break;
+        ev->events[currentMidiCount + currentSysexCount] = (VstEvent*) ptrWrite;
+        ++currentMidiCount;
     }
 
-    VstEvents* ev = (VstEvents*) ptrEventBuffer;
-    for (int i = 0; i < currentMidiCount; i++)
-    {
-        ev->events[i] = (VstEvent*) & midiEventsBuffer [i];
-    }
-    ev->numEvents = currentMidiCount;
+    ev->numEvents = currentMidiCount + currentSysexCount;
     ev->reserved = 0;
+
+    if (numEvents > highWaterMark)
+        highWaterMark = numEvents;
+}
+
+
+//==============================================================================
+VstPluginMidiOutput::VstPluginMidiOutput ()
+  : readIndex (0),
+    writeIndex (0),
+    sysexReadIndex (0),
+    sysexWriteIndex (0),
+    droppedEvents (0)
+{
+    events = new OutputEvent [JOST_VST_MIDI_OUT_EVENTS];
+    sysexPool = new uint8 [JOST_VST_SYSEX_POOL_SIZE];
+}
+
+VstPluginMidiOutput::~VstPluginMidiOutput ()
+{
+    delete[] events;
+    delete[] sysexPool;
+}
+
+int VstPluginMidiOutput::allocateSysex (const int size)
+{
+    const int read = sysexReadIndex;
+    const int write = sysexWriteIndex;
+
+    // dumps are kept contiguous, wrapping to the start when needed
+    if (write >= read)
+    {
+        if (JOST_VST_SYSEX_POOL_SIZE - write >= size)
+            return write;
+
+        if (read - 1 >= size)
+            return 0;
+    }
+    else if (read - write - 1 >= size)
+    {
+        return write;
+    }
+
+    return -1;
+}
+
+void VstPluginMidiOutput::addEvents (const VstEvents* vstEvents)
+{
+    for (int i = 0; i < vstEvents->numEvents; ++i)
+    {
+        const VstEvent* const e = vstEvents->events[i];
+
+        const int nextIndex = (writeIndex + 1) % JOST_VST_MIDI_OUT_EVENTS;
+        if (nextIndex == readIndex)
+        {
+            ++droppedEvents;
+            continue;
+        }
+
+        OutputEvent* event = & events [writeIndex];
+
+        if (e->type == kVstMidiType)
+        {
+            const VstMidiEvent* midiEvent = (const VstMidiEvent*) e;
+
+            event->deltaFrames = midiEvent->deltaFrames;
+            event->size = MidiMessage::getMessageLengthFromFirstByte ((uint8) midiEvent->midiData [0]);
+            event->sysexOffset = -1;
+            memcpy (event->data, midiEvent->midiData, 4);
+        }
+        else if (e->type == kVstSysExType)
+        {
+            const VstMidiSysexEvent* sysexEvent = (const VstMidiSysexEvent*) e;
+
+            const int size = sysexEvent->dumpBytes;
+            const int offset = (size > 0) ? allocateSysex (size) : -1;
+            if (offset < 0)
+            {
+                ++droppedEvents;
+                continue;
+            }
+
+            memcpy (sysexPool + offset, sysexEvent->sysexDump, size);
+            sysexWriteIndex = offset + size;
+
+            event->deltaFrames = sysexEvent->deltaFrames;
+            event->size = size;
+            event->sysexOffset = offset;
+        }
+        else
+        {
+            continue;
+        }
+
+        writeIndex = nextIndex;
+    }
+}
+
+void VstPluginMidiOutput::drainInto (MidiBuffer& midiBuffer, const int blockSamples)
+{
+    while (readIndex != writeIndex)
+    {
+        const OutputEvent* event = & events [readIndex];
+
+        const int samplePosition = jlimit (0, jmax (0, blockSamples - 1), event->deltaFrames);
+
+        if (event->sysexOffset < 0)
+        {
+            midiBuffer.addEvent (event->data, event->size, samplePosition);
+        }
+        else
+        {
+            midiBuffer.addEvent (sysexPool + event->sysexOffset, event->size, samplePosition);
+            sysexReadIndex = event->sysexOffset + event->size;
+        }
+
+        readIndex = (readIndex + 1) % JOST_VST_MIDI_OUT_EVENTS;
+    }
+}
+
+int VstPluginMidiOutput::getAndClearDroppedEvents ()
+{
+    const int dropped = droppedEvents;
+    droppedEvents = 0;
+    return dropped;
 }
 
 
@@ -113,10 +340,14 @@ VstPlugin::VstPlugin ()
   : module (0),
     effect (0),
     flagsEx (0),
+    parameterQueue (JOST_PARAMETER_QUEUE_SIZE),
+    parameterValues (0),
+    audioThreadId (0),
     sampleRate (44100.0),
-    blockSize (512)
+    blockSize (512),
+    processesDouble (false)
 {
-    insideVSTCallback = 0;
+    zerostruct (timeInfo);
 }
 
 VstPlugin::~VstPlugin ()
@@ -125,10 +356,12 @@ VstPlugin::~VstPlugin ()
 
     removeAllParameters (true);
 
+    delete[] parameterValues;
+
     try
     {
         if (module)
-            PlatformUtilities::freeDynamicLibrary (module);
+            PluginModuleManager::getInstance ()->releaseModule (module);
         module = 0;
     }
     catch (...)
@@ -139,9 +372,10 @@ VstPlugin::~VstPlugin ()
 //==============================================================================
 bool VstPlugin::loadPluginFromFile (const File& filePath)
 {
-    ++insideVSTCallback;
+    atomicIncrement (insideVSTCallback);
 
-    module = PlatformUtilities::loadDynamicLibrary (filePath.getFullPathName());
+    // the library is shared with the other instances
+    module = PluginModuleManager::getInstance ()->openModule (filePath);
 
     if (module != 0)
     {
@@ -149,11 +383,11 @@ bool VstPlugin::loadPluginFromFile (const File& filePath)
         AEffect* (*getPluginInstance) (audioMasterCallback);
         
         getPluginInstance = (AEffect* (*)(audioMasterCallback))
-                                PlatformUtilities::getProcedureEntryPoint (module, "VSTPluginMain");
+                                module->getEntryPoint (T("VSTPluginMain"));
 
         if (getPluginInstance == 0)
             getPluginInstance = (AEffect* (*)(audioMasterCallback))
-                                    PlatformUtilities::getProcedureEntryPoint (module, "main");
+                                    module->getEntryPoint (T("main"));
 
         if (getPluginInstance != 0)
         {
@@ -167,8 +401,8 @@ bool VstPlugin::loadPluginFromFile (const File& filePath)
                 // plugin raised an exception
                 printf ("Plugin has raised an exception in main \n");
                 
-                PlatformUtilities::freeDynamicLibrary (module);
-                --insideVSTCallback;
+                PluginModuleManager::getInstance ()->releaseModule (module);
+                atomicDecrement (insideVSTCallback);
                 module = 0;
                 effect = 0;
                 return false;
@@ -182,8 +416,8 @@ bool VstPlugin::loadPluginFromFile (const File& filePath)
                     printf ("Plugin is not a valid VST \n");
 
                     
-                    PlatformUtilities::freeDynamicLibrary (module);
-                    --insideVSTCallback;
+                    PluginModuleManager::getInstance ()->releaseModule (module);
+                    atomicDecrement (insideVSTCallback);
                     module = 0;
                     effect = 0;
                     return false;
@@ -193,8 +427,8 @@ bool VstPlugin::loadPluginFromFile (const File& filePath)
             {
                 printf ("Plugin instance cannot be created for some reason \n");
                 
-                PlatformUtilities::freeDynamicLibrary (module);
-                --insideVSTCallback;
+                PluginModuleManager::getInstance ()->releaseModule (module);
+                atomicDecrement (insideVSTCallback);
                 module = 0;
                 effect = 0;
                 return false;
@@ -204,8 +438,8 @@ bool VstPlugin::loadPluginFromFile (const File& filePath)
         {
             printf ("Plugin does not have a main function \n");
 
-            PlatformUtilities::freeDynamicLibrary (module);
-            --insideVSTCallback;
+            PluginModuleManager::getInstance ()->releaseModule (module);
+            atomicDecrement (insideVSTCallback);
             module = 0;
             effect = 0;
             return false;
@@ -214,11 +448,11 @@ bool VstPlugin::loadPluginFromFile (const File& filePath)
     else
     {
         printf ("You are trying to load a shared library ? \n");
-        --insideVSTCallback;
+        atomicDecrement (insideVSTCallback);
         return false;
     }
 
-    --insideVSTCallback;
+    atomicDecrement (insideVSTCallback);
 
     pluginFile = filePath;
 
@@ -258,10 +492,15 @@ bool VstPlugin::loadPluginFromFile (const File& filePath)
     char strName [256];
     setNumParameters (effect->numParams);
 
+    parameterQueue.setNumParameters (effect->numParams);
+    parameterValues = new float [jmax (1, effect->numParams)];
+
     for (int i = 0; i < effect->numParams; i++)
     {
         AudioParameter* parameter = new AudioParameter ();
 
+        parameterValues [i] = effect->getParameter (effect, i);
+
         dispatch (effGetParamName, i, 0, strName, 0.0f);
         
         parameter->part (i);
@@ -286,17 +525,29 @@ void VstPlugin::prepareToPlay (double sampleRate_, int samplesPerBlock_)
     sampleRate = sampleRate_;
     blockSize = samplesPerBlock_;
 
+    midiManager.prepare (blockSize);
+
     dispatch (effSetSampleRate, 0, 0, 0, (float) sampleRate);
     dispatch (effSetBlockSize, 0, jmax (16, blockSize), 0, 0.0f);
 
+#if defined (VST_2_4_EXTENSIONS)
+    // when the host runs in double, let the plugins that can do it use our buffers
+    processesDouble = (effect->flags & effFlagsCanDoubleReplacing) != 0
+                      && getDoubleOutputBuffers () != 0;
+
+    if (effect->flags & effFlagsCanDoubleReplacing)
+        dispatch (effSetProcessPrecision, 0,
+                  processesDouble ? kVstProcessPrecision64 : kVstProcessPrecision32, 0, 0.0f);
+#endif
+
     dispatch (effMainsChanged, 0, 1, 0, 0.0f);
 
     // dodgy hack to force some plugins to initialise the sample rate..
     if ((! hasEditor()) && getNumParameters() > 0)
     {
-        const float old = getParameter (0);
-        setParameter (0, (old < 0.5f) ? 1.0f : 0.0f);
-        setParameter (0, old);
+        const float old = effect->getParameter (effect, 0);
+        effect->setParameter (effect, 0, (old < 0.5f) ? 1.0f : 0.0f);
+        effect->setParameter (effect, 0, old);
     }
 
     dispatch (effStartProcess, 0, 0, 0, 0);
@@ -307,6 +558,11 @@ void VstPlugin::releaseResources()
     dispatch (effStopProcess, 0, 0, 0, 0);
     
     dispatch (effMainsChanged, 0, 0, 0, 0.0f);
+
+    const int dropped = midiOutput.getAndClearDroppedEvents ();
+    if (dropped > 0)
+        printf ("Plugin %s sent %d midi events that didn't fit the output buffer \n",
+                (const char*) getName (), dropped);
 }
 
 void VstPlugin::processBlock (AudioSampleBuffer& buffer,
@@ -317,30 +573,9 @@ void VstPlugin::processBlock (AudioSampleBuffer& buffer,
 
     const int blockSize = buffer.getNumSamples ();
 
-    // clear incoming midi
-    if (flagsEx & effFlagsExCanSendVstMidiEvents)
-        sendToOutMidi.clear ();
-
-    // internal buffer coming from other plugins    
-    MidiBuffer* midiBuffer = midiBuffers.getUnchecked (0);
-
-    // add events from keyboards
-    keyboardState.processNextMidiBuffer (*midiBuffer,
-                                         0, blockSize,
-                                         true);
-
-    // process midi automation
-    midiAutomatorManager.handleMidiMessageBuffer (*midiBuffer);
-
-    if (flagsEx & effFlagsExCanReceiveVstMidiEvents
-        || effect->flags & effFlagsIsSynth)
-    {
-        // convert midi messages internally
-        midiManager.convertMidiMessages ((*midiBuffer), blockSize);
+    audioThreadId = Thread::getCurrentThreadId ();
 
-        // call processEvents
-        dispatch (effProcessEvents, 0, 0, (VstEvents*) midiManager.getMidiEvents (), 0.0f);
-    }
+    processMidiInput (blockSize);
 
     // do the real processing
     if (inputBuffer)
@@ -377,12 +612,68 @@ void VstPlugin::processBlock (AudioSampleBuffer& buffer,
                          blockSize);
     }
 
-    // send midi
+    processMidiOutput (blockSize);
+}
+
+void VstPlugin::processBlockDouble (AudioSampleBuffer& buffer,
+                                    MidiBuffer& midiMessages)
+{
+#if defined (VST_2_4_EXTENSIONS)
+    if (processesDouble)
+    {
+        const int blockSize = buffer.getNumSamples ();
+
+        audioThreadId = Thread::getCurrentThreadId ();
+
+        processMidiInput (blockSize);
+
+        // no conversion at all, the plugin works on the host double buffers
+        effect->processDoubleReplacing (effect,
+                                        getDoubleInputBuffers ()->getArrayOfChannels (),
+                                        getDoubleOutputBuffers ()->getArrayOfChannels (),
+                                        blockSize);
+
+        processMidiOutput (blockSize);
+        return;
+    }
+#endif
+
+    BasePlugin::processBlockDouble (buffer, midiMessages);
+}
+
+void VstPlugin::processMidiInput (const int blockSize)
+{
+    // internal buffer coming from other plugins    
+    MidiBuffer* midiBuffer = midiBuffers.getUnchecked (0);
+
+    // add events from keyboards
+    keyboardState.processNextMidiBuffer (*midiBuffer,
+                                         0, blockSize,
+                                         true);
+
+    // process midi automation
+    midiAutomatorManager.handleMidiMessageBuffer (*midiBuffer);
+
+    if (flagsEx & effFlagsExCanReceiveVstMidiEvents
+        || effect->flags & effFlagsIsSynth)
+    {
+        // convert midi messages internally
+        midiManager.convertMidiMessages ((*midiBuffer), blockSize);
+
+        // call processEvents
+        dispatch (effProcessEvents, 0, 0, (VstEvents*) midiManager.getMidiEvents (), 0.0f);
+    }
+}
+
+void VstPlugin::processMidiOutput (const int blockSize)
+{
+    // send midi, straight into the buffer the host will route
     if (flagsEx & effFlagsExCanSendVstMidiEvents)
     {
-        // clear them
+        MidiBuffer* midiBuffer = midiBuffers.getUnchecked (0);
+
         midiBuffer->clear ();
-        midiBuffer->addEvents (sendToOutMidi, 0, blockSize, 0);
+        midiOutput.drainInto (*midiBuffer, blockSize);
     }
 }
 
@@ -395,18 +686,7 @@ void VstPlugin::timerCallback ()
 void VstPlugin::sendMidiEventToOutput (VstEvents* events)
 {
     if (events != 0)
-    {
-        // const ScopedLock sl (midiInLock);
-        for (int i = 0; i < events->numEvents; ++i)
-        {
-            const VstEvent* const e = events->events[i];
-            if (e->type == kVstMidiType)
-            {
-                sendToOutMidi.addEvent ((const uint8*) ((const VstMidiEvent*) e)->midiData,
-                                        3, e->deltaFrames);
-            }
-        }
-    }
+        midiOutput.addEvents (events);
 }
 
 //==============================================================================
@@ -466,14 +746,62 @@ bool VstPlugin::acceptsMidi () const
 }
 
 //==============================================================================
+void VstPlugin::processParameterChanges ()
+{
+    const int numChanges = parameterQueue.collectChanges ();
+
+    if (numChanges < 0)
+    {
+        // we lost some changes, take everything from the last values
+        for (int i = 0; i < effect->numParams; i++)
+            effect->setParameter (effect, i, parameterValues [i]);
+    }
+    else
+    {
+        for (int i = 0; i < numChanges; i++)
+            effect->setParameter (effect,
+                                  parameterQueue.getChangedIndex (i),
+                                  parameterQueue.getChangedValue (i));
+    }
+}
+
 void VstPlugin::setParameterReal (int paramNumber, float value)
 {
-    effect->setParameter (effect, paramNumber, value);
+    jassert (paramNumber >= 0 && paramNumber < effect->numParams);
+
+    parameterValues [paramNumber] = value;
+
+    if (parentHost == 0
+        || (audioThreadId != 0 && Thread::getCurrentThreadId () == audioThreadId))
+    {
+        // midi automation inside the block, or not handed to a host yet
+        effect->setParameter (effect, paramNumber, value);
+    }
+    else if (parentHost != 0 && parentHost->isSuspended ())
+    {
+        // nobody is processing, flush what is pending before this one
+        const ScopedLock sl (parentHost->getCallbackLock ());
+
+        processParameterChanges ();
+        effect->setParameter (effect, paramNumber, value);
+    }
+    else
+    {
+        // the plugin could be running right now, let the audio thread do it
+        parameterQueue.put (paramNumber, value);
+    }
 }
 
 float VstPlugin::getParameterReal (int paramNumber)
 {
-    return effect->getParameter (effect, paramNumber);
+    // the plugin could be running right now, don't ask it
+    return parameterValues [paramNumber];
+}
+
+void VstPlugin::updateParameterValues ()
+{
+    for (int i = 0; i < effect->numParams; i++)
+        parameterValues [i] = effect->getParameter (effect, i);
 }
 
 const String VstPlugin::getParameterTextReal (int paramNumber, float value)
@@ -498,6 +826,9 @@ int VstPlugin::getNumPrograms ()
 void VstPlugin::setCurrentProgram (int programNumber)
 {
     dispatch (effSetProgram, 0, programNumber, 0, 0.0f);
+
+    // the program brought its own values
+    updateParameterValues ();
 }
 
 int VstPlugin::getCurrentProgram ()
@@ -558,13 +889,15 @@ void VstPlugin::setStateInformation (const void* data, int sizeInBytes)
 {
     if (effect->flags & effFlagsProgramChunks)
     {
-        MemoryBlock tempBlock (data, sizeInBytes);
-    
+        // the chunk is handed over as it is, with binary sessions it points
+        // straight into the session mapping, which is copy on write
         /* int byteSize = */ dispatch (effSetChunk,
                                        0 /* bank */,
-                                       tempBlock.getSize(),
-                                       tempBlock.getData(),
+                                       sizeInBytes,
+                                       (void*) data,
                                        0.0f);
+
+        updateParameterValues ();
     }
     else
     {
@@ -627,7 +960,7 @@ int VstPlugin::dispatch (const int opcode, const int index, const int value, voi
 {
 //    const ScopedLock sl (lock);
 
-    ++insideVSTCallback;
+    atomicIncrement (insideVSTCallback);
     int result = 0;
 
     try
@@ -636,7 +969,7 @@ int VstPlugin::dispatch (const int opcode, const int index, const int value, voi
         {
             result = effect->dispatcher (effect, opcode, index, value, ptr, opt);
 
-            --insideVSTCallback;
+            atomicDecrement (insideVSTCallback);
             return result;
         }
     }
@@ -648,7 +981,7 @@ int VstPlugin::dispatch (const int opcode, const int index, const int value, voi
 #endif
     }
 
-    --insideVSTCallback;
+    atomicDecrement (insideVSTCallback);
     return result;
 }
 
@@ -860,6 +1193,9 @@ VstIntPtr VstPlugin::handleCallback (VstInt32 opcode, VstInt32 index, VstInt32 v
     switch (opcode)
     {
     case audioMasterAutomate:
+        if (parameterValues != 0 && index >= 0 && index < effect->numParams)
+            parameterValues [index] = opt;
+
         sendParamChangeMessageToListeners (index, opt);
         break;
 
@@ -868,13 +1204,13 @@ VstIntPtr VstPlugin::handleCallback (VstInt32 opcode, VstInt32 index, VstInt32 v
         return 1;
 
     case audioMasterGetTime:
-        // DBG ("audioMasterGetTime " + String (getParentHost()->getTransport()->getTimeInfo ()->tempo));
-        return (VstIntPtr) getParentHost()->getTransport()->getTimeInfo ();
+        getParentHost()->getTransport()->getTimeInfo (timeInfo, value);
+        return (VstIntPtr) &timeInfo;
 
     case audioMasterIdle:
         if (insideVSTCallback == 0 && MessageManager::getInstance()->isThisTheMessageThread())
         {
-            ++insideVSTCallback;
+            atomicIncrement (insideVSTCallback);
 
             const MessageManagerLock mml;
 
@@ -885,7 +1221,7 @@ VstIntPtr VstPlugin::handleCallback (VstInt32 opcode, VstInt32 index, VstInt32 v
             for (int i = ComponentPeer::getNumPeers(); --i >= 0;)
                 ComponentPeer::getPeer (i)->performAnyPendingRepaintsNow();
 
-            --insideVSTCallback;
+            atomicDecrement (insideVSTCallback);
         }
         break;
 
@@ -30,6 +30,8 @@
 #define __JUCETICE_JOSTVSTPLUGIN_HEADER__
 
 #include "../BasePlugin.h"
+#include "../PluginModule.h"
+#include "../ParameterQueue.h"
 
 #if JOST_USE_VST
 
@@ -67,7 +69,7 @@ enum
     This is a helper class, that will help our poor vst plugin understand
     its wacky vst event structure.
 */
-class VstPluginMidiManager
+class VstPluginMidiManager : public Timer
 {
 public:
 
@@ -76,16 +78,95 @@ public:
     ~VstPluginMidiManager ();
 
     //==============================================================================
+    /** Size the event buffer for the period, call it outside the audio callback */
+    void prepare (const int samplesPerBlock);
+
     void convertMidiMessages (MidiBuffer& midiMessages, const int blockSamples);
 
     //==============================================================================
-    VstEvents* getMidiEvents ()         { return (VstEvents*) ptrEventBuffer; }
+    VstEvents* getMidiEvents ()         { return (VstEvents*) current->eventList; }
+
+    /** Returns how many events didn't fit in the buffer so far */
+    int getOverflowCount () const       { return overflowCount; }
+
+    //==============================================================================
+    /** @internal */
+    void timerCallback ();
 
 protected:
 
     // vst internal midi event buffer
-    VstMidiEvent midiEventsBuffer [2048];
-    char* ptrEventBuffer;
+    struct EventStorage
+    {
+        EventStorage (const int maxEvents);
+        ~EventStorage ();
+
+        int maxEvents;
+        VstMidiEvent* midiEvents;
+        char* eventList;
+    };
+
+    // the one in use by the audio thread, a bigger one waiting to be taken
+    // and the previous one, freed by the timer once the audio thread left it
+    EventStorage* current;
+    EventStorage* volatile pending;
+    EventStorage* volatile retired;
+    CriticalSection storageLock;
+
+    VstMidiSysexEvent sysexEventsBuffer [JOST_VST_MAX_SYSEX_EVENTS];
+
+    volatile int highWaterMark;
+    volatile int overflowCount;
+};
+
+
+//==============================================================================
+/**
+    Collects the events a plugin sends to the host.
+
+    Plugins send them from inside their process call, so everything here is
+    preallocated: a bounded ring of events, and a pool holding a copy of the
+    sysex dumps (the plugin owns the original only for the callback).
+*/
+class VstPluginMidiOutput
+{
+public:
+
+    //==============================================================================
+    VstPluginMidiOutput ();
+    ~VstPluginMidiOutput ();
+
+    //==============================================================================
+    /** Capture the events sent by the plugin */
+    void addEvents (const VstEvents* events);
+
+    /** Move the captured events in a midi buffer, emptying the ring */
+    void drainInto (MidiBuffer& midiBuffer, const int blockSamples);
+
+    /** Returns how many events didn't fit since the last call */
+    int getAndClearDroppedEvents ();
+
+private:
+
+    struct OutputEvent
+    {
+        int deltaFrames;
+        int size;
+        int sysexOffset;
+        uint8 data [4];
+    };
+
+    int allocateSysex (const int size);
+
+    OutputEvent* events;
+    volatile int readIndex;
+    volatile int writeIndex;
+
+    uint8* sysexPool;
+    volatile int sysexReadIndex;
+    volatile int sysexWriteIndex;
+
+    volatile int droppedEvents;
 };
 
 
@@ -118,9 +199,14 @@ public:
     bool producesMidi () const;
     bool acceptsMidi () const;
     void* getLowLevelHandle ();
+
+    /** Returns how many incoming midi events the plugin didn't receive */
+    int getNumDroppedMidiEvents () const   { return midiManager.getOverflowCount (); }
 
     //==============================================================================
     void processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMessages);
+    void processBlockDouble (AudioSampleBuffer& buffer, MidiBuffer& midiMessages);
+    void processParameterChanges ();
     void prepareToPlay (double sampleRate, int samplesPerBlock);
     void releaseResources();
     void timerCallback ();
@@ -138,6 +224,7 @@ public:
     const String getCurrentProgramName ();
     void getStateInformation (MemoryBlock& destData);
     void setStateInformation (const void* data, int sizeInBytes);
+    bool canCaptureStateWhileProcessing () const           { return false; }
 
     //==============================================================================
     bool hasEditor () const;
@@ -162,21 +249,37 @@ private:
     /** @internal */
     bool canDo (const String& canDoString) const;
 
+    //==============================================================================
+    void processMidiInput (const int blockSize);
+    void processMidiOutput (const int blockSize);
+
+    /** Take the parameter values from the plugin, after it changed them by itself */
+    void updateParameterValues ();
+
     //==============================================================================
     /** Some old plugins still may want to use host provided file selectors */
     int openFileSelector (VstFileSelect *ptr);
     int closeFileSelector (VstFileSelect *ptr);
 
-    void* module;
+    PluginModule* module;
     AEffect* effect;
     uint32 flagsEx;
     File pluginFile;
 
     VstPluginMidiManager midiManager;
-    MidiBuffer sendToOutMidi;
-    
+    VstPluginMidiOutput midiOutput;
+
+    // parameters set outside the audio thread, applied at the start of our slot
+    ParameterQueue parameterQueue;
+    float* parameterValues;
+    int64 audioThreadId;
+
+    // our own copy of the transport time info
+    VstTimeInfo timeInfo;
+
     double sampleRate;
     int blockSize;
+    bool processesDouble;
 };
 
 #endif // JOST_USE_VST
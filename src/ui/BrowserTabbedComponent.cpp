@@ -195,12 +195,9 @@ void BrowserTabbedComponent::fileClicked (const File& file, const MouseEvent& e)
                 break;
             case 3: // Load session file
                 {
-                    MemoryBlock data;
                     if (file.existsAsFile()
-                        && file.loadFileAsData (data))
+                        && owner->getFilter ()->loadSessionFromFile (file))
                     {
-                        owner->getFilter ()->setStateInformation (data.getData (), data.getSize());
-
                         Config::getInstance()->addRecentSession (file);
                     }
                 }
@@ -208,6 +205,10 @@ void BrowserTabbedComponent::fileClicked (const File& file, const MouseEvent& e)
             case 4: // Load preset into plugin
                 // TODO
                 break;
+            case 10: // Scan plugins in directory
+            case 11: // Scan plugins in directory recursively
+                PluginScanner::getInstance ()->scanDirectory (file, result == 11);
+                break;
             default:
                 break;
             }
@@ -474,6 +474,15 @@ void GraphComponent::nodePopupMenuSelected (GraphNodeComponent* node)
         addFirstSeparator = true;
     }
 
+#if JUCE_ALSA && JOST_USE_DSSI
+    if (plugin->getType () == JOST_PLUGINTYPE_DSSI
+        && ((DssiPlugin*) plugin)->hasGui ())
+    {
+        menu.addItem (10, "Show plugin GUI");
+        addFirstSeparator = true;
+    }
+#endif
+
     if (node != inputs && node != outputs)
     {
         menu.addItem (2, "Remove " + plugin->getName());
@@ -570,6 +579,11 @@ void GraphComponent::nodePopupMenuSelected (GraphNodeComponent* node)
     case 9: // Disconnect outputs
         node->breakOutputLinks();
         break;
+#if JUCE_ALSA && JOST_USE_DSSI
+    case 10: // Show dssi gui
+        ((DssiPlugin*) plugin)->showGui ();
+        break;
+#endif
     default:
         break;
     }
@@ -858,7 +872,12 @@ bool GraphComponent::loadAndAppendPlugin (const File& file)
 
     jassert (host != 0);
 
-    BasePlugin* plugin = host->loadPlugin (file);
+    // let choose which one in libraries holding more than one plugin
+    const int uniqueID = PluginLoader::handleDescriptorPopupMenu (file);
+    if (uniqueID < 0)
+        return false;
+
+    BasePlugin* plugin = host->loadPlugin (file, uniqueID);
     if (plugin)
     {
         Config::getInstance ()->addRecentPlugin (file);
@@ -1287,12 +1306,10 @@ void GraphComponent::itemDropped (const String& sourceDescription,
         {
             File file (array [array.size () - 1]);
             
-            MemoryBlock data;
             if (file.existsAsFile()
-                && file.loadFileAsData (data))
+                && owner->getFilter ()->loadSessionFromFile (file))
             {
                 Config::getInstance()->addRecentSession (file);
-                owner->getFilter ()->setStateInformation (data.getData (), data.getSize());
 
                 return;
             }
@@ -336,8 +336,22 @@ void MixerStripComponent::computeMeters ()
     if ((meter->isVisible () && meter->isEnabled ()) && ! plugin->isMuted ())
     {
         AudioSampleBuffer* buffer = plugin->getOutputBuffers ();
+        DoubleSampleBuffer* doubles = plugin->getDoubleOutputBuffers ();
 
-        if (buffer && buffer->getNumChannels () > 0)
+        if (doubles && doubles->getNumChannels () > 0)
+        {
+            // in double precision the float buffers are not always filled
+            float absoluteVal = 0.0f;
+
+            if (peakMode)
+                absoluteVal = (float) doubles->getMagnitude (doubles->getNumSamples ());
+            else
+                absoluteVal = (float) doubles->getRMSLevel (0, doubles->getNumSamples ());
+
+            meter->setValue (0, absoluteVal * volumeSlider->getValue ());
+            meter->refresh ();
+        }
+        else if (buffer && buffer->getNumChannels () > 0)
         {
             float absoluteVal = 0.0f;
 
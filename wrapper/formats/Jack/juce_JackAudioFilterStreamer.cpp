@@ -42,7 +42,7 @@ static int juce_internalJackProcessCallback (jack_nframes_t nframes, void* arg);
 // static void juce_internalJackPortRegistrationCallback (jack_port_id_t port, int, void *arg);
 // static void juce_internalJackFreewheelCallback (int starting, void *arg);
 // static int juce_internalJackGraphOrderCallback (void *arg);
-// static int juce_internalJackSyncCallback (jack_transport_state_t state, jack_position_t *pos, void *arg);
+static int juce_internalJackSyncCallback (jack_transport_state_t state, jack_position_t *pos, void *arg);
 static void juce_internalJackTimebaseCallback (jack_transport_state_t state,
                                                jack_nframes_t nframes,
                                                jack_position_t *pos,
@@ -143,7 +143,7 @@ bool JackAudioFilterStreamer::activateClient ()
 //    jack_set_freewheel_callback (client, juce_internalJackFreewheelCallback, this);
     jack_set_process_callback (client, juce_internalJackProcessCallback, this);
 //    jack_set_xrun_callback (client, juce_internalJackXRunCallback, this);
-//    jack_set_sync_callback (client, juce_internalJackSyncCallback, this);
+    jack_set_sync_callback (client, juce_internalJackSyncCallback, this);
 
 #ifdef JUCE_DEBUG
 //    jack_set_error_function (default_jack_error_callback);
@@ -259,7 +259,8 @@ void JackAudioFilterStreamer::deactivateClient ()
 
 #if JucePlugin_WantsMidiInput
     if (midiInput)
-        midiInput->stop ();    deleteAndZero (midiInput);
+        midiInput->stop ();
+    deleteAndZero (midiInput);
 #endif
 
 #if JucePlugin_ProducesMidiOutput
@@ -452,28 +453,42 @@ bool JackAudioFilterStreamer::getCurrentPosition (AudioPlayHead::CurrentPosition
     printf ("rolling %d\n\n", (state & JackTransportRolling));
 #endif
 
-    if ((pos.valid & JACK_POSITION_MASK)
-        && (pos.beat_type > 0 && pos.beats_per_minute > 0))
+    if (pos.frame_rate == 0)
+        return false;
+
+    // frame position is always valid, and it's sample accurate
+    // for the current cycle when called from the process thread
+    info.timeInSeconds = pos.frame / (double) pos.frame_rate;
+    info.editOriginTime = 0;
+    info.frameRate = AudioPlayHead::fpsUnknown;
+    info.isPlaying = (state == JackTransportRolling);
+    info.isRecording = false;
+
+    if ((pos.valid & JackPositionBBT)
+        && (pos.beat_type > 0 && pos.beats_per_minute > 0 && pos.ticks_per_beat > 0))
     {
+        // bbt is expressed in beat_type units, we want quarter notes
+        const double quartersPerBeat = 4.0 / pos.beat_type;
+        const double barStartBeats = (pos.bar - 1) * pos.beats_per_bar;
+        const double beats = barStartBeats + (pos.beat - 1) + pos.tick / pos.ticks_per_beat;
+
         info.bpm = pos.beats_per_minute;
         info.timeSigNumerator = roundFloatToInt (pos.beats_per_bar);
         info.timeSigDenominator = roundFloatToInt (pos.beat_type);
-        info.timeInSeconds = pos.usecs / 1000000.0;
-        info.editOriginTime = 0; // ???
-        info.ppqPosition = pos.tick;
-        info.ppqPositionOfLastBarStart = pos.bar_start_tick;
-        switch (pos.frame_rate) {
-        case 24:   info.frameRate = AudioPlayHead::fps24; break;
-        case 25:   info.frameRate = AudioPlayHead::fps25; break;
-        case 29:   info.frameRate = AudioPlayHead::fps2997; break;
-        case 30:   info.frameRate = AudioPlayHead::fps30; break;
-        default:   info.frameRate = AudioPlayHead::fpsUnknown; break;
-        }
-        info.isPlaying = (state & JackTransportRolling);
-        info.isRecording = false;
-        return true;
+        info.ppqPosition = beats * quartersPerBeat;
+        info.ppqPositionOfLastBarStart = barStartBeats * quartersPerBeat;
+    }
+    else
+    {
+        // no timebase master, use our own tempo
+        info.bpm = beatsPerMinute;
+        info.timeSigNumerator = roundFloatToInt (beatsPerBar);
+        info.timeSigDenominator = roundFloatToInt (beatType);
+        info.ppqPosition = info.timeInSeconds * beatsPerMinute / 60.0;
+        info.ppqPositionOfLastBarStart = 0;
     }
-    return false;
+
+    return true;
 }
 
 //==============================================================================
@@ -574,6 +589,28 @@ void JackAudioFilterStreamer::setTempo (const double bpmToSet)
     }
 }
 
+void JackAudioFilterStreamer::setTimeSignature (const int numerator, const int denominator)
+{
+    if (numerator > 0 && denominator > 0)
+    {
+        if (beatsPerBar != numerator || beatType != denominator)
+        {
+            DBG ("JackAudioFilterStreamer::setTimeSignature");
+
+            beatsPerBar = numerator;
+            beatType = denominator;
+            timeHasChanged = true;
+        }
+    }
+}
+
+bool JackAudioFilterStreamer::isReadyToRoll () const
+{
+    // slow sync clients must wait while the filter is suspended,
+    // for example when it is still loading a session
+    return filter != 0 && ! filter->isSuspended ();
+}
+
 void JackAudioFilterStreamer::setSyncTimeout (const double secondsTimeout)
 {
     if (client && holdTransport)
@@ -681,13 +718,19 @@ static int juce_internalJackGraphOrderCallback (void *arg)
     return 0;
 }
 
+*/
+
 static int juce_internalJackSyncCallback (jack_transport_state_t state, jack_position_t *pos, void *arg)
 {
-    printf ("sync: %d:%d %d %3.1f/%3.1f %f %f\n",
-            pos->beat, pos->bar, pos->tick, pos->beats_per_bar, pos->beat_type, pos->ticks_per_beat, pos->beats_per_minute );
-    return 0;
+    JackAudioFilterStreamer* filterStreamer = (JackAudioFilterStreamer*) arg;
+
+    // we follow locates in the process callback, so we are ready as soon
+    // as the filter is able to process again
+    if (filterStreamer)
+        return filterStreamer->isReadyToRoll () ? 1 : 0;
+
+    return 1;
 }
-*/
 
 static void juce_internalJackTimebaseCallback (jack_transport_state_t state,
                                                jack_nframes_t nframes,
@@ -695,49 +738,32 @@ static void juce_internalJackTimebaseCallback (jack_transport_state_t state,
                                                int new_pos,
                                                void *arg)
 {
-  double min;         // minutes since frame 0
-  long abs_tick;      // ticks since frame 0
-  long abs_beat;      // beats since frame 0
-
-  DBG ("jack timebase");
-
-  JackAudioFilterStreamer* filterStreamer = (JackAudioFilterStreamer*) arg;
-
-  if (new_pos || filterStreamer->timeHasChanged)
-  {
-      pos->valid = JackPositionBBT;
-      pos->beats_per_bar = filterStreamer->beatsPerBar;
-      pos->beat_type = filterStreamer->beatType;
-      pos->ticks_per_beat = filterStreamer->ticksPerBeat;
-      pos->beats_per_minute = filterStreamer->beatsPerMinute;
-
-      min = pos->frame / ((double) pos->frame_rate * 60.0);
-      abs_tick = roundDoubleToInt (min * pos->beats_per_minute * pos->ticks_per_beat);
-      abs_beat = roundDoubleToInt (abs_tick / pos->ticks_per_beat);
-
-      pos->bar = roundFloatToInt (abs_beat / pos->beats_per_bar);
-      pos->beat = roundFloatToInt (abs_beat - (pos->bar * pos->beats_per_bar) + 1);
-      pos->tick = roundFloatToInt (abs_tick - (abs_beat * pos->ticks_per_beat));
-      pos->bar_start_tick = roundFloatToInt (pos->bar * pos->beats_per_bar * pos->ticks_per_beat);
-      ++pos->bar;
-
-      filterStreamer->timeHasChanged = false; // time change complete
-  }
-  else
-  {
-      // Compute BBT info based on previous period.
-      pos->tick += roundDoubleToInt (nframes * pos->ticks_per_beat * pos->beats_per_minute / (pos->frame_rate * 60));
-
-      while (pos->tick >= pos->ticks_per_beat)
-      {
-          pos->tick -= roundDoubleToInt (pos->ticks_per_beat);
-          if (++pos->beat > pos->beats_per_bar)
-          {
-              pos->beat = 1;
-              ++pos->bar;
-              pos->bar_start_tick += pos->beats_per_bar * pos->ticks_per_beat;
-          }
-      }
-  }
+    JackAudioFilterStreamer* filterStreamer = (JackAudioFilterStreamer*) arg;
+
+    if (! filterStreamer || pos->frame_rate == 0)
+        return;
+
+    const int ticksPerBeat = jmax (1, roundDoubleToInt (filterStreamer->ticksPerBeat));
+    const int beatsPerBar = jmax (1, roundFloatToInt (filterStreamer->beatsPerBar));
+
+    pos->valid = (jack_position_bits_t) (pos->valid | JackPositionBBT);
+    pos->beats_per_bar = beatsPerBar;
+    pos->beat_type = filterStreamer->beatType;
+    pos->ticks_per_beat = ticksPerBeat;
+    pos->beats_per_minute = filterStreamer->beatsPerMinute;
+
+    // compute bbt from the absolute frame every cycle, so we never
+    // accumulate rounding errors and we follow locates and tempo changes
+    const double beats = pos->frame * pos->beats_per_minute / (pos->frame_rate * 60.0);
+    const int64 absoluteTick = (int64) (beats * ticksPerBeat);
+    const int64 absoluteBeat = absoluteTick / ticksPerBeat;
+    const int64 absoluteBar = absoluteBeat / beatsPerBar;
+
+    pos->bar = (int32_t) (absoluteBar + 1);
+    pos->beat = (int32_t) (absoluteBeat - absoluteBar * beatsPerBar + 1);
+    pos->tick = (int32_t) (absoluteTick - absoluteBeat * ticksPerBeat);
+    pos->bar_start_tick = (double) (absoluteBar * beatsPerBar * ticksPerBeat);
+
+    filterStreamer->timeHasChanged = false; // time change complete
 }
 
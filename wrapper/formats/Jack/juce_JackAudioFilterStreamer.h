@@ -41,6 +41,8 @@
 #include <jack/jack.h>
 #include <jack/transport.h>
 
+#include "model/ExternalTimeSignature.h"
+
 
 //==============================================================================
 /**
@@ -62,7 +64,8 @@
 class JackAudioFilterStreamer   : public Timer,
                                   public MidiInputCallback,
                                   public AudioPlayHead,
-                                  public ExternalTransport
+                                  public ExternalTransport,
+                                  public ExternalTimeSignature
 {
 public:
     //==============================================================================
@@ -158,6 +161,11 @@ public:
     */
     void setTempo (const double bpmToSet);
 
+    /**
+        Set JACK main time signature, used when we are the timebase master
+    */
+    void setTimeSignature (const int numerator, const int denominator);
+
     /**
         Set JACK sync timeout in seconds
     */
@@ -200,6 +208,8 @@ public:
     /** @internal */
     bool getCurrentPosition (AudioPlayHead::CurrentPositionInfo& info);
     /** @internal */
+    bool isReadyToRoll () const;
+    /** @internal */
     void timerCallback ();
     /** @internal */
     jack_client_t* getJackClient ()                             { return client; }